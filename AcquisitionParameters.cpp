@@ -1,8 +1,10 @@
 #include "AcquisitionParameters.h"
 
 #include "Camera.h"
+#include "ParameterRegistry.h"
 #include "Parameters.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -12,21 +14,21 @@ namespace Prokyon {
     AcquisitionParameters::AcquisitionParameters(Camera *p_camera) : m_p_camera{p_camera} {}
 
     int AcquisitionParameters::get_binning() const {
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageModeAveraging, 1);
-        if (p.error) { throw AcquisitionParametersException(); }
-        return p.value.at(0);
+        int averaging = 0;
+        if (read_numeric_parameter<int>(*m_p_camera, ParameterIdImageModeAveraging, &averaging, 1)) { throw AcquisitionParametersException(); }
+        return averaging;
     }
 
     double AcquisitionParameters::get_exposure_ms() const {
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureExposureTimeUsec, 1);
-        if (p.error) { throw AcquisitionParametersException(); }
-        auto exposure_us = p.value.at(0);
+        ParameterArray<ParameterIdImageCaptureExposureTimeUsec> p;
+        if (read_parameter<ParameterIdImageCaptureExposureTimeUsec>(*m_p_camera, p)) { throw AcquisitionParametersException(); }
+        auto exposure_us = p[0];
         auto exposure_ms = exposure_us / 1000.0;
         assert(0.0 < exposure_ms);
         return exposure_ms;
     }
 
-    void AcquisitionParameters::set_exposure_ms(double exposure_ms) {
+    double AcquisitionParameters::set_exposure_ms(double exposure_ms) {
         // check machine limit and convert ms to us
         constexpr auto max_int = (std::numeric_limits<int>::max)();
         auto exposure_us_raw = exposure_ms * 1000.0;
@@ -36,13 +38,12 @@ namespace Prokyon {
         int exposure_us = static_cast<int>(std::round(exposure_us_raw));
 
         // check and clip to hardware limits
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureExposureTimeUsec, 1, DijSDK_EParamQueryMax);
-        if (p.error) { throw AcquisitionParametersException(); }
-        auto max = p.value.at(0);
+        ParameterArray<ParameterIdImageCaptureExposureTimeUsec> p;
+        if (read_parameter<ParameterIdImageCaptureExposureTimeUsec>(*m_p_camera, p, DijSDK_EParamQueryMax)) { throw AcquisitionParametersException(); }
+        auto max = p[0];
 
-        p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureExposureTimeUsec, 1, DijSDK_EParamQueryMin);
-        if (p.error) { throw AcquisitionParametersException(); }
-        auto min = p.value.at(0);
+        if (read_parameter<ParameterIdImageCaptureExposureTimeUsec>(*m_p_camera, p, DijSDK_EParamQueryMin)) { throw AcquisitionParametersException(); }
+        auto min = p[0];
 
         assert(min <= max);
 
@@ -54,7 +55,29 @@ namespace Prokyon {
         }
 
         // set hardware value
-        auto result = set_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureExposureTimeUsec, std::vector<int>{exposure_us});
+        auto result = write_parameter<ParameterIdImageCaptureExposureTimeUsec>(*m_p_camera, {exposure_us});
+        if (result) { throw AcquisitionParametersException(); }
+        return exposure_us / 1000.0;
+    }
+
+    double AcquisitionParameters::get_gain() const {
+        ParameterArray<ParameterIdImageCaptureGain> p;
+        if (read_parameter<ParameterIdImageCaptureGain>(*m_p_camera, p)) { throw AcquisitionParametersException(); }
+        return p[0];
+    }
+
+    void AcquisitionParameters::set_gain(double gain) {
+        ParameterArray<ParameterIdImageCaptureGain> p;
+        if (read_parameter<ParameterIdImageCaptureGain>(*m_p_camera, p, DijSDK_EParamQueryMax)) { throw AcquisitionParametersException(); }
+        auto max = p[0];
+
+        if (read_parameter<ParameterIdImageCaptureGain>(*m_p_camera, p, DijSDK_EParamQueryMin)) { throw AcquisitionParametersException(); }
+        auto min = p[0];
+
+        assert(min <= max);
+        gain = (std::min)((std::max)(gain, min), max);
+
+        auto result = write_parameter<ParameterIdImageCaptureGain>(*m_p_camera, {gain});
         if (result) { throw AcquisitionParametersException(); }
     }
 
@@ -64,6 +87,7 @@ namespace Prokyon {
         ss << "  address: " << this << "\n";
         ss << "  binning: " << get_binning() << "\n";
         ss << "  exposure time (ms): " << get_exposure_ms() << "\n";
+        ss << "  gain: " << get_gain() << "\n";
         return ss.str();
     }
 }
\ No newline at end of file
@@ -18,7 +18,10 @@ namespace Prokyon {
         // please see Image Mode property in micromanager
 
         double get_exposure_ms() const; // throws AcquisitionParametersException
-        void set_exposure_ms(double exposure_ms); // throws AcquisitionParametersException
+        double set_exposure_ms(double exposure_ms); // throws AcquisitionParametersException, returns the clipped value set
+
+        double get_gain() const; // throws AcquisitionParametersException
+        void set_gain(double gain); // throws AcquisitionParametersException, clips to hardware limits
 
         std::string to_string() const;
 
@@ -0,0 +1,134 @@
+#include "BufferPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+namespace Prokyon {
+    BufferPool::BufferPool(const FrameBuffer::Options &options, std::size_t budget_bytes) :
+        m_mutex{},
+        m_options(options),
+        m_budget{budget_bytes},
+        m_free{},
+        m_in_use{},
+        m_generation{0},
+        m_allocated_bytes{0},
+        m_in_use_bytes{0},
+        m_allocations{0},
+        m_reuses{0}
+    {}
+
+    BufferPool::~BufferPool() {
+        // every buffer handed out has to be given back before the pool goes
+        assert(m_in_use.empty());
+    }
+
+    FrameBuffer BufferPool::take(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (bytes == 0) {
+            return FrameBuffer();
+        }
+
+        // best fit among the free buffers, but not more than twice the size asked for
+        auto best = m_free.end();
+        for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+            if (bytes <= it->size() && it->size() <= 2 * bytes && (best == m_free.end() || it->size() < best->size())) {
+                best = it;
+            }
+        }
+        if (best != m_free.end()) {
+            auto buffer = std::move(*best);
+            m_free.erase(best);
+            m_in_use[buffer.data()] = m_generation;
+            m_in_use_bytes += buffer.size();
+            ++m_reuses;
+            return buffer;
+        }
+
+        if (m_budget < m_in_use_bytes + bytes) { throw BufferPoolException(); }
+        release_free_until(m_budget - bytes);
+        FrameBuffer buffer;
+        try {
+            buffer = FrameBuffer(bytes, m_options);
+        }
+        catch (FrameMemoryException) {
+            throw BufferPoolException();
+        }
+        m_in_use[buffer.data()] = m_generation;
+        m_allocated_bytes += buffer.size();
+        m_in_use_bytes += buffer.size();
+        ++m_allocations;
+        return buffer;
+    }
+
+    void BufferPool::give(FrameBuffer &&buffer) {
+        if (buffer.empty()) { return; }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_in_use.find(buffer.data());
+        assert(it != m_in_use.end());
+        auto current = (it->second == m_generation);
+        m_in_use.erase(it);
+        m_in_use_bytes -= buffer.size();
+        if (current && m_allocated_bytes <= m_budget) {
+            m_free.push_back(std::move(buffer));
+        }
+        else {
+            m_allocated_bytes -= buffer.size();
+            buffer = FrameBuffer();
+        }
+    }
+
+    FrameBuffer::Options BufferPool::get_options() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_options;
+    }
+
+    void BufferPool::set_options(const FrameBuffer::Options &options) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_options = options;
+        ++m_generation;
+        release_free_until(0);
+    }
+
+    std::size_t BufferPool::get_budget() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_budget;
+    }
+
+    void BufferPool::set_budget(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budget = bytes;
+        release_free_until(m_budget);
+    }
+
+    void BufferPool::trim() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        release_free_until(0);
+    }
+
+    BufferPool::Statistics BufferPool::get_statistics() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return {m_budget, m_allocated_bytes, m_in_use_bytes, m_allocations, m_reuses};
+    }
+
+    std::string BufferPool::to_string() const {
+        auto statistics = get_statistics();
+        std::stringstream ss;
+        ss << "Buffer pool:\n";
+        ss << "  budget (MB): " << (statistics.budget_bytes >> 20) << "\n";
+        ss << "  allocated (bytes): " << statistics.allocated_bytes << "\n";
+        ss << "  in use (bytes): " << statistics.in_use_bytes << "\n";
+        ss << "  allocations: " << statistics.allocations << "\n";
+        ss << "  reuses: " << statistics.reuses << "\n";
+        return ss.str();
+    }
+
+    // private
+    void BufferPool::release_free_until(std::size_t allocated_bytes) {
+        std::sort(m_free.begin(), m_free.end(), [](const FrameBuffer &a, const FrameBuffer &b) { return a.size() < b.size(); });
+        while (allocated_bytes < m_allocated_bytes && !m_free.empty()) {
+            m_allocated_bytes -= m_free.back().size();
+            m_free.pop_back();
+        }
+    }
+}
\ No newline at end of file
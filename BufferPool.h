@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef PROKYON_BUFFER_POOL_H_
+#define PROKYON_BUFFER_POOL_H_
+
+#include "FrameMemory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    // Frame buffers shared by Image and the pipelines, sized for the active layout and recycled instead of freed.
+    // A returned buffer serves later requests up to twice smaller, so frames and mode changes back and forth
+    // reuse memory. Free buffers are released only to stay within the budget or when the options change.
+    class BufferPool {
+    public:
+        struct Statistics {
+            std::size_t budget_bytes;
+            std::size_t allocated_bytes; // in use and free
+            std::size_t in_use_bytes;
+            std::uint64_t allocations;
+            std::uint64_t reuses;
+        };
+
+        BufferPool(const FrameBuffer::Options &options, std::size_t budget_bytes);
+        ~BufferPool();
+        BufferPool(const BufferPool &) = delete;
+        BufferPool &operator=(const BufferPool &) = delete;
+
+        FrameBuffer take(std::size_t bytes); // throws BufferPoolException if the budget does not allow it
+        void give(FrameBuffer &&buffer); // buffers of other options are released
+
+        FrameBuffer::Options get_options() const;
+        void set_options(const FrameBuffer::Options &options); // buffers in use keep theirs until given back
+        std::size_t get_budget() const;
+        void set_budget(std::size_t bytes); // releases free buffers above it
+        void trim(); // releases all free buffers
+
+        Statistics get_statistics() const;
+        std::string to_string() const;
+
+        static const std::size_t M_S_BUDGET_DEFAULT = std::size_t{1024} << 20;
+
+    private:
+        void release_free_until(std::size_t allocated_bytes); // largest first
+
+    private:
+        mutable std::mutex m_mutex;
+        FrameBuffer::Options m_options;
+        std::size_t m_budget;
+        std::vector<FrameBuffer> m_free;
+        std::map<const unsigned char *, unsigned> m_in_use; // generation of the options each buffer was allocated with
+        unsigned m_generation;
+        std::size_t m_allocated_bytes;
+        std::size_t m_in_use_bytes;
+        std::uint64_t m_allocations;
+        std::uint64_t m_reuses;
+    };
+
+    class BufferPoolException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
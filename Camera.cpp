@@ -1,5 +1,7 @@
 #include "Camera.h"
 
+#include "SdkThread.h"
+
 #include "dijsdk.h"
 #include "dijsdkerror.h"
 
@@ -20,11 +22,15 @@ namespace Prokyon {
 
         std::stringstream ss;
 
+        // every SDK call from here on runs on the SDK thread
+        SdkThread::start();
+
         // Initialize SDK
-        auto result = DijSDK_Init(key, 1);
+        auto result = SdkThread::call([&]() { return DijSDK_Init(key, 1); });
         if (!IS_OK(result)) {
             ss << "Error initializing " << name << std::endl;
             m_error = ss.str();
+            SdkThread::stop();
             return Status::failure;
         }
 
@@ -35,19 +41,21 @@ namespace Prokyon {
         unsigned int camera_count = EXPECTED_CAMERA_COUNT;
         // Always returns some guid for each camera requested.
         // Null camera appears to be "SynthCam::SynthCam::00000000"
-        result = DijSDK_FindCameras(cam_guid, &camera_count);
+        result = SdkThread::call([&]() { return DijSDK_FindCameras(cam_guid, &camera_count); });
         if (!IS_OK(result)) {
             ss << "Unable to create handle to camera." << std::endl;
             m_error = ss.str();
+            SdkThread::stop();
             return Status::failure;
         }
         const auto selected_guid = cam_guid[camera_index];
 
         // Open first camera
-        result = DijSDK_OpenCamera(selected_guid, &m_camera);
+        result = SdkThread::call([&]() { return DijSDK_OpenCamera(selected_guid, &m_camera); });
         if (!IS_OK(result)) {
             ss << "Camera not valid." << std::endl;
             m_error = ss.str();
+            SdkThread::stop();
             return Status::failure;
         }
 
@@ -67,15 +75,16 @@ namespace Prokyon {
         std::stringstream ss;
 
         // TODO check all image buffers are freed
-        auto result = DijSDK_CloseCamera(m_camera);
+        auto result = SdkThread::call([this]() { return DijSDK_CloseCamera(m_camera); });
         if (!IS_OK(result)) {
             ss << "Failed to close camera. ";
         }
 
-        result = DijSDK_Exit();
+        result = SdkThread::call([]() { return DijSDK_Exit(); });
         if (!IS_OK(result)) {
             ss << "Error shutting down DijSDK. ";
         }
+        SdkThread::stop();
 
         m_camera = nullptr;
         m_initialized = false;
@@ -113,6 +122,19 @@ namespace Prokyon {
         return m_camera;
     }
 
+    std::string Camera::get_guid() const {
+        return m_guid;
+    }
+
+    std::string Camera::get_sdk_version() {
+        char version[64] = {};
+        if (!IS_OK(SdkThread::call([&]() { return DijSDK_GetVersion(version, sizeof(version)); }))) {
+            return "";
+        }
+        version[sizeof(version) - 1] = '\0';
+        return version;
+    }
+
     std::string Camera::to_string() const {
         std::stringstream ss;
         ss << "Camera information:\n";
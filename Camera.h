@@ -32,6 +32,8 @@ namespace Prokyon {
         CameraHandle &operator*();
 
         std::string to_string() const;
+        std::string get_guid() const; // empty before initialize
+        static std::string get_sdk_version(); // empty if the SDK does not tell
 
     private:
         CameraHandle m_camera;
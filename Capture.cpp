@@ -0,0 +1,264 @@
+#include "Capture.h"
+
+#include "Camera.h"
+#include "Pipeline.h"
+#include "SdkThread.h"
+
+#include "dijsdk.h"
+#include "parameterif.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace Prokyon {
+    Capture::Capture(Camera *p_camera, Pipeline *p_pipeline) :
+        m_p_camera{p_camera},
+        m_p_pipeline{p_pipeline},
+        m_thread{},
+        m_running{false},
+        m_stop_requested{false},
+        m_frames{0},
+        m_policy{{}, ThreadPriority::normal},
+        m_policy_applied{false},
+        m_raw_bytes{0},
+        m_has_counter{false},
+        m_first_counter{-1},
+        m_last_counter{-1},
+        m_counted_frames{0},
+        m_dropped_before{0},
+        m_sensor_dropped{0},
+        m_pause_mutex{},
+        m_pause_cv{},
+        m_pause_requested{false},
+        m_paused{false},
+        m_switching{false},
+        m_switch_start{},
+        m_last_switch_ms{0.0},
+        m_interval_mutex{},
+        m_interval_count{0},
+        m_interval_mean_ms{0.0},
+        m_interval_m2{0.0},
+        m_interval_max_ms{0.0}
+    {}
+
+    Capture::~Capture() {
+        stop();
+    }
+
+    bool Capture::start(std::size_t raw_bytes, long frame_limit, OnExit on_exit) {
+        if (m_running) { return false; }
+        if (m_thread.joinable()) {
+            // finished on its own, e.g. after the frame limit
+            m_thread.join();
+        }
+        m_stop_requested = false;
+        m_frames = 0;
+        m_raw_bytes = raw_bytes;
+        m_first_counter = -1;
+        m_dropped_before = 0;
+        m_sensor_dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_pause_mutex);
+            m_pause_requested = false;
+            m_paused = false;
+            m_switching = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_interval_mutex);
+            m_interval_count = 0;
+            m_interval_mean_ms = 0.0;
+            m_interval_m2 = 0.0;
+            m_interval_max_ms = 0.0;
+        }
+        m_running = true;
+        m_thread = std::thread(&Capture::run, this, frame_limit, on_exit);
+        return true;
+    }
+
+    void Capture::request_stop() {
+        m_stop_requested = true;
+    }
+
+    void Capture::stop() {
+        request_stop();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    bool Capture::is_running() const {
+        return m_running;
+    }
+
+    bool Capture::pause() {
+        assert(std::this_thread::get_id() != m_thread.get_id());
+        std::unique_lock<std::mutex> lock(m_pause_mutex);
+        if (!m_running) { return false; }
+        m_switch_start = std::chrono::steady_clock::now();
+        m_pause_requested = true;
+        m_pause_cv.wait(lock, [this]() { return m_paused || !m_running; });
+        if (!m_paused) {
+            m_pause_requested = false;
+            return false;
+        }
+        return true;
+    }
+
+    void Capture::resume(std::size_t raw_bytes) {
+        {
+            std::lock_guard<std::mutex> lock(m_pause_mutex);
+            assert(m_paused);
+            m_raw_bytes = raw_bytes;
+            m_switching = true;
+            m_pause_requested = false;
+        }
+        m_pause_cv.notify_all();
+    }
+
+    double Capture::get_last_switch_ms() const {
+        std::lock_guard<std::mutex> lock(m_pause_mutex);
+        return m_last_switch_ms;
+    }
+
+    void Capture::set_policy(const ThreadPolicy &policy) {
+        m_policy = policy;
+    }
+
+    bool Capture::is_policy_applied() const {
+        return m_policy_applied;
+    }
+
+    std::uint64_t Capture::get_frame_count() const {
+        return m_frames;
+    }
+
+    std::uint64_t Capture::get_sensor_drop_count() const {
+        return m_sensor_dropped;
+    }
+
+    bool Capture::has_sensor_counter() const {
+        return m_has_counter;
+    }
+
+    Capture::IntervalStatistics Capture::get_interval_statistics() const {
+        std::lock_guard<std::mutex> lock(m_interval_mutex);
+        auto sd = (m_interval_count < 2) ? 0.0 : std::sqrt(m_interval_m2 / (m_interval_count - 1));
+        return {m_interval_count, m_interval_mean_ms, sd, m_interval_max_ms};
+    }
+
+    // private
+    void Capture::run(long frame_limit, OnExit on_exit) {
+        // the frames are taken on the sdk thread, it runs under the policy for the sequence only
+        ThreadState sdk_state{};
+        const auto sdk_saved = SdkThread::call([&]() { return Scheduling::save(sdk_state); });
+        m_policy_applied = Scheduling::apply(m_policy) && sdk_saved && SdkThread::call([this]() { return Scheduling::apply(m_policy); });
+        m_has_counter = SdkThread::call([this]() { return DijSDK_HasParameter(*m_p_camera, ParameterIdSensorImageCounter) == E_OK; });
+        const auto t0 = std::chrono::steady_clock::now();
+
+        auto failed = SdkThread::call_frame([this]() { return DijSDK_StartAcquisition(*m_p_camera); }) != E_OK;
+        std::chrono::steady_clock::time_point last;
+        auto timed = false; // last is set, not across a pause
+        while (!failed && !m_stop_requested && (frame_limit <= 0 || m_frames < static_cast<std::uint64_t>(frame_limit))) {
+            if (m_pause_requested) {
+                failed = !wait_while_paused();
+                timed = false;
+                continue;
+            }
+
+            // parameter commands queue while the sdk thread waits for the frame, and run before the next one
+            auto got_image = false;
+            FrameStamp stamp{-1, 0};
+            std::chrono::steady_clock::time_point now;
+            failed = !SdkThread::call_frame([&]() { return grab(t0, got_image, stamp, now); });
+            if (!got_image) { break; }
+            {
+                std::lock_guard<std::mutex> lock(m_pause_mutex);
+                if (m_switching) {
+                    m_last_switch_ms = std::chrono::duration<double, std::milli>(now - m_switch_start).count();
+                    m_switching = false;
+                }
+            }
+            if (timed) {
+                auto ms = std::chrono::duration<double, std::milli>(now - last).count();
+                std::lock_guard<std::mutex> lock(m_interval_mutex);
+                ++m_interval_count;
+                auto delta = ms - m_interval_mean_ms;
+                m_interval_mean_ms += delta / m_interval_count;
+                m_interval_m2 += delta * (ms - m_interval_mean_ms);
+                m_interval_max_ms = (std::max)(m_interval_max_ms, ms);
+            }
+            last = now;
+            timed = true;
+            if (0 <= stamp.sensor_counter) {
+                count_drops(stamp.sensor_counter);
+            }
+            ++m_frames;
+        }
+        SdkThread::call_frame([this]() { return DijSDK_AbortAcquisition(*m_p_camera); });
+        // the other users of the sdk thread, e.g. property access, do not run under the capture's policy
+        if (sdk_saved) {
+            SdkThread::call([&]() { return Scheduling::restore(sdk_state); });
+        }
+
+        if (on_exit) {
+            on_exit(failed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_pause_mutex);
+            m_running = false;
+        }
+        m_pause_cv.notify_all();
+    }
+
+    bool Capture::grab(std::chrono::steady_clock::time_point t0, bool &got_image, FrameStamp &stamp, std::chrono::steady_clock::time_point &now) {
+        DijSDK_Handle image_handle;
+        void *p_raw_data = nullptr;
+        got_image = DijSDK_GetImage(*m_p_camera, &image_handle, &p_raw_data) == E_OK;
+        if (!got_image) { return false; }
+        now = std::chrono::steady_clock::now();
+
+        // read right after the frame is returned, one parameter read per frame
+        stamp.timestamp_us = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - t0).count());
+        int counter = 0;
+        if (m_has_counter && DijSDK_GetIntParameter(*m_p_camera, ParameterIdSensorImageCounter, &counter, 1) == E_OK) {
+            stamp.sensor_counter = counter;
+        }
+
+        auto p_slot = m_p_pipeline->begin_frame();
+        if (p_slot != nullptr) {
+            std::memcpy(p_slot, p_raw_data, m_raw_bytes);
+            m_p_pipeline->submit_frame(stamp);
+        }
+        return DijSDK_ReleaseImage(image_handle) == E_OK;
+    }
+
+    bool Capture::wait_while_paused() {
+        SdkThread::call_frame([this]() { return DijSDK_AbortAcquisition(*m_p_camera); });
+        {
+            std::unique_lock<std::mutex> lock(m_pause_mutex);
+            m_paused = true;
+            m_pause_cv.notify_all();
+            m_pause_cv.wait(lock, [this]() { return !m_pause_requested; });
+            m_paused = false;
+        }
+        m_first_counter = -1;
+        if (m_stop_requested) { return true; }
+        return SdkThread::call_frame([this]() { return DijSDK_StartAcquisition(*m_p_camera); }) == E_OK;
+    }
+
+    void Capture::count_drops(std::int64_t counter) {
+        if (m_first_counter < 0 || counter < m_last_counter) {
+            // first frame of a run of the SDK acquisition, or the counter restarted
+            m_dropped_before = m_sensor_dropped;
+            m_first_counter = counter;
+            m_counted_frames = 0;
+        }
+        m_last_counter = counter;
+        ++m_counted_frames;
+        const auto span = static_cast<std::uint64_t>(counter - m_first_counter) + 1;
+        m_sensor_dropped = m_dropped_before + ((m_counted_frames < span) ? span - m_counted_frames : 0);
+    }
+}
\ No newline at end of file
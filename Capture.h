@@ -0,0 +1,105 @@
+#pragma once
+
+#ifndef PROKYON_CAPTURE_H_
+#define PROKYON_CAPTURE_H_
+
+#include "Pipeline.h"
+#include "Scheduling.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Prokyon {
+    class Camera;
+
+    // Sequence acquisition thread, keeps the SDK acquiring and hands each raw frame to a running Pipeline.
+    // Each frame is waited for and copied by a frame command on the SdkThread, all processing is left to the pipeline workers,
+    // a frame arriving while every pipeline slot is busy is dropped and counted by the pipeline.
+    // Each frame is stamped with the sensor frame counter and the host time, gaps in the counter are counted as drops.
+    // Between two frames the thread can be paused, with the SDK not acquiring, to reconfigure camera and pipeline.
+    class Capture {
+    public:
+        using OnExit = std::function<void(bool failed)>;
+
+        // time between consecutive frames returned by the SDK, for judging scheduling jitter
+        struct IntervalStatistics {
+            std::uint64_t count;
+            double mean_ms;
+            double sd_ms;
+            double max_ms;
+        };
+
+        Capture(Camera *p_camera, Pipeline *p_pipeline);
+        ~Capture();
+        Capture(const Capture &) = delete;
+        Capture &operator=(const Capture &) = delete;
+
+        // frame_limit <= 0 runs until stopped, on_exit runs on the capture thread after the last frame
+        bool start(std::size_t raw_bytes, long frame_limit, OnExit on_exit); // returns success
+        void request_stop(); // does not wait, safe from pipeline delivery
+        void stop(); // waits for the thread
+        bool is_running() const;
+
+        // from another thread, the paused thread waits for resume even if a stop is requested meanwhile
+        bool pause(); // after the frame in hand, returns false if the thread is not running
+        void resume(std::size_t raw_bytes); // frames from now on have raw_bytes
+        double get_last_switch_ms() const; // from the last pause to the first frame after it, 0 if none yet
+
+        void set_policy(const ThreadPolicy &policy); // applied at the next start
+        bool is_policy_applied() const; // by the last start
+
+        std::uint64_t get_frame_count() const;
+        // frames the sensor counted but the SDK never returned, exact while the SDK holds no frames back
+        std::uint64_t get_sensor_drop_count() const;
+        bool has_sensor_counter() const; // of the last start
+        IntervalStatistics get_interval_statistics() const; // of the last or running sequence
+
+    private:
+        void run(long frame_limit, OnExit on_exit);
+        // on the sdk thread, from waiting for the image to its release, returns success
+        bool grab(std::chrono::steady_clock::time_point t0, bool &got_image, FrameStamp &stamp, std::chrono::steady_clock::time_point &now);
+        bool wait_while_paused(); // on the capture thread, returns if the SDK acquires again
+        void count_drops(std::int64_t counter); // on the capture thread
+
+    private:
+        Camera *m_p_camera;
+        Pipeline *m_p_pipeline;
+        std::thread m_thread;
+        std::atomic<bool> m_running;
+        std::atomic<bool> m_stop_requested;
+        std::atomic<std::uint64_t> m_frames;
+        ThreadPolicy m_policy;
+        std::atomic<bool> m_policy_applied;
+        std::size_t m_raw_bytes;
+
+        // drop detection, the counter may restart with every start of the SDK acquisition
+        std::atomic<bool> m_has_counter;
+        std::int64_t m_first_counter; // of the current run of the SDK acquisition, -1 before its first frame
+        std::int64_t m_last_counter;
+        std::uint64_t m_counted_frames; // of the current run
+        std::uint64_t m_dropped_before; // by earlier runs
+        std::atomic<std::uint64_t> m_sensor_dropped;
+
+        mutable std::mutex m_pause_mutex;
+        std::condition_variable m_pause_cv;
+        std::atomic<bool> m_pause_requested;
+        bool m_paused;
+        bool m_switching;
+        std::chrono::steady_clock::time_point m_switch_start;
+        double m_last_switch_ms;
+
+        mutable std::mutex m_interval_mutex;
+        std::uint64_t m_interval_count;
+        double m_interval_mean_ms;
+        double m_interval_m2; // sum of squared deviations, Welford
+        double m_interval_max_ms;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,539 @@
+#include "Conversion.h"
+
+#include "dijsdk.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROKYON_X86 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PROKYON_TARGET_SSSE3
+#else
+#define PROKYON_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+// Kernels come in pairs: a portable scalar version that also handles the tail of each row,
+// and an SSSE3 version used for the bulk of the row when the CPU supports it.
+// Packed 3 component pixels are deinterleaved with byte shuffles, one mask per (component, input chunk).
+
+namespace Prokyon {
+    namespace {
+        using u8 = std::uint8_t;
+        using u16 = std::uint16_t;
+        using u32 = std::uint32_t;
+
+        // scalar kernels
+        void expand_alpha_8_scalar(const u8 *p_src, u8 *p_dst, std::size_t px) {
+            for (std::size_t p = 0; p < px; ++p) {
+                p_dst[0] = p_src[0];
+                p_dst[1] = p_src[1];
+                p_dst[2] = p_src[2];
+                // MM expects 4 components, camera has only 3
+                // so we have to fill alpha channel with fully opaque
+                p_dst[3] = 0xffu;
+                p_src += 3;
+                p_dst += 4;
+            }
+        }
+
+        void expand_alpha_16_scalar(const u8 *p_src, u8 *p_dst, std::size_t px) {
+            for (std::size_t p = 0; p < px; ++p) {
+                std::memcpy(p_dst, p_src, 6);
+                p_dst[6] = 0xffu;
+                p_dst[7] = 0xffu;
+                p_src += 6;
+                p_dst += 8;
+            }
+        }
+
+        template<typename Out>
+        Out narrow_luminance_8(u32 v);
+
+        template<>
+        u8 narrow_luminance_8<u8>(u32 v) {
+            return static_cast<u8>(v);
+        }
+
+        template<>
+        u16 narrow_luminance_8<u16>(u32 v) {
+            return static_cast<u16>(v * 257u);
+        }
+
+        template<typename Out>
+        Out narrow_luminance_16(u32 v);
+
+        template<>
+        u8 narrow_luminance_16<u8>(u32 v) {
+            return static_cast<u8>(v >> 8);
+        }
+
+        template<>
+        u16 narrow_luminance_16<u16>(u32 v) {
+            return static_cast<u16>(v);
+        }
+
+        template<typename Out>
+        void luminance_8_scalar(const u8 *p_src, unsigned stride, const u16 *w, Out *p_dst, std::size_t px) {
+            const unsigned round = 1u << 7;
+            for (std::size_t p = 0; p < px; ++p) {
+                u32 v = round + w[0] * p_src[0];
+                if (1 < stride) {
+                    v += w[1] * p_src[1] + w[2] * p_src[2];
+                }
+                p_dst[p] = narrow_luminance_8<Out>(v >> 8);
+                p_src += stride;
+            }
+        }
+
+        template<typename Out>
+        void luminance_16_scalar(const u16 *p_src, unsigned stride, const u16 *w, Out *p_dst, std::size_t px) {
+            const u32 round = 1u << 14;
+            for (std::size_t p = 0; p < px; ++p) {
+                u32 v = round + static_cast<u32>(w[0]) * p_src[0];
+                if (1 < stride) {
+                    v += static_cast<u32>(w[1]) * p_src[1] + static_cast<u32>(w[2]) * p_src[2];
+                }
+                p_dst[p] = narrow_luminance_16<Out>(v >> 15);
+                p_src += stride;
+            }
+        }
+
+#ifdef PROKYON_X86
+        bool cpu_has_ssse3() {
+#if defined(_MSC_VER)
+            int info[4] = {0, 0, 0, 0};
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+#else
+            return __builtin_cpu_supports("ssse3") != 0;
+#endif
+        }
+
+        // masks[stride - 3][component][chunk] gathers one component of 16 / element_size pixels
+        // from stride consecutive 16 byte chunks of packed input
+        struct DeinterleaveMasks {
+            alignas(16) u8 masks[2][3][4][16];
+        };
+
+        DeinterleaveMasks make_deinterleave_masks(unsigned element_size) {
+            DeinterleaveMasks out;
+            std::memset(&out, 0x80, sizeof(out));
+            const unsigned elements = 16u / element_size;
+            for (unsigned stride = 3; stride <= 4; ++stride) {
+                for (unsigned c = 0; c < 3; ++c) {
+                    for (unsigned e = 0; e < elements; ++e) {
+                        for (unsigned b = 0; b < element_size; ++b) {
+                            auto src = (e * stride + c) * element_size + b;
+                            auto chunk = src / 16u;
+                            out.masks[stride - 3][c][chunk][e * element_size + b] = static_cast<u8>(src % 16u);
+                        }
+                    }
+                }
+            }
+            return out;
+        }
+
+        const DeinterleaveMasks &deinterleave_masks_8() {
+            static const DeinterleaveMasks masks = make_deinterleave_masks(1);
+            return masks;
+        }
+
+        const DeinterleaveMasks &deinterleave_masks_16() {
+            static const DeinterleaveMasks masks = make_deinterleave_masks(2);
+            return masks;
+        }
+
+        PROKYON_TARGET_SSSE3
+        inline __m128i gather(const __m128i *chunks, const u8 (*masks)[16], unsigned stride) {
+            auto v = _mm_shuffle_epi8(chunks[0], _mm_load_si128(reinterpret_cast<const __m128i *>(masks[0])));
+            for (unsigned k = 1; k < stride; ++k) {
+                v = _mm_or_si128(v, _mm_shuffle_epi8(chunks[k], _mm_load_si128(reinterpret_cast<const __m128i *>(masks[k]))));
+            }
+            return v;
+        }
+
+        // 4 windows of 12 input bytes each, aligned to the start of a 16 byte lane
+        PROKYON_TARGET_SSSE3
+        std::size_t expand_alpha_ssse3(const u8 *p_src, u8 *p_dst, std::size_t bytes, const __m128i mask, const __m128i alpha) {
+            std::size_t i = 0;
+            for (; i + 48 <= bytes; i += 48) {
+                auto c0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_src + i));
+                auto c1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_src + i + 16));
+                auto c2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_src + i + 32));
+                __m128i w[4] = {
+                    c0,
+                    _mm_alignr_epi8(c1, c0, 12),
+                    _mm_alignr_epi8(c2, c1, 8),
+                    _mm_srli_si128(c2, 4),
+                };
+                auto p_out = reinterpret_cast<__m128i *>(p_dst + (i / 3) * 4);
+                for (unsigned k = 0; k < 4; ++k) {
+                    _mm_storeu_si128(p_out + k, _mm_or_si128(_mm_shuffle_epi8(w[k], mask), alpha));
+                }
+            }
+            return i;
+        }
+
+        PROKYON_TARGET_SSSE3
+        std::size_t expand_alpha_8_ssse3(const u8 *p_src, u8 *p_dst, std::size_t px) {
+            const auto mask = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+            const auto alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+            return expand_alpha_ssse3(p_src, p_dst, px * 3, mask, alpha) / 3;
+        }
+
+        PROKYON_TARGET_SSSE3
+        std::size_t expand_alpha_16_ssse3(const u8 *p_src, u8 *p_dst, std::size_t px) {
+            const auto mask = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -128, -128, 6, 7, 8, 9, 10, 11, -128, -128);
+            const auto alpha = _mm_set_epi32(static_cast<int>(0xffff0000u), 0, static_cast<int>(0xffff0000u), 0);
+            return expand_alpha_ssse3(p_src, p_dst, px * 6, mask, alpha) / 6;
+        }
+
+        // 16 px per iteration, returns px processed
+        template<typename Out>
+        PROKYON_TARGET_SSSE3
+        std::size_t luminance_8_ssse3(const u8 *p_src, unsigned stride, const u16 *w, Out *p_dst, std::size_t px) {
+            const auto &masks = deinterleave_masks_8().masks[stride - 3];
+            const auto zero = _mm_setzero_si128();
+            const auto round = _mm_set1_epi16(1 << 7);
+            const auto w0 = _mm_set1_epi16(static_cast<short>(w[0]));
+            const auto w1 = _mm_set1_epi16(static_cast<short>(w[1]));
+            const auto w2 = _mm_set1_epi16(static_cast<short>(w[2]));
+            std::size_t p = 0;
+            for (; p + 16 <= px; p += 16) {
+                __m128i chunks[4] = {};
+                for (unsigned k = 0; k < stride; ++k) {
+                    chunks[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_src + p * stride) + k);
+                }
+                auto c0 = gather(chunks, masks[0], stride);
+                auto c1 = gather(chunks, masks[1], stride);
+                auto c2 = gather(chunks, masks[2], stride);
+
+                auto lo = _mm_add_epi16(round, _mm_mullo_epi16(_mm_unpacklo_epi8(c0, zero), w0));
+                lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(c1, zero), w1));
+                lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(c2, zero), w2));
+                lo = _mm_srli_epi16(lo, 8);
+                auto hi = _mm_add_epi16(round, _mm_mullo_epi16(_mm_unpackhi_epi8(c0, zero), w0));
+                hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(c1, zero), w1));
+                hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(c2, zero), w2));
+                hi = _mm_srli_epi16(hi, 8);
+
+                if (sizeof(Out) == 1) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p_dst + p), _mm_packus_epi16(lo, hi));
+                }
+                else {
+                    auto p_out = reinterpret_cast<__m128i *>(p_dst + p);
+                    _mm_storeu_si128(p_out, _mm_or_si128(lo, _mm_slli_epi16(lo, 8)));
+                    _mm_storeu_si128(p_out + 1, _mm_or_si128(hi, _mm_slli_epi16(hi, 8)));
+                }
+            }
+            return p;
+        }
+
+        inline __m128i weighted_32(__m128i v, __m128i w, bool high) {
+            auto lo = _mm_mullo_epi16(v, w);
+            auto hi = _mm_mulhi_epu16(v, w);
+            return high ? _mm_unpackhi_epi16(lo, hi) : _mm_unpacklo_epi16(lo, hi);
+        }
+
+        // 8 px per iteration, returns px processed
+        template<typename Out>
+        PROKYON_TARGET_SSSE3
+        std::size_t luminance_16_ssse3(const u16 *p_src, unsigned stride, const u16 *w, Out *p_dst, std::size_t px) {
+            const auto &masks = deinterleave_masks_16().masks[stride - 3];
+            const auto round = _mm_set1_epi32(1 << 14);
+            const auto bias_32 = _mm_set1_epi32(1 << 15);
+            const auto bias_16 = _mm_set1_epi16(static_cast<short>(0x8000));
+            const auto w0 = _mm_set1_epi16(static_cast<short>(w[0]));
+            const auto w1 = _mm_set1_epi16(static_cast<short>(w[1]));
+            const auto w2 = _mm_set1_epi16(static_cast<short>(w[2]));
+            std::size_t p = 0;
+            for (; p + 8 <= px; p += 8) {
+                __m128i chunks[4] = {};
+                for (unsigned k = 0; k < stride; ++k) {
+                    chunks[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_src + p * stride) + k);
+                }
+                auto c0 = gather(chunks, masks[0], stride);
+                auto c1 = gather(chunks, masks[1], stride);
+                auto c2 = gather(chunks, masks[2], stride);
+
+                __m128i halves[2];
+                for (unsigned h = 0; h < 2; ++h) {
+                    auto v = _mm_add_epi32(round, weighted_32(c0, w0, h == 1));
+                    v = _mm_add_epi32(v, weighted_32(c1, w1, h == 1));
+                    v = _mm_add_epi32(v, weighted_32(c2, w2, h == 1));
+                    halves[h] = _mm_srli_epi32(v, 15);
+                }
+
+                if (sizeof(Out) == 1) {
+                    auto packed = _mm_packs_epi32(_mm_srli_epi32(halves[0], 8), _mm_srli_epi32(halves[1], 8));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(p_dst + p), _mm_packus_epi16(packed, packed));
+                }
+                else {
+                    // no unsigned 32 -> 16 bit pack before SSE4.1, so shift into signed range and back
+                    auto packed = _mm_packs_epi32(_mm_sub_epi32(halves[0], bias_32), _mm_sub_epi32(halves[1], bias_32));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p_dst + p), _mm_add_epi16(packed, bias_16));
+                }
+            }
+            return p;
+        }
+#endif
+
+        bool use_simd() {
+#ifdef PROKYON_X86
+            static const bool has_ssse3 = cpu_has_ssse3();
+            return has_ssse3;
+#else
+            return false;
+#endif
+        }
+
+        template<typename Out>
+        void luminance_8(const u8 *p_src, unsigned stride, const u16 *w, Out *p_dst, std::size_t px) {
+            std::size_t done = 0;
+#ifdef PROKYON_X86
+            if (use_simd() && 3 <= stride) {
+                done = luminance_8_ssse3<Out>(p_src, stride, w, p_dst, px);
+            }
+#endif
+            luminance_8_scalar<Out>(p_src + done * stride, stride, w, p_dst + done, px - done);
+        }
+
+        template<typename Out>
+        void luminance_16(const u16 *p_src, unsigned stride, const u16 *w, Out *p_dst, std::size_t px) {
+            std::size_t done = 0;
+#ifdef PROKYON_X86
+            if (use_simd() && 3 <= stride) {
+                done = luminance_16_ssse3<Out>(p_src, stride, w, p_dst, px);
+            }
+#endif
+            luminance_16_scalar<Out>(p_src + done * stride, stride, w, p_dst + done, px - done);
+        }
+
+        void expand_alpha_8(const u8 *p_src, u8 *p_dst, std::size_t px) {
+            std::size_t done = 0;
+#ifdef PROKYON_X86
+            if (use_simd()) {
+                done = expand_alpha_8_ssse3(p_src, p_dst, px);
+            }
+#endif
+            expand_alpha_8_scalar(p_src + done * 3, p_dst + done * 4, px - done);
+        }
+
+        void expand_alpha_16(const u8 *p_src, u8 *p_dst, std::size_t px) {
+            std::size_t done = 0;
+#ifdef PROKYON_X86
+            if (use_simd()) {
+                done = expand_alpha_16_ssse3(p_src, p_dst, px);
+            }
+#endif
+            expand_alpha_16_scalar(p_src + done * 6, p_dst + done * 8, px - done);
+        }
+
+        // quantize non-negative weights to fixed point with an exact sum of one
+        // so that full scale input maps to full scale output
+        std::array<unsigned short, 3u> quantize(const std::array<double, 3u> &weights, unsigned one) {
+            std::array<unsigned short, 3u> out{};
+            unsigned sum = 0;
+            for (unsigned i = 0; i < 3; ++i) {
+                out[i] = static_cast<unsigned short>(std::lround(weights[i] * one));
+                sum += out[i];
+            }
+            auto largest = static_cast<unsigned>(std::max_element(weights.cbegin(), weights.cend()) - weights.cbegin());
+            out[largest] = static_cast<unsigned short>(out[largest] + one - sum);
+            return out;
+        }
+    }
+
+    RowConverter::RowConverter(unsigned format, OutputMode mode, const LuminanceWeights &weights) :
+        m_kernel{Kernel::Copy},
+        m_source_components{0},
+        m_source_bits{0},
+        m_component_count{0},
+        m_bits_per_component{0},
+        m_weights_q8{},
+        m_weights_q15{}
+    {
+        bool bgr = false;
+        switch (format) {
+            case (DijSDK_EImageFormatGrey8):
+                m_source_components = 1;
+                m_source_bits = 8;
+                break;
+            case (DijSDK_EImageFormatGrey16):
+            case (DijSDK_EImageFormatGreyRaw16):
+                m_source_components = 1;
+                m_source_bits = 16;
+                break;
+            case (DijSDK_EImageFormatRGB888):
+                m_source_components = 3;
+                m_source_bits = 8;
+                break;
+            case (DijSDK_EImageFormatRGB161616):
+                m_source_components = 3;
+                m_source_bits = 16;
+                break;
+            case (DijSDK_EImageFormatBGR888):
+                m_source_components = 3;
+                m_source_bits = 8;
+                bgr = true;
+                break;
+            case (DijSDK_EImageFormatBGR888A):
+                m_source_components = 4;
+                m_source_bits = 8;
+                bgr = true;
+                break;
+            case (DijSDK_EImageFormatNotSpecified):
+            case (DijSDK_EImageFormatBayerRaw16):
+            default:
+                // see is_supported
+                throw ConversionException();
+        }
+
+        auto w = weights;
+        if (bgr) {
+            std::swap(w[0], w[2]);
+        }
+        set_weights(w);
+        select_kernel(mode);
+    }
+
+    unsigned RowConverter::get_component_count() const {
+        return m_component_count;
+    }
+
+    unsigned RowConverter::get_bits_per_component() const {
+        return m_bits_per_component;
+    }
+
+    unsigned RowConverter::get_source_component_count() const {
+        return m_source_components;
+    }
+
+    unsigned RowConverter::get_source_bits_per_component() const {
+        return m_source_bits;
+    }
+
+    unsigned RowConverter::get_source_bytes_per_px() const {
+        return m_source_components * m_source_bits / 8u;
+    }
+
+    unsigned RowConverter::get_bytes_per_px() const {
+        return m_component_count * m_bits_per_component / 8u;
+    }
+
+    void RowConverter::convert(const unsigned char *p_source, unsigned char *p_destination, std::size_t px) const {
+        assert(p_source != nullptr);
+        assert(p_destination != nullptr);
+        switch (m_kernel) {
+            case Kernel::Copy:
+                std::memcpy(p_destination, p_source, px * get_bytes_per_px());
+                break;
+            case Kernel::ExpandAlpha8:
+                expand_alpha_8(p_source, p_destination, px);
+                break;
+            case Kernel::ExpandAlpha16:
+                expand_alpha_16(p_source, p_destination, px);
+                break;
+            case Kernel::Luminance8To8:
+                luminance_8<u8>(p_source, m_source_components, m_weights_q8.data(), p_destination, px);
+                break;
+            case Kernel::Luminance8To16:
+                luminance_8<u16>(p_source, m_source_components, m_weights_q8.data(), reinterpret_cast<u16 *>(p_destination), px);
+                break;
+            case Kernel::Luminance16To8:
+                luminance_16<u8>(reinterpret_cast<const u16 *>(p_source), m_source_components, m_weights_q15.data(), p_destination, px);
+                break;
+            case Kernel::Luminance16To16:
+                luminance_16<u16>(reinterpret_cast<const u16 *>(p_source), m_source_components, m_weights_q15.data(), reinterpret_cast<u16 *>(p_destination), px);
+                break;
+            default:
+                assert(false);
+        }
+    }
+
+    LuminanceWeights RowConverter::default_luminance_weights() {
+        // ITU-R BT.709
+        return {0.2126, 0.7152, 0.0722};
+    }
+
+    bool RowConverter::is_supported(unsigned format) {
+        switch (format) {
+            case (DijSDK_EImageFormatGrey8):
+            case (DijSDK_EImageFormatGrey16):
+            case (DijSDK_EImageFormatGreyRaw16):
+            case (DijSDK_EImageFormatRGB888):
+            case (DijSDK_EImageFormatRGB161616):
+            case (DijSDK_EImageFormatBGR888):
+            case (DijSDK_EImageFormatBGR888A):
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // private
+    void RowConverter::select_kernel(OutputMode mode) {
+        switch (mode) {
+            case OutputMode::Native:
+                m_bits_per_component = m_source_bits;
+                if (m_source_components == 3) {
+                    m_component_count = 4;
+                    m_kernel = (m_source_bits == 8) ? Kernel::ExpandAlpha8 : Kernel::ExpandAlpha16;
+                }
+                else {
+                    m_component_count = m_source_components;
+                    m_kernel = Kernel::Copy;
+                }
+                break;
+            case OutputMode::Luminance8:
+            case OutputMode::Luminance16:
+            {
+                m_component_count = 1;
+                m_bits_per_component = (mode == OutputMode::Luminance8) ? 8u : 16u;
+                if (m_source_components == 1 && m_source_bits == m_bits_per_component) {
+                    m_kernel = Kernel::Copy;
+                }
+                else if (m_source_bits == 8) {
+                    m_kernel = (m_bits_per_component == 8) ? Kernel::Luminance8To8 : Kernel::Luminance8To16;
+                }
+                else {
+                    m_kernel = (m_bits_per_component == 8) ? Kernel::Luminance16To8 : Kernel::Luminance16To16;
+                }
+                break;
+            }
+            default:
+                throw ConversionException();
+        }
+    }
+
+    void RowConverter::set_weights(const LuminanceWeights &weights) {
+        LuminanceWeights w{};
+        if (m_source_components == 1) {
+            w = {1.0, 0.0, 0.0};
+        }
+        else {
+            double sum = 0.0;
+            for (unsigned i = 0; i < 3; ++i) {
+                w[i] = (std::max)(0.0, weights[i]);
+                sum += w[i];
+            }
+            if (sum <= 0.0) {
+                w = default_luminance_weights();
+                sum = 1.0;
+            }
+            for (auto &v : w) {
+                v /= sum;
+            }
+        }
+        m_weights_q8 = quantize(w, M_S_Q8_ONE);
+        m_weights_q15 = quantize(w, M_S_Q15_ONE);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef PROKYON_CONVERSION_H_
+#define PROKYON_CONVERSION_H_
+
+#include <array>
+#include <cstddef>
+#include <exception>
+
+namespace Prokyon {
+    class ConversionException;
+
+    enum class OutputMode : int {
+        Native = 0,
+        Luminance8 = 1,
+        Luminance16 = 2,
+    };
+
+    // red, green, blue, normalized to unit sum before use
+    using LuminanceWeights = std::array<double, 3u>;
+
+    // Converts rows of pixels from the SDK output format into the layout reported to micromanager.
+    // Construct once per frame, then call convert() for each contiguous run of pixels.
+    class RowConverter {
+    public:
+        RowConverter(unsigned format, OutputMode mode, const LuminanceWeights &weights); // throws ConversionException
+
+        unsigned get_component_count() const;
+        unsigned get_bits_per_component() const;
+        unsigned get_source_component_count() const;
+        unsigned get_source_bits_per_component() const;
+        unsigned get_source_bytes_per_px() const;
+        unsigned get_bytes_per_px() const;
+
+        void convert(const unsigned char *p_source, unsigned char *p_destination, std::size_t px) const;
+
+        static LuminanceWeights default_luminance_weights();
+        // sdk output formats a converter can be constructed for, raw bayer is left to the sdk to demosaic
+        static bool is_supported(unsigned format);
+
+    private:
+        enum class Kernel {
+            Copy,
+            ExpandAlpha8,
+            ExpandAlpha16,
+            Luminance8To8,
+            Luminance8To16,
+            Luminance16To8,
+            Luminance16To16,
+        };
+
+        void select_kernel(OutputMode mode); // throws ConversionException
+        void set_weights(const LuminanceWeights &weights);
+
+    private:
+        Kernel m_kernel;
+        unsigned m_source_components;
+        unsigned m_source_bits;
+        unsigned m_component_count;
+        unsigned m_bits_per_component;
+        // weight order matches source component order, i.e. already swapped for BGR formats
+        std::array<unsigned short, 3u> m_weights_q8;
+        std::array<unsigned short, 3u> m_weights_q15;
+
+        static const unsigned M_S_Q8_ONE = 1u << 8;
+        static const unsigned M_S_Q15_ONE = 1u << 15;
+    };
+
+    class ConversionException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
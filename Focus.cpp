@@ -0,0 +1,171 @@
+#include "Focus.h"
+
+#include "Camera.h"
+#include "Image.h"
+#include "Parameters.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+namespace Prokyon {
+    FocusDrive::FocusDrive(Camera *p_camera) : m_p_camera{p_camera} {}
+
+    int FocusDrive::get_position() const {
+        int position = 0;
+        if (read_numeric_parameter<int>(*m_p_camera, ParameterIdCameraFeaturesZPosition, &position, 1)) { throw FocusException(); }
+        return position;
+    }
+
+    void FocusDrive::set_position(int position) {
+        auto min = get_min();
+        auto max = get_max();
+        assert(min <= max);
+        position = (std::min)((std::max)(position, min), max);
+
+        auto result = write_numeric_parameter<int>(*m_p_camera, ParameterIdCameraFeaturesZPosition, &position, 1);
+        if (result) { throw FocusException(); }
+    }
+
+    int FocusDrive::get_min() const {
+        int position = 0;
+        if (read_numeric_parameter<int>(*m_p_camera, ParameterIdCameraFeaturesZPosition, &position, 1, DijSDK_EParamQueryMin)) { throw FocusException(); }
+        return position;
+    }
+
+    int FocusDrive::get_max() const {
+        int position = 0;
+        if (read_numeric_parameter<int>(*m_p_camera, ParameterIdCameraFeaturesZPosition, &position, 1, DijSDK_EParamQueryMax)) { throw FocusException(); }
+        return position;
+    }
+
+    std::string FocusDrive::to_string() const {
+        std::stringstream ss;
+        ss << "Focus drive:\n";
+        ss << "  address: " << this << "\n";
+        ss << "  position (steps): " << get_position() << "\n";
+        ss << "  limits (steps): " << get_min() << ", " << get_max() << "\n";
+        return ss.str();
+    }
+
+    Autofocus::Autofocus(Image *p_image, FocusDrive *p_drive) :
+        m_p_image{p_image},
+        m_p_drive{p_drive},
+        m_values{},
+        m_last_result{0, 0.0, 0}
+    {
+        assert(p_image != nullptr);
+        assert(p_drive != nullptr);
+    }
+
+    Autofocus::Result Autofocus::run(const Settings &settings) {
+        if (settings.range_steps < 1 || settings.fine_step < 1) { throw FocusException(); }
+
+        auto &metric = m_p_image->get_focus_metric();
+        const auto was_enabled = metric.get_enabled();
+        const auto start = m_p_drive->get_position();
+        metric.set_enabled(true);
+
+        Result result{start, 0.0, 0};
+        try {
+            result = search(settings);
+        }
+        catch (FocusException) {
+            metric.set_enabled(was_enabled);
+            try { m_p_drive->set_position(start); }
+            catch (FocusException) {}
+            throw;
+        }
+        metric.set_enabled(was_enabled);
+        m_last_result = result;
+        return result;
+    }
+
+    Autofocus::Result Autofocus::get_last_result() const {
+        return m_last_result;
+    }
+
+    Autofocus::Settings Autofocus::default_settings() {
+        return {200, 7u, 1, 0u};
+    }
+
+    // private
+    Autofocus::Result Autofocus::search(const Settings &settings) {
+        m_values.clear();
+
+        const auto center = m_p_drive->get_position();
+        const auto lo = (std::max)(m_p_drive->get_min(), center - settings.range_steps / 2);
+        const auto hi = (std::min)(m_p_drive->get_max(), center + settings.range_steps / 2);
+        const auto points = (std::max)(3u, settings.coarse_points);
+
+        // coarse scan
+        auto step = (std::max)(1, (hi - lo) / static_cast<int>(points - 1u));
+        auto best = lo;
+        auto best_value = -1.0;
+        for (auto p = lo; p <= hi; p += step) {
+            auto v = measure(p, settings.settle_ms);
+            if (best_value < v) {
+                best = p;
+                best_value = v;
+            }
+        }
+
+        // refine around the best position so far, reusing its value
+        while (settings.fine_step < step) {
+            step = (std::max)(settings.fine_step, step / 3);
+            const auto center_of_step = best;
+            for (auto p : {center_of_step - step, center_of_step + step}) {
+                if (p < lo || hi < p) { continue; }
+                auto v = measure(p, settings.settle_ms);
+                if (best_value < v) {
+                    best = p;
+                    best_value = v;
+                }
+            }
+        }
+
+        // sub step estimate from a parabola through the final three points
+        auto below = m_values.find(best - step);
+        auto above = m_values.find(best + step);
+        if (1 < step && below != m_values.end() && above != m_values.end()) {
+            auto curvature = below->second - 2.0 * best_value + above->second;
+            if (curvature < 0.0) {
+                auto offset = 0.5 * step * (below->second - above->second) / curvature;
+                auto candidate = best + static_cast<int>(std::lround(offset));
+                if (candidate != best && lo <= candidate && candidate <= hi) {
+                    auto v = measure(candidate, settings.settle_ms);
+                    if (best_value < v) {
+                        best = candidate;
+                        best_value = v;
+                    }
+                }
+            }
+        }
+
+        m_p_drive->set_position(best);
+        return {best, best_value, static_cast<unsigned>(m_values.size())};
+    }
+
+    double Autofocus::measure(int position, unsigned settle_ms) {
+        auto it = m_values.find(position);
+        if (it != m_values.end()) { return it->second; }
+
+        m_p_drive->set_position(position);
+        if (0 < settle_ms) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(settle_ms));
+        }
+
+        auto &metric = m_p_image->get_focus_metric();
+        const auto before = metric.get_value().sequence;
+        if (!m_p_image->acquire()) { throw FocusException(); }
+        const auto after = metric.get_value();
+        // no new value means the metric region did not fit the frame
+        if (after.sequence == before) { throw FocusException(); }
+
+        m_values[position] = after.value;
+        return after.value;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef PROKYON_FOCUS_H_
+#define PROKYON_FOCUS_H_
+
+#include <exception>
+#include <map>
+#include <string>
+
+namespace Prokyon {
+    class Camera;
+    class Image;
+
+    // Z drive of the camera, ParameterIdCameraFeaturesZPosition, in hardware steps
+    class FocusDrive {
+    public:
+        FocusDrive(Camera *p_camera);
+
+        int get_position() const; // throws FocusException
+        void set_position(int position); // throws FocusException, clips to hardware limits
+        int get_min() const; // throws FocusException
+        int get_max() const; // throws FocusException
+
+        std::string to_string() const;
+
+    private:
+        Camera *m_p_camera;
+    };
+
+    // Coarse to fine search for the maximum of the focus metric around the current position.
+    // A coarse scan over the range is followed by three point refinements at a third of the step each,
+    // so a search costs coarse_points + 2 frames per refinement instead of a full scan at fine resolution.
+    class Autofocus {
+    public:
+        struct Settings {
+            int range_steps; // full width of the coarse scan, centered on the current position
+            unsigned coarse_points;
+            int fine_step; // refinement stops at this step size
+            unsigned settle_ms; // wait after each move before acquiring
+        };
+
+        struct Result {
+            int position;
+            double value;
+            unsigned frames;
+        };
+
+        Autofocus(Image *p_image, FocusDrive *p_drive);
+
+        // blocks until done and leaves the drive at the best position
+        // on failure the drive is moved back to where it started
+        Result run(const Settings &settings); // throws FocusException
+        Result get_last_result() const;
+
+        static Settings default_settings();
+
+    private:
+        Result search(const Settings &settings); // throws FocusException
+        double measure(int position, unsigned settle_ms); // throws FocusException
+
+    private:
+        Image *m_p_image;
+        FocusDrive *m_p_drive;
+        std::map<int, double> m_values; // metric by position, current run
+        Result m_last_result;
+    };
+
+    class FocusException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "FocusMetric.h"
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PROKYON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Prokyon {
+    namespace {
+        // offset of the measured component, green for RGBA
+        unsigned measured_component(unsigned components) {
+            return (components == 1) ? 0u : 1u;
+        }
+
+        template<typename T>
+        std::uint64_t brenner_scalar(const T *p_row, std::size_t first, std::size_t count, unsigned stride, unsigned offset) {
+            std::uint64_t sum = 0;
+            for (auto x = first; x < count; ++x) {
+                auto a = static_cast<std::int64_t>(p_row[x * stride + offset]);
+                auto b = static_cast<std::int64_t>(p_row[(x + 2) * stride + offset]);
+                sum += static_cast<std::uint64_t>((b - a) * (b - a));
+            }
+            return sum;
+        }
+
+#ifdef PROKYON_SSE2
+        std::uint64_t horizontal_sum_64(__m128i v) {
+            alignas(16) std::uint64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), v);
+            return lanes[0] + lanes[1];
+        }
+
+        __m128i widen_add_32(__m128i acc64, __m128i v32) {
+            const auto zero = _mm_setzero_si128();
+            acc64 = _mm_add_epi64(acc64, _mm_unpacklo_epi32(v32, zero));
+            return _mm_add_epi64(acc64, _mm_unpackhi_epi32(v32, zero));
+        }
+#endif
+    }
+
+    FocusMetric::FocusMetric() :
+        m_enabled{false},
+        m_roi{0, 0, 0, 0},
+        m_roi_frame{0, 0, 0, 0},
+        m_width{0},
+        m_components{0},
+        m_bits_per_component{0},
+        m_sum{0},
+        m_count{0},
+        m_active{false},
+        m_mutex{},
+        m_value{0.0, 0}
+    {}
+
+    bool FocusMetric::get_enabled() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_enabled;
+    }
+
+    void FocusMetric::set_enabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_enabled = enabled;
+    }
+
+    ROI FocusMetric::get_roi() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_roi;
+    }
+
+    void FocusMetric::set_roi(const ROI &roi) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_roi = roi;
+    }
+
+    bool FocusMetric::begin_frame(unsigned width, unsigned height, unsigned components, unsigned bits_per_component) {
+        assert(!m_active);
+        assert(bits_per_component == 8 || bits_per_component == 16);
+
+        ROI roi{0, 0, 0, 0};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_enabled) { return false; }
+            roi = m_roi;
+        }
+
+        if (roi[W_ind] == 0 || roi[H_ind] == 0) {
+            roi = {0, 0, width, height};
+        }
+        // clip to the frame, the roi may be stale after a size change
+        roi[X_ind] = (std::min)(roi[X_ind], width);
+        roi[Y_ind] = (std::min)(roi[Y_ind], height);
+        roi[W_ind] = (std::min)(roi[W_ind], width - roi[X_ind]);
+        roi[H_ind] = (std::min)(roi[H_ind], height - roi[Y_ind]);
+        if (roi[W_ind] < 3 || roi[H_ind] == 0) { return false; }
+
+        m_roi_frame = roi;
+        m_width = width;
+        m_components = components;
+        m_bits_per_component = bits_per_component;
+        m_sum = 0;
+        m_count = 0;
+        m_active = true;
+        return true;
+    }
+
+    void FocusMetric::accumulate_rows(const unsigned char *p_rows, unsigned first_row, unsigned row_count) {
+        if (!m_active) { return; }
+        assert(p_rows != nullptr);
+
+        const auto bytes_per_px = static_cast<std::size_t>(m_components) * (m_bits_per_component / 8u);
+        const auto row_bytes = m_width * bytes_per_px;
+        const auto y_begin = (std::max)(first_row, m_roi_frame[Y_ind]);
+        const auto y_end = (std::min)(first_row + row_count, m_roi_frame[Y_ind] + m_roi_frame[H_ind]);
+        for (auto y = y_begin; y < y_end; ++y) {
+            auto p_row = p_rows + (y - first_row) * row_bytes + m_roi_frame[X_ind] * bytes_per_px;
+            if (m_bits_per_component == 8) {
+                m_sum += row_8(p_row);
+            }
+            else {
+                m_sum += row_16(reinterpret_cast<const std::uint16_t *>(p_row));
+            }
+            m_count += m_roi_frame[W_ind] - 2u;
+        }
+    }
+
+    void FocusMetric::end_frame() {
+        if (!m_active) { return; }
+        m_active = false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_value.value = (m_count == 0) ? 0.0 : static_cast<double>(m_sum) / static_cast<double>(m_count);
+        ++m_value.sequence;
+    }
+
+    FocusValue FocusMetric::get_value() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_value;
+    }
+
+    std::string FocusMetric::to_string() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::stringstream ss;
+        ss << "Focus metric:\n";
+        ss << "  enabled: " << m_enabled << "\n";
+        ss << "  roi: " << m_roi[X_ind] << ", " << m_roi[Y_ind] << ", " << m_roi[W_ind] << ", " << m_roi[H_ind] << "\n";
+        ss << "  value: " << m_value.value << "\n";
+        ss << "  frames measured: " << m_value.sequence << "\n";
+        return ss.str();
+    }
+
+    // private
+    std::uint64_t FocusMetric::row_8(const unsigned char *p_row) const {
+        const std::size_t count = m_roi_frame[W_ind] - 2u;
+        std::size_t x = 0;
+        std::uint64_t sum = 0;
+#ifdef PROKYON_SSE2
+        if (m_components == 1) {
+            const auto zero = _mm_setzero_si128();
+            auto acc64 = _mm_setzero_si128();
+            while (x + 16 <= count) {
+                // each 32 bit lane grows by at most 4 * 255^2 per step, flush well before it can wrap
+                auto acc32 = _mm_setzero_si128();
+                for (unsigned i = 0; i < 4096 && x + 16 <= count; ++i, x += 16) {
+                    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row + x));
+                    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row + x + 2));
+                    auto d = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+                    auto lo = _mm_unpacklo_epi8(d, zero);
+                    auto hi = _mm_unpackhi_epi8(d, zero);
+                    acc32 = _mm_add_epi32(acc32, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+                }
+                acc64 = widen_add_32(acc64, acc32);
+            }
+            sum = horizontal_sum_64(acc64);
+        }
+#endif
+        return sum + brenner_scalar(p_row, x, count, m_components, measured_component(m_components));
+    }
+
+    std::uint64_t FocusMetric::row_16(const std::uint16_t *p_row) const {
+        const std::size_t count = m_roi_frame[W_ind] - 2u;
+        std::size_t x = 0;
+        std::uint64_t sum = 0;
+#ifdef PROKYON_SSE2
+        if (m_components == 1) {
+            auto acc64 = _mm_setzero_si128();
+            for (; x + 8 <= count; x += 8) {
+                auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row + x));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row + x + 2));
+                auto d = _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+                // full 32 bit squares from the low and high halves of the 16 bit products
+                auto lo = _mm_mullo_epi16(d, d);
+                auto hi = _mm_mulhi_epu16(d, d);
+                acc64 = widen_add_32(acc64, _mm_unpacklo_epi16(lo, hi));
+                acc64 = widen_add_32(acc64, _mm_unpackhi_epi16(lo, hi));
+            }
+            sum = horizontal_sum_64(acc64);
+        }
+#endif
+        return sum + brenner_scalar(p_row, x, count, m_components, measured_component(m_components));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef PROKYON_FOCUS_METRIC_H_
+#define PROKYON_FOCUS_METRIC_H_
+
+#include "RegionOfInterest.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Prokyon {
+    struct FocusValue {
+        double value; // mean squared Brenner gradient, larger is sharper
+        unsigned long long sequence; // 0 until a frame was measured
+    };
+
+    // Brenner gradient sum((I(x + 2, y) - I(x, y))^2) over a region of the converted image.
+    // Fed strip by strip from Image::copy_image_data like Preview, so no second pass over the frame is needed.
+    // Color frames are measured on the green component.
+    class FocusMetric {
+    public:
+        FocusMetric();
+
+        bool get_enabled() const;
+        void set_enabled(bool enabled);
+        ROI get_roi() const;
+        void set_roi(const ROI &roi); // relative to the converted image, zero width or height for the whole image
+
+        // conversion side, returns true if this frame is measured
+        bool begin_frame(unsigned width, unsigned height, unsigned components, unsigned bits_per_component);
+        void accumulate_rows(const unsigned char *p_rows, unsigned first_row, unsigned row_count);
+        void end_frame();
+
+        // reader side, latest complete measurement
+        FocusValue get_value() const;
+
+        std::string to_string() const;
+
+    private:
+        std::uint64_t row_8(const unsigned char *p_row) const;
+        std::uint64_t row_16(const std::uint16_t *p_row) const;
+
+    private:
+        bool m_enabled;
+        ROI m_roi;
+
+        // current frame
+        ROI m_roi_frame;
+        unsigned m_width;
+        unsigned m_components;
+        unsigned m_bits_per_component;
+        std::uint64_t m_sum;
+        std::uint64_t m_count;
+        bool m_active;
+
+        mutable std::mutex m_mutex;
+        FocusValue m_value;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef PROKYON_FRAME_LAYOUT_H_
+#define PROKYON_FRAME_LAYOUT_H_
+
+#include <cstddef>
+
+namespace Prokyon {
+    // Geometry and pixel format of one frame buffer, planes of equal size stored back to back.
+    struct FrameLayout {
+        unsigned width;
+        unsigned height;
+        unsigned components;
+        unsigned bits_per_component;
+        unsigned channels; // sub region planes
+        unsigned format; // SDK image format of a raw frame, 0 once converted
+
+        std::size_t bytes_per_px() const {
+            return static_cast<std::size_t>(components) * (bits_per_component / 8u);
+        }
+
+        std::size_t plane_bytes() const {
+            return static_cast<std::size_t>(width) * height * bytes_per_px();
+        }
+
+        std::size_t bytes() const {
+            return plane_bytes() * channels;
+        }
+
+        bool is_raw() const {
+            return format != 0;
+        }
+    };
+
+    inline bool operator==(const FrameLayout &a, const FrameLayout &b) {
+        return a.width == b.width && a.height == b.height && a.components == b.components
+            && a.bits_per_component == b.bits_per_component && a.channels == b.channels && a.format == b.format;
+    }
+
+    inline bool operator!=(const FrameLayout &a, const FrameLayout &b) {
+        return !(a == b);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include "FrameMemory.h"
+
+#include <cassert>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace Prokyon {
+    FrameBuffer::FrameBuffer() :
+        m_p_data{nullptr},
+        m_bytes{0},
+        m_mapped_bytes{0},
+        m_locked{false},
+        m_huge{false}
+    {}
+
+    FrameBuffer::FrameBuffer(std::size_t bytes, const Options &options) :
+        m_p_data{nullptr},
+        m_bytes{bytes},
+        m_mapped_bytes{0},
+        m_locked{false},
+        m_huge{false}
+    {
+        if (bytes == 0) { return; }
+        allocate(options);
+        if (m_p_data == nullptr) { throw FrameMemoryException(); }
+        prefault();
+    }
+
+    FrameBuffer::~FrameBuffer() {
+        release();
+    }
+
+    FrameBuffer::FrameBuffer(FrameBuffer &&other) noexcept :
+        m_p_data{other.m_p_data},
+        m_bytes{other.m_bytes},
+        m_mapped_bytes{other.m_mapped_bytes},
+        m_locked{other.m_locked},
+        m_huge{other.m_huge}
+    {
+        other.m_p_data = nullptr;
+        other.m_bytes = 0;
+        other.m_mapped_bytes = 0;
+    }
+
+    FrameBuffer &FrameBuffer::operator=(FrameBuffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(m_p_data, other.m_p_data);
+            std::swap(m_bytes, other.m_bytes);
+            std::swap(m_mapped_bytes, other.m_mapped_bytes);
+            std::swap(m_locked, other.m_locked);
+            std::swap(m_huge, other.m_huge);
+        }
+        return *this;
+    }
+
+    unsigned char *FrameBuffer::data() {
+        return m_p_data;
+    }
+
+    const unsigned char *FrameBuffer::data() const {
+        return m_p_data;
+    }
+
+    std::size_t FrameBuffer::size() const {
+        return m_bytes;
+    }
+
+    bool FrameBuffer::empty() const {
+        return m_bytes == 0;
+    }
+
+    bool FrameBuffer::is_locked() const {
+        return m_locked;
+    }
+
+    bool FrameBuffer::is_huge() const {
+        return m_huge;
+    }
+
+    FrameBuffer::Options FrameBuffer::default_options() {
+        return {false, false};
+    }
+
+    // private
+    void FrameBuffer::prefault() {
+        // the OS hands out zeroed pages, writing one byte per page maps them all now instead of on first use
+        const auto page = get_page_size();
+        volatile unsigned char *p = m_p_data;
+        for (std::size_t offset = 0; offset < m_mapped_bytes; offset += page) {
+            p[offset] = 0;
+        }
+    }
+
+#ifdef _WIN32
+    std::size_t FrameBuffer::get_page_size() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+    }
+
+    std::uint64_t FrameBuffer::get_page_fault_count() {
+        PROCESS_MEMORY_COUNTERS counters{};
+        counters.cb = sizeof(counters);
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+        return counters.PageFaultCount;
+    }
+
+    void FrameBuffer::allocate(const Options &options) {
+        if (options.huge_pages) {
+            // needs SeLockMemoryPrivilege, large pages are never paged out so they count as locked
+            auto large = GetLargePageMinimum();
+            if (0 < large) {
+                auto bytes = (m_bytes + large - 1) / large * large;
+                m_p_data = static_cast<unsigned char *>(VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+                if (m_p_data != nullptr) {
+                    m_mapped_bytes = bytes;
+                    m_huge = true;
+                    m_locked = true;
+                    return;
+                }
+            }
+        }
+
+        const auto page = get_page_size();
+        m_mapped_bytes = (m_bytes + page - 1) / page * page;
+        m_p_data = static_cast<unsigned char *>(VirtualAlloc(nullptr, m_mapped_bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (m_p_data == nullptr) { return; }
+
+        if (options.lock) {
+            m_locked = VirtualLock(m_p_data, m_mapped_bytes) != 0;
+            if (!m_locked) {
+                // the default working set is small, grow it by this buffer and retry
+                SIZE_T min_size = 0;
+                SIZE_T max_size = 0;
+                auto process = GetCurrentProcess();
+                if (GetProcessWorkingSetSize(process, &min_size, &max_size)
+                    && SetProcessWorkingSetSize(process, min_size + m_mapped_bytes, max_size + m_mapped_bytes)) {
+                    m_locked = VirtualLock(m_p_data, m_mapped_bytes) != 0;
+                }
+            }
+        }
+    }
+
+    void FrameBuffer::release() {
+        if (m_p_data == nullptr) { return; }
+        if (m_locked && !m_huge) {
+            VirtualUnlock(m_p_data, m_mapped_bytes);
+        }
+        VirtualFree(m_p_data, 0, MEM_RELEASE);
+        m_p_data = nullptr;
+        m_bytes = 0;
+        m_mapped_bytes = 0;
+        m_locked = false;
+        m_huge = false;
+    }
+#else
+    std::size_t FrameBuffer::get_page_size() {
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    std::uint64_t FrameBuffer::get_page_fault_count() {
+        rusage usage{};
+#ifdef RUSAGE_THREAD
+        if (getrusage(RUSAGE_THREAD, &usage) != 0) { return 0; }
+#else
+        if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#endif
+        return static_cast<std::uint64_t>(usage.ru_minflt + usage.ru_majflt);
+    }
+
+    void FrameBuffer::allocate(const Options &options) {
+        void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (options.huge_pages) {
+            // needs pages reserved in /proc/sys/vm/nr_hugepages, 2 MB on x86-64
+            const std::size_t huge = std::size_t{2} << 20;
+            auto bytes = (m_bytes + huge - 1) / huge * huge;
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                m_mapped_bytes = bytes;
+                m_huge = true;
+            }
+        }
+#endif
+        if (p == MAP_FAILED) {
+            const auto page = get_page_size();
+            m_mapped_bytes = (m_bytes + page - 1) / page * page;
+            p = mmap(nullptr, m_mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                m_mapped_bytes = 0;
+                return;
+            }
+#ifdef MADV_HUGEPAGE
+            if (options.huge_pages) {
+                // transparent huge pages, if the kernel allows
+                madvise(p, m_mapped_bytes, MADV_HUGEPAGE);
+            }
+#endif
+        }
+        m_p_data = static_cast<unsigned char *>(p);
+
+        if (options.lock) {
+            // bounded by RLIMIT_MEMLOCK without CAP_IPC_LOCK
+            m_locked = mlock(m_p_data, m_mapped_bytes) == 0;
+        }
+    }
+
+    void FrameBuffer::release() {
+        if (m_p_data == nullptr) { return; }
+        if (m_locked) {
+            munlock(m_p_data, m_mapped_bytes);
+        }
+        munmap(m_p_data, m_mapped_bytes);
+        m_p_data = nullptr;
+        m_bytes = 0;
+        m_mapped_bytes = 0;
+        m_locked = false;
+        m_huge = false;
+    }
+#endif
+}
\ No newline at end of file
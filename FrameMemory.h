@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef PROKYON_FRAME_MEMORY_H_
+#define PROKYON_FRAME_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+namespace Prokyon {
+    // Frame buffer taken directly from the OS, page aligned (so also cache line aligned)
+    // and prefaulted at allocation, so the first frame written into it takes no page faults.
+    // Locking and huge pages are best effort: without the privileges the buffer is still allocated, just without them.
+    class FrameBuffer {
+    public:
+        struct Options {
+            bool lock; // keep resident, VirtualLock / mlock
+            bool huge_pages; // large pages, fewer TLB misses on full frame passes
+        };
+
+        FrameBuffer();
+        FrameBuffer(std::size_t bytes, const Options &options); // throws FrameMemoryException if no memory at all
+        ~FrameBuffer();
+        FrameBuffer(const FrameBuffer &) = delete;
+        FrameBuffer &operator=(const FrameBuffer &) = delete;
+        FrameBuffer(FrameBuffer &&other) noexcept;
+        FrameBuffer &operator=(FrameBuffer &&other) noexcept;
+
+        unsigned char *data();
+        const unsigned char *data() const;
+        std::size_t size() const;
+        bool empty() const;
+        bool is_locked() const;
+        bool is_huge() const;
+
+        static Options default_options();
+        static std::size_t get_page_size();
+        // page faults so far, of the calling thread where the OS counts per thread, else of the process
+        static std::uint64_t get_page_fault_count();
+
+    private:
+        void allocate(const Options &options); // uses m_bytes
+        void prefault();
+        void release();
+
+    private:
+        unsigned char *m_p_data;
+        std::size_t m_bytes;
+        std::size_t m_mapped_bytes;
+        bool m_locked;
+        bool m_huge;
+    };
+
+    class FrameMemoryException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "FramePublisher.h"
+
+#include "SharedFrameLayout.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Prokyon {
+    FramePublisher::FramePublisher() :
+        m_mutex{},
+        m_name{},
+        m_p_base{nullptr},
+        m_bytes{0},
+        m_p_header{nullptr},
+        m_sequence{0},
+        m_skipped{0},
+#ifdef _WIN32
+        m_mapping{nullptr}
+#else
+        m_shm_name{}
+#endif
+    {}
+
+    FramePublisher::~FramePublisher() {
+        close();
+    }
+
+    bool FramePublisher::open(const std::string &name, unsigned slot_count, std::size_t slot_capacity) {
+        if (name.empty() || slot_count < 2 || slot_capacity == 0) { return false; }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unmap();
+        m_name = name;
+        if (!map(SharedFrameLayout::total_bytes(slot_count, slot_capacity))) {
+            unmap();
+            return false;
+        }
+
+        // header last, a reader seeing the magic sees a consistent ring
+        m_p_header = new (m_p_base) SharedRingHeader{};
+        m_p_header->version = SharedFrameLayout::M_S_VERSION;
+        m_p_header->slot_count = slot_count;
+        m_p_header->reserved = 0;
+        m_p_header->slot_stride = SharedFrameLayout::slot_stride(slot_capacity);
+        m_p_header->slot_capacity = slot_capacity;
+        m_p_header->write_sequence.store(0, std::memory_order_relaxed);
+        for (unsigned s = 0; s < slot_count; ++s) {
+            auto p_slot = m_p_base + SharedFrameLayout::slot_offset(s, static_cast<std::size_t>(m_p_header->slot_stride));
+            auto p_slot_header = new (p_slot) SharedSlotHeader{};
+            p_slot_header->sequence.store(0, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        m_p_header->magic = SharedFrameLayout::M_S_MAGIC;
+
+        m_sequence = 0;
+        m_skipped = 0;
+        return true;
+    }
+
+    void FramePublisher::close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unmap();
+    }
+
+    bool FramePublisher::is_open() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_p_header != nullptr;
+    }
+
+    void FramePublisher::publish(const unsigned char *p_data, std::size_t bytes, unsigned width, unsigned height, unsigned components, unsigned bits_per_component, unsigned channel) {
+        assert(p_data != nullptr);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_p_header == nullptr) { return; }
+        if (m_p_header->slot_capacity < bytes) {
+            ++m_skipped;
+            return;
+        }
+
+        const auto n = m_sequence + 1;
+        auto p_slot = m_p_base + SharedFrameLayout::slot_offset(static_cast<std::size_t>(n % m_p_header->slot_count), static_cast<std::size_t>(m_p_header->slot_stride));
+        auto p_slot_header = reinterpret_cast<SharedSlotHeader *>(p_slot);
+
+        // odd while writing, so a reader still copying the previous frame of this slot rejects its copy
+        p_slot_header->sequence.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        p_slot_header->timestamp_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+        p_slot_header->width = width;
+        p_slot_header->height = height;
+        p_slot_header->components = components;
+        p_slot_header->bits_per_component = bits_per_component;
+        p_slot_header->channel = channel;
+        p_slot_header->bytes = bytes;
+        std::memcpy(p_slot + SharedFrameLayout::data_offset(), p_data, bytes);
+
+        p_slot_header->sequence.store(2 * n, std::memory_order_release);
+        m_p_header->write_sequence.store(n, std::memory_order_release);
+        m_sequence = n;
+    }
+
+    std::uint64_t FramePublisher::get_published_count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sequence;
+    }
+
+    std::uint64_t FramePublisher::get_skipped_count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_skipped;
+    }
+
+    std::string FramePublisher::to_string() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::stringstream ss;
+        ss << "Frame publisher:\n";
+        ss << "  name: " << m_name << "\n";
+        ss << "  open: " << (m_p_header != nullptr) << "\n";
+        if (m_p_header != nullptr) {
+            ss << "  slots: " << m_p_header->slot_count << "\n";
+            ss << "  slot capacity (bytes): " << m_p_header->slot_capacity << "\n";
+        }
+        ss << "  published: " << m_sequence << "\n";
+        ss << "  skipped: " << m_skipped << "\n";
+        return ss.str();
+    }
+
+    FramePublisher::Settings FramePublisher::default_settings() {
+        return {"ProkyonFrames", 8u, 0u};
+    }
+
+    // private
+#ifdef _WIN32
+    bool FramePublisher::map(std::size_t bytes) {
+        auto object_name = "Local\\" + m_name;
+        auto size = static_cast<unsigned long long>(bytes);
+        m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xffffffffull), object_name.c_str());
+        if (m_mapping == nullptr) { return false; }
+        // a smaller mapping of this name still held open by a reader fails here
+        m_p_base = static_cast<unsigned char *>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes));
+        if (m_p_base == nullptr) { return false; }
+        m_bytes = bytes;
+        return true;
+    }
+
+    void FramePublisher::unmap() {
+        if (m_p_header != nullptr) {
+            // tell readers still attached that this ring is gone
+            m_p_header->magic = 0;
+            m_p_header = nullptr;
+        }
+        if (m_p_base != nullptr) {
+            UnmapViewOfFile(m_p_base);
+            m_p_base = nullptr;
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+        m_bytes = 0;
+    }
+#else
+    bool FramePublisher::map(std::size_t bytes) {
+        m_shm_name = "/" + m_name;
+        auto fd = shm_open(m_shm_name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) {
+            m_shm_name.clear();
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        auto p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { return false; }
+        m_p_base = static_cast<unsigned char *>(p);
+        m_bytes = bytes;
+        return true;
+    }
+
+    void FramePublisher::unmap() {
+        if (m_p_header != nullptr) {
+            // tell readers still attached that this ring is gone
+            m_p_header->magic = 0;
+            m_p_header = nullptr;
+        }
+        if (m_p_base != nullptr) {
+            munmap(m_p_base, m_bytes);
+            m_p_base = nullptr;
+        }
+        if (!m_shm_name.empty()) {
+            shm_unlink(m_shm_name.c_str());
+            m_shm_name.clear();
+        }
+        m_bytes = 0;
+    }
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef PROKYON_FRAME_PUBLISHER_H_
+#define PROKYON_FRAME_PUBLISHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Prokyon {
+    struct SharedRingHeader;
+
+    // Writes converted frames into a named shared memory ring, see SharedFrameLayout.h.
+    // Readers in other processes map it read only and never block the writer, a slow reader just loses frames.
+    class FramePublisher {
+    public:
+        struct Settings {
+            std::string name;
+            unsigned slot_count;
+            unsigned slot_size_mb; // 0 sizes the slots for the frame size at opening
+        };
+
+        FramePublisher();
+        ~FramePublisher();
+        FramePublisher(const FramePublisher &) = delete;
+        FramePublisher &operator=(const FramePublisher &) = delete;
+
+        bool open(const std::string &name, unsigned slot_count, std::size_t slot_capacity); // returns success
+        void close();
+        bool is_open() const;
+
+        // frames larger than the slot capacity are counted and skipped
+        void publish(const unsigned char *p_data, std::size_t bytes, unsigned width, unsigned height, unsigned components, unsigned bits_per_component, unsigned channel);
+
+        std::uint64_t get_published_count() const;
+        std::uint64_t get_skipped_count() const;
+        std::string to_string() const;
+
+        static Settings default_settings();
+
+    private:
+        bool map(std::size_t bytes); // returns success
+        void unmap();
+
+    private:
+        mutable std::mutex m_mutex;
+        std::string m_name;
+        unsigned char *m_p_base;
+        std::size_t m_bytes;
+        SharedRingHeader *m_p_header;
+        std::uint64_t m_sequence;
+        std::uint64_t m_skipped;
+#ifdef _WIN32
+        void *m_mapping;
+#else
+        std::string m_shm_name;
+#endif
+    };
+}
+
+#endif
\ No newline at end of file
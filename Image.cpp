@@ -2,12 +2,17 @@
 
 #include "Camera.h"
 #include "Parameters.h"
+#include "SdkThread.h"
+#include "SharedFrameLayout.h"
 
 #include "dijsdk.h"
 #include "parameterif.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <utility>
 
 // TODO error checking
 // all functions relying on HW access can possibly fail
@@ -19,47 +24,68 @@
 // this requires storing these values as they are computed in some way
 
 namespace Prokyon {
+    namespace {
+        // runs an sdk clean up on every way out of a scope, exceptions included, unless dismissed
+        template<typename F>
+        class ScopeGuard {
+        public:
+            explicit ScopeGuard(F f) : m_f(std::move(f)), m_active{true} {}
+            ScopeGuard(ScopeGuard &&other) : m_f(std::move(other.m_f)), m_active{other.m_active} { other.m_active = false; }
+            ~ScopeGuard() { if (m_active) { m_f(); } }
+            ScopeGuard(const ScopeGuard &) = delete;
+            ScopeGuard &operator=(const ScopeGuard &) = delete;
+
+            void dismiss() { m_active = false; }
+
+        private:
+            F m_f;
+            bool m_active;
+        };
+
+        template<typename F>
+        ScopeGuard<F> make_scope_guard(F f) {
+            return ScopeGuard<F>(std::move(f));
+        }
+    }
+
     // public member functions
-    Image::Image(Camera *p_camera) :
+    Image::Image(Camera *p_camera, BufferPool *p_pool) :
         m_p_camera{p_camera},
-        m_data(M_S_BUFFER_SIZE, 0),
+        m_p_pool{p_pool},
+        m_p_roi{nullptr},
+        m_data{},
         m_image_size{M_S_IMAGE_SIZE_DEFAULT},
         m_bits_per_component{M_S_BITS_PER_COMPONENT_DEFAULT},
-        m_p_component_names{&M_S_GRAY_COMPONENT_NAMES}
+        m_p_component_names{&M_S_GRAY_COMPONENT_NAMES},
+        m_output_mode{OutputMode::Native},
+        m_luminance_weights(RowConverter::default_luminance_weights()),
+        m_crops{},
+        m_p_plan{nullptr},
+        m_preview{},
+        m_focus_metric{},
+        m_publisher{},
+        m_publish_preview{false},
+        m_statistics_mutex{},
+        m_statistics{0.0, 0, 0.0, 0, 0}
     {}
 
-    bool Image::acquire() {
-        auto result = DijSDK_StartAcquisition(*m_p_camera);
-        if (result != E_OK) { return false; }
-
-        ImageHandle image_handle;
-        void *p_raw_data = nullptr;
-        result = DijSDK_GetImage(*m_p_camera, &image_handle, &p_raw_data);
-        if (result != E_OK) { return false; }
-
-        try {
-            copy_image_data(p_raw_data);
-        }
-        catch (ImageException) {
-            return false;
-        }
-
-        result = DijSDK_ReleaseImage(image_handle);
-        if (result != E_OK) { return false; }
-
-        result = DijSDK_AbortAcquisition(*m_p_camera);
-        if (result != E_OK) { return false; }
+    Image::~Image() {
+        release_buffer();
+    }
 
-        return true;
+    bool Image::acquire() {
+        // one frame command from start to abort, no parameter write lands in between
+        return SdkThread::call_frame([this]() { return acquire_on_sdk_thread(); });
     }
 
     bool Image::update() {
+        m_p_plan.reset(nullptr);
         try {
-            update_impl(
-                extract_size(),
-                extract_bits_per_component(),
-                select_component_name_map(extract_component_count())
-            );
+            auto p_plan = std::make_unique<ConversionPlan>(make_conversion_plan());
+            const auto &out = p_plan->output;
+            reserve(out.bytes());
+            update_impl(Size{out.width, out.height}, out.bits_per_component, select_component_name_map(out.components));
+            m_p_plan = std::move(p_plan);
         }
         catch (ImageException) {
             return false;
@@ -67,6 +93,11 @@ namespace Prokyon {
         return true;
     }
 
+    void Image::set_region_of_interest(const RegionOfInterest *p_roi) {
+        m_p_roi = p_roi;
+        m_p_plan.reset(nullptr);
+    }
+
     ImageBuffer Image::get_image_buffer() {
         return m_data.data();
     }
@@ -75,6 +106,31 @@ namespace Prokyon {
         return m_data.data();
     }
 
+    ImageBuffer Image::get_image_buffer(unsigned channel) const {
+        assert(channel < get_number_of_channels());
+        if (m_data.empty()) {
+            return nullptr;
+        }
+        return m_data.data() + channel * get_image_buffer_size();
+    }
+
+    unsigned Image::get_number_of_channels() const {
+        return m_crops.empty() ? 1u : static_cast<unsigned>(m_crops.size());
+    }
+
+    std::string Image::get_channel_name(unsigned channel) const {
+        assert(channel < get_number_of_channels());
+        std::stringstream ss;
+        if (m_crops.empty()) {
+            ss << "Full";
+        }
+        else {
+            const auto &r = m_crops[channel];
+            ss << "Region " << channel << " (" << r[X_ind] << ", " << r[Y_ind] << ")";
+        }
+        return ss.str();
+    }
+
     unsigned Image::get_number_of_components() const {
         auto num = m_p_component_names->size();
         assert(0 < num && num <= 4);
@@ -124,6 +180,186 @@ namespace Prokyon {
         }
     }
 
+    FrameLayout Image::get_layout() const {
+        return {get_image_width(), get_image_height(), get_number_of_components(), get_bit_depth(), get_number_of_channels(), 0u};
+    }
+
+    bool Image::has_supported_format() const {
+        try { return RowConverter::is_supported(extract_format()); }
+        catch (ImageException) { return false; }
+    }
+
+    OutputMode Image::get_output_mode() const {
+        return m_output_mode;
+    }
+
+    void Image::set_output_mode(OutputMode mode) {
+        m_output_mode = mode;
+        m_p_plan.reset(nullptr);
+    }
+
+    LuminanceWeights Image::get_luminance_weights() const {
+        return m_luminance_weights;
+    }
+
+    void Image::set_luminance_weights(const LuminanceWeights &weights) {
+        m_luminance_weights = weights;
+        m_p_plan.reset(nullptr);
+    }
+
+    std::vector<ROI> Image::get_crops() const {
+        return m_crops;
+    }
+
+    void Image::set_crops(const std::vector<ROI> &crops) {
+        if (!check_crops(crops)) { throw ImageException(); }
+        m_crops = crops;
+        m_p_plan.reset(nullptr);
+    }
+
+    bool Image::check_crops(const std::vector<ROI> &crops) {
+        for (const auto &r : crops) {
+            if (r[W_ind] == 0 || r[H_ind] == 0) { return false; }
+            // micromanager requires all channels of a camera to share one geometry
+            if (r[W_ind] != crops[0][W_ind] || r[H_ind] != crops[0][H_ind]) { return false; }
+        }
+        return true;
+    }
+
+    void Image::set_sub_regions(RegionOfInterest &roi, const std::vector<ROI> &regions) {
+        if (regions.empty() || !check_crops(regions)) { throw ImageException(); }
+        const auto previous = roi.get();
+        try {
+            // relative regions keep their sizes, so the crops pass
+            set_crops(roi.set_union(regions));
+        }
+        catch (RegionOfInterestException) {
+            // written already if the camera aligned the roi past a region
+            roi.set(previous);
+            throw;
+        }
+    }
+
+    Preview &Image::get_preview() {
+        return m_preview;
+    }
+
+    const Preview &Image::get_preview() const {
+        return m_preview;
+    }
+
+    FocusMetric &Image::get_focus_metric() {
+        return m_focus_metric;
+    }
+
+    const FocusMetric &Image::get_focus_metric() const {
+        return m_focus_metric;
+    }
+
+    FramePublisher &Image::get_publisher() {
+        return m_publisher;
+    }
+
+    bool Image::get_publish_preview() const {
+        return m_publish_preview;
+    }
+
+    void Image::set_publish_preview(bool publish) {
+        m_publish_preview = publish;
+    }
+
+    void Image::release_buffer() {
+        m_p_pool->give(std::move(m_data));
+        m_data = FrameBuffer();
+        reset_conversion_statistics();
+    }
+
+    bool Image::is_buffer_locked() const {
+        return m_data.is_locked();
+    }
+
+    bool Image::is_buffer_huge() const {
+        return m_data.is_huge();
+    }
+
+    Image::ConversionStatistics Image::get_conversion_statistics() const {
+        std::lock_guard<std::mutex> lock(m_statistics_mutex);
+        return m_statistics;
+    }
+
+    void Image::reset_conversion_statistics() {
+        std::lock_guard<std::mutex> lock(m_statistics_mutex);
+        m_statistics = ConversionStatistics{0.0, 0, 0.0, 0, 0};
+    }
+
+    const Image::ConversionPlan &Image::get_conversion_plan() const {
+        if (m_p_plan == nullptr) { throw ImageException(); }
+        return *m_p_plan;
+    }
+
+    void Image::convert_frame(const ConversionPlan &plan, const unsigned char *p_raw, unsigned char *p_output) {
+        assert(p_raw != nullptr);
+        assert(p_output != nullptr);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const auto faults0 = FrameBuffer::get_page_fault_count();
+
+        // color modes except BGRA get an opaque alpha channel appended, since MM expects 4 components
+        // luminance output modes collapse color to a single component
+        // sub regions are cropped here, so only their pixels are converted
+        const auto &out = plan.output;
+        const Size size{plan.raw.width, plan.raw.height};
+        const auto plane_bytes = out.plane_bytes();
+        for (std::size_t k = 0; k < plan.regions.size(); ++k) {
+            convert_rows(plan.converter, p_raw, size, plan.regions[k], 0, out.height, p_output + k * plane_bytes);
+        }
+
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        const auto faults = FrameBuffer::get_page_fault_count() - faults0;
+        std::lock_guard<std::mutex> lock(m_statistics_mutex);
+        if (m_statistics.frames == 0) {
+            m_statistics.first_ms = ms;
+            m_statistics.first_page_faults = faults;
+        }
+        m_statistics.last_ms = ms;
+        m_statistics.last_page_faults = faults;
+        ++m_statistics.frames;
+    }
+
+    void Image::observe_frame(const FrameLayout &layout, const unsigned char *p_output) {
+        assert(p_output != nullptr);
+
+        const auto preview = m_preview.begin_frame(layout.width, layout.height, layout.components, layout.bits_per_component);
+        const auto focus = m_focus_metric.begin_frame(layout.width, layout.height, layout.components, layout.bits_per_component);
+        if (preview || focus) {
+            // both read the first channel in the same strips, each strip while it is still in cache
+            const auto strip = preview ? m_preview.get_strip_rows() : M_S_STRIP_ROWS;
+            const auto stride = static_cast<std::size_t>(layout.width) * layout.bytes_per_px();
+            for (unsigned y = 0; y < layout.height; y += strip) {
+                auto rows = (std::min)(strip, layout.height - y);
+                auto p_rows = p_output + y * stride;
+                if (preview) {
+                    m_preview.accumulate_rows(p_rows, rows);
+                }
+                if (focus) {
+                    m_focus_metric.accumulate_rows(p_rows, y, rows);
+                }
+            }
+        }
+        if (preview && m_preview.end_frame() && m_publish_preview) {
+            // the only route of the preview out of the adapter, the core has no second image of a camera
+            auto p_frame = m_preview.get_frame();
+            m_publisher.publish(p_frame->data.data(), p_frame->data.size(), p_frame->width, p_frame->height, p_frame->components, p_frame->bits_per_component, SharedFrameLayout::M_S_PREVIEW_CHANNEL);
+        }
+        if (focus) {
+            m_focus_metric.end_frame();
+        }
+        const auto plane_bytes = layout.plane_bytes();
+        for (unsigned k = 0; k < layout.channels; ++k) {
+            m_publisher.publish(p_output + k * plane_bytes, plane_bytes, layout.width, layout.height, layout.components, layout.bits_per_component, k);
+        }
+    }
+
     std::string Image::to_string() const {
         std::stringstream ss;
         ss << "Image buffer information:\n";
@@ -134,58 +370,90 @@ namespace Prokyon {
         ss << "  size (px): " << get_image_width() << ", " << get_image_height() << "\n";
         ss << "  bytes per pixel: " << get_image_bytes_per_pixel() << "\n";
         ss << "  total bytes: " << get_image_buffer_size() << "\n";
+        ss << "  channels: " << get_number_of_channels() << "\n";
         return ss.str();
     }
 
     // private
+    bool Image::acquire_on_sdk_thread() {
+        auto result = DijSDK_StartAcquisition(*m_p_camera);
+        if (result != E_OK) { return false; }
+        // the camera must not be left acquiring or holding the image, whatever fails below
+        auto abort = make_scope_guard([this]() { DijSDK_AbortAcquisition(*m_p_camera); });
+
+        ImageHandle image_handle;
+        void *p_raw_data = nullptr;
+        result = DijSDK_GetImage(*m_p_camera, &image_handle, &p_raw_data);
+        if (result != E_OK) { return false; }
+        auto release = make_scope_guard([&image_handle]() { DijSDK_ReleaseImage(image_handle); });
+
+        try {
+            copy_image_data(p_raw_data);
+        }
+        catch (ImageException) {
+            return false;
+        }
+
+        release.dismiss();
+        result = DijSDK_ReleaseImage(image_handle);
+        if (result != E_OK) { return false; }
+
+        abort.dismiss();
+        result = DijSDK_AbortAcquisition(*m_p_camera);
+        if (result != E_OK) { return false; }
+
+        return true;
+    }
+
     void Image::copy_image_data(void *p_data) {
         assert(p_data != nullptr);
 
-        auto size = extract_size();
-        auto px = compute_px_count(size);
-
-        auto component_count = extract_component_count();
-        auto component_count_hw = extract_component_count_hw();
-        assert(component_count_hw <= component_count);
-
-        auto pointer = static_cast<unsigned char *>(p_data);
-        auto bits_per_component = extract_bits_per_component();
-        auto bytes_per_c = to_bytes(bits_per_component);
-        unsigned long index = 0ul;
-        if (component_count_hw < component_count) {
-            // color modes except BGRA should hit this
-            for (long p = 0; p < px; ++p) {
-                for (unsigned c = 0; c < component_count; ++c) {
-                    for (unsigned b = 0; b < bytes_per_c; ++b) {
-                        if (c < component_count_hw) {
-                            m_data[index] = *pointer;
-                            pointer += sizeof(*pointer);
-                        }
-                        else {
-                            // MM expects 4 components, camera has only 3
-                            // so we have to fill alpha channel with fully opaque
-                            // (except BGRA mode)
-                            m_data[index] = static_cast<unsigned char>(0xffu);
-                        }
-                        ++index;
-                    }
-                }
-            }
+        // the plan of the last update, the sdk is not asked again
+        if (m_p_plan == nullptr && !update()) { throw ImageException(); }
+        const auto &plan = *m_p_plan;
+        reserve(plan.output.bytes());
+        convert_frame(plan, static_cast<const unsigned char *>(p_data), m_data.data());
+        observe_frame(plan.output, m_data.data());
+    }
+
+    void Image::reserve(std::size_t bytes) {
+        // buffers from the pool serve up to twice smaller layouts, see BufferPool
+        if (bytes <= m_data.size() && m_data.size() <= 2 * bytes) {
+            return;
+        }
+        release_buffer();
+        try {
+            m_data = m_p_pool->take(bytes);
+        }
+        catch (BufferPoolException) {
+            throw ImageException();
+        }
+    }
+
+    void Image::convert_rows(const RowConverter &converter, const unsigned char *p_source, const Size &frame_size, const ROI &region, unsigned first_row, unsigned row_count, unsigned char *p_destination) const {
+        const auto source_bytes_per_px = converter.get_source_bytes_per_px();
+        const auto source_stride = static_cast<std::size_t>(frame_size[X_ind]) * source_bytes_per_px;
+        auto p_first = p_source + (region[Y_ind] + first_row) * source_stride + region[X_ind] * source_bytes_per_px;
+        if (region[W_ind] == frame_size[X_ind]) {
+            // full width rows are contiguous
+            converter.convert(p_first, p_destination, static_cast<std::size_t>(row_count) * region[W_ind]);
         }
         else {
-            // grayscale modes and BGRA should hit this
-            for (long p = 0; p < px; ++p) {
-                for (unsigned c = 0; c < component_count; ++c) {
-                    for (unsigned b = 0; b < bytes_per_c; ++b) {
-                        m_data[index] = *pointer;
-                        pointer += sizeof(*pointer);
-                        ++index;
-                    }
-                }
+            const auto destination_stride = static_cast<std::size_t>(region[W_ind]) * converter.get_bytes_per_px();
+            for (unsigned r = 0; r < row_count; ++r) {
+                converter.convert(p_first + r * source_stride, p_destination + r * destination_stride, region[W_ind]);
             }
         }
+    }
 
-        update_impl(size, bits_per_component, select_component_name_map(component_count));
+    std::vector<ROI> Image::active_regions(const Size &frame_size) const {
+        if (m_crops.empty()) {
+            return {ROI{0, 0, frame_size[X_ind], frame_size[Y_ind]}};
+        }
+        for (const auto &r : m_crops) {
+            if (frame_size[X_ind] < r[X_ind] + r[W_ind] || frame_size[Y_ind] < r[Y_ind] + r[H_ind]) { throw ImageException(); }
+        }
+        return m_crops;
     }
 
     unsigned Image::compute_bits_per_px(unsigned bits_per_component, unsigned component_count) const {
@@ -205,116 +473,42 @@ namespace Prokyon {
         return static_cast<long>(size[0]) * size[1];
     }
 
-    unsigned Image::extract_component_count() const {
+    unsigned Image::extract_format() const {
         if (m_p_camera == nullptr) { throw ImageException(); }
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageProcessingOutputFormat, 1);
-        if (p.error) { throw ImageException(); }
-        auto entry = to_unsigned(p.value.at(0));
-
-        unsigned count = 0;
-        switch (entry) {
-            case (DijSDK_EImageFormatNotSpecified):
-                // TODO handle this case
-                assert(false);
-                break;
-            case (DijSDK_EImageFormatBayerRaw16):
-                // TODO handle this case
-                assert(false);
-                break;
-            case (DijSDK_EImageFormatGrey8):
-            case (DijSDK_EImageFormatGrey16):
-            case (DijSDK_EImageFormatGreyRaw16):
-                count = 1;
-                break;
-            case (DijSDK_EImageFormatRGB888):
-            case (DijSDK_EImageFormatRGB161616):
-            case (DijSDK_EImageFormatBGR888):
-            case (DijSDK_EImageFormatBGR888A):
-                count = 4;
-                break;
-            default:
-                assert(false);
-        }
-        assert(count == 1 || count == 4);
-        return count;
+        int format = 0;
+        if (read_numeric_parameter<int>(*m_p_camera, ParameterIdImageProcessingOutputFormat, &format, 1)) { throw ImageException(); }
+        return to_unsigned(format);
     }
 
-    unsigned Image::extract_component_count_hw() const {
-        if (m_p_camera == nullptr) { throw ImageException(); }
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageProcessingOutputFormat, 1);
-        if (p.error) { throw ImageException(); }
-        auto entry = to_unsigned(p.value.at(0));
-
-        unsigned count = 0;
-        switch (entry) {
-            case (DijSDK_EImageFormatNotSpecified):
-                assert(false);
-                break;
-            case (DijSDK_EImageFormatBayerRaw16):
-                assert(false);
-                break;
-            case (DijSDK_EImageFormatGrey8):
-            case (DijSDK_EImageFormatGrey16):
-            case (DijSDK_EImageFormatGreyRaw16):
-                count = 1;
-                break;
-            case (DijSDK_EImageFormatRGB888):
-            case (DijSDK_EImageFormatRGB161616):
-            case (DijSDK_EImageFormatBGR888):
-                count = 3;
-                break;
-            case (DijSDK_EImageFormatBGR888A):
-                count = 4;
-                break;
-            default:
-                assert(false);
+    RowConverter Image::make_converter(unsigned format) const {
+        try {
+            return RowConverter(format, m_output_mode, m_luminance_weights);
+        }
+        catch (ConversionException) {
+            throw ImageException();
         }
-        assert(count == 1 || count == 3 || count == 4);
-        return count;
     }
 
-    Image::Size Image::extract_size() const {
-        if (m_p_camera == nullptr) { throw ImageException(); }
-        unsigned COUNT = 2;
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageModeSize, COUNT);
-        if (p.error) { throw ImageException(); }
-        assert(p.value.size() == COUNT);
-        assert(0 < p.value[0]);
-        assert(0 < p.value[1]);
-        auto out = to_unsigned(p.value);
-        return Size{out[0], out[1]};
+    Image::ConversionPlan Image::make_conversion_plan() const {
+        auto size = extract_size();
+        auto format = extract_format();
+        auto converter = make_converter(format);
+        auto regions = active_regions(size);
+        FrameLayout raw{size[X_ind], size[Y_ind], converter.get_source_component_count(), converter.get_source_bits_per_component(), 1u, format};
+        FrameLayout output{regions[0][W_ind], regions[0][H_ind], converter.get_component_count(), converter.get_bits_per_component(), static_cast<unsigned>(regions.size()), 0u};
+        return {converter, regions, raw, output};
     }
 
-    unsigned Image::extract_bits_per_component() const {
-        if (m_p_camera == nullptr) { throw ImageException(); }
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageProcessingOutputFormat, 1);
-        if (p.error) { throw ImageException(); }
-        auto entry = to_unsigned(p.value.at(0));
-
-        unsigned bits = 0;
-        switch (entry) {
-            case (DijSDK_EImageFormatNotSpecified):
-                assert(false);
-                break;
-            case (DijSDK_EImageFormatBayerRaw16):
-                assert(false);
-                break;
-            case (DijSDK_EImageFormatGrey8):
-            case (DijSDK_EImageFormatRGB888):
-            case (DijSDK_EImageFormatBGR888):
-            case (DijSDK_EImageFormatBGR888A):
-                bits = 8;
-                break;
-            case (DijSDK_EImageFormatGrey16):
-            case (DijSDK_EImageFormatGreyRaw16):
-            case (DijSDK_EImageFormatRGB161616):
-                bits = 16;
-                break;
-            default:
-                assert(false);
+    Image::Size Image::extract_size() const {
+        if (m_p_roi != nullptr) {
+            return Size{m_p_roi->w(), m_p_roi->h()};
         }
-        assert(bits != 0 && bits % 8 == 0);
-        return bits;
+        if (m_p_camera == nullptr) { throw ImageException(); }
+        std::array<int, 2> size{0, 0};
+        if (read_numeric_parameter<int>(*m_p_camera, ParameterIdImageModeSize, size.data(), static_cast<unsigned>(size.size()))) { throw ImageException(); }
+        assert(0 < size[0]);
+        assert(0 < size[1]);
+        return Size{to_unsigned(size[0]), to_unsigned(size[1])};
     }
 
     const Image::NameMap *Image::select_component_name_map(unsigned component_count) const {
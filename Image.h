@@ -3,9 +3,21 @@
 #ifndef PROKYON_IMAGE_H_
 #define PROKYON_IMAGE_H_
 
+#include "BufferPool.h"
+#include "Conversion.h"
+#include "FocusMetric.h"
+#include "FrameLayout.h"
+#include "FrameMemory.h"
+#include "FramePublisher.h"
+#include "Preview.h"
+#include "RegionOfInterest.h"
+
 #include <array>
+#include <atomic>
 #include <exception>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -20,13 +32,22 @@ namespace Prokyon {
 
     class Image {
     public:
-        Image(Camera *p_camera);
+        Image(Camera *p_camera, BufferPool *p_pool);
+        ~Image();
+        Image(const Image &) = delete;
+        Image &operator=(const Image &) = delete;
 
         bool acquire(); // returns success
+        // queries format and size and builds the conversion plan, after any change of format, mode, roi or output
         bool update(); // returns success
+        // frames are the size of the roi, taken from its cache instead of the sdk if set, nullptr to query
+        void set_region_of_interest(const RegionOfInterest *p_roi);
 
         ImageBuffer get_image_buffer();
         ImageBuffer get_image_buffer() const;
+        ImageBuffer get_image_buffer(unsigned channel) const;
+        unsigned get_number_of_channels() const;
+        std::string get_channel_name(unsigned channel) const;
         unsigned get_number_of_components() const;
         std::string get_component_name(unsigned component) const;
         long get_image_buffer_size() const;
@@ -34,26 +55,86 @@ namespace Prokyon {
         unsigned get_image_height() const;
         unsigned get_image_bytes_per_pixel() const;
         unsigned get_bit_depth() const;
+        FrameLayout get_layout() const; // of the converted buffer
+        bool has_supported_format() const; // the sdk output format can be converted, not raw bayer
+
+        OutputMode get_output_mode() const;
+        void set_output_mode(OutputMode mode); // call update() afterwards
+        LuminanceWeights get_luminance_weights() const;
+        void set_luminance_weights(const LuminanceWeights &weights); // call update() afterwards
+
+        // software sub regions, each delivered as its own channel
+        // relative to the captured frame, all of equal size, empty for the whole frame
+        std::vector<ROI> get_crops() const;
+        void set_crops(const std::vector<ROI> &crops); // throws ImageException, call update() afterwards
+        static bool check_crops(const std::vector<ROI> &crops); // nothing empty, all of one size
+        // the roi to the bounding box of regions, each region a crop, both or neither, call update() afterwards
+        // throws ImageException before touching the roi, RegionOfInterestException after putting the previous roi back
+        void set_sub_regions(RegionOfInterest &roi, const std::vector<ROI> &regions);
+
+        Preview &get_preview();
+        const Preview &get_preview() const;
+        FocusMetric &get_focus_metric();
+        const FocusMetric &get_focus_metric() const;
+        FramePublisher &get_publisher(); // every converted channel is published while open
+        // preview frames go to the publisher as well, on channel SharedFrameLayout::M_S_PREVIEW_CHANNEL
+        bool get_publish_preview() const;
+        void set_publish_preview(bool publish);
+
+        // the buffer is sized for the active layout by update() and acquire()
+        void release_buffer(); // back to the pool, e.g. after its options changed
+        bool is_buffer_locked() const;
+        bool is_buffer_huge() const;
+
+        // cost of convert_frame, the first frame after an allocation or reset shows the page faults of fresh buffers
+        struct ConversionStatistics {
+            double first_ms;
+            std::uint64_t first_page_faults;
+            double last_ms;
+            std::uint64_t last_page_faults;
+            std::uint64_t frames;
+        };
+        ConversionStatistics get_conversion_statistics() const;
+        void reset_conversion_statistics();
+
+        // conversion of raw SDK frames outside of acquire(), e.g. by the ConvertStage of a Pipeline
+        // a plan is valid until format, output mode, image mode or roi change
+        // the plan of the last update() serves every frame, so frames take no parameter queries
+        struct ConversionPlan {
+            RowConverter converter;
+            std::vector<ROI> regions;
+            FrameLayout raw;
+            FrameLayout output;
+        };
+        const ConversionPlan &get_conversion_plan() const; // throws ImageException if the last update() failed
+        // frames may be converted in parallel, each by one thread
+        void convert_frame(const ConversionPlan &plan, const unsigned char *p_raw, unsigned char *p_output);
+        // one converted frame at a time, in frame order, feeds preview, focus metric and publisher
+        void observe_frame(const FrameLayout &layout, const unsigned char *p_output);
 
         std::string to_string() const;
 
     private:
-        using ImageData = std::vector<unsigned char>;
+        using ImageData = FrameBuffer;
         using Size = std::array<unsigned, 2u>;
         using NameMap = std::map<unsigned, std::string>;
 
     private:
+        bool acquire_on_sdk_thread(); // returns success
         void copy_image_data(void *p_data); // modifies m_data
+        void reserve(std::size_t bytes); // throws ImageException, modifies m_data
+        void convert_rows(const RowConverter &converter, const unsigned char *p_source, const Size &frame_size, const ROI &region, unsigned first_row, unsigned row_count, unsigned char *p_destination) const;
+        std::vector<ROI> active_regions(const Size &frame_size) const; // throws ImageException
 
         unsigned compute_bits_per_px(unsigned bits_per_component, unsigned component_count) const;
         long compute_byte_count(unsigned bytes_per_px, const Size &size) const;
         long compute_px_count(const Size &size) const;
         unsigned to_bytes(unsigned bits) const;
 
-        unsigned extract_component_count() const; // throws ProkyonException, ParameterIdImageProcessingOutputFormat
-        unsigned extract_component_count_hw() const; // throws ProkyonException, ParameterIdImageProcessingOutputFormat
-        Size extract_size() const; // throws ProkyonException, ParameterIdImageModeSize
-        unsigned extract_bits_per_component() const; // throws ProkyonException, ParameterIdImageModeBits
+        unsigned extract_format() const; // throws ProkyonException, ParameterIdImageProcessingOutputFormat
+        Size extract_size() const; // throws ProkyonException, ParameterIdImageModeSize unless the roi is set
+        RowConverter make_converter(unsigned format) const; // throws ImageException
+        ConversionPlan make_conversion_plan() const; // throws ImageException
 
         const NameMap *select_component_name_map(unsigned component_count) const;
 
@@ -61,17 +142,29 @@ namespace Prokyon {
 
     private:
         Camera *m_p_camera;
+        BufferPool *m_p_pool;
+        const RegionOfInterest *m_p_roi;
         ImageData m_data;
         Size m_image_size;
         unsigned m_bits_per_component;
         const NameMap *m_p_component_names;
+        OutputMode m_output_mode;
+        LuminanceWeights m_luminance_weights;
+        std::vector<ROI> m_crops;
+        std::unique_ptr<ConversionPlan> m_p_plan; // nullptr until update(), and after changes that invalidate it
+        Preview m_preview;
+        FocusMetric m_focus_metric;
+        FramePublisher m_publisher;
+        std::atomic<bool> m_publish_preview;
+        mutable std::mutex m_statistics_mutex;
+        ConversionStatistics m_statistics;
 
         static const Size M_S_IMAGE_SIZE_DEFAULT;
         static const unsigned M_S_BITS_PER_COMPONENT_DEFAULT = 8u;
+        static const unsigned M_S_STRIP_ROWS = 32u; // strip height of observe_frame when only the focus metric reads strips
 
         static const NameMap M_S_RGBA_COMPONENT_NAMES;
         static const NameMap M_S_GRAY_COMPONENT_NAMES;
-        static const long M_S_BUFFER_SIZE = 3000l * 4000l * 4l; // 3000 px * 4000 px * 4 bytes is max buffer size needed for hardware
         static const unsigned X_ind = 0u;
         static const unsigned Y_ind = 1u;
     };
@@ -0,0 +1,208 @@
+#include "ModeCatalogue.h"
+#include "UserDirectory.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+
+namespace Prokyon {
+    ModeCatalogue::ModeCatalogue(const std::string &guid, const std::string &sdk_version) :
+        m_guid{guid},
+        m_sdk_version{sdk_version},
+        m_modes{},
+        m_specs{},
+        m_loaded{false},
+        m_changed{false},
+        m_mutex{}
+    {}
+
+    bool ModeCatalogue::load() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        clear_unlocked();
+        std::ifstream in(get_path());
+        if (!in) { return false; }
+
+        // line based, names may hold spaces, so they come last
+        std::string line;
+        if (!std::getline(in, line) || line != M_S_MAGIC) { return false; }
+        if (!std::getline(in, line) || line != "guid " + m_guid) { return false; }
+        if (!std::getline(in, line) || line != "sdk " + m_sdk_version) { return false; }
+        while (std::getline(in, line)) {
+            std::stringstream ss(line);
+            std::string kind;
+            ss >> kind;
+            if (kind == "mode") {
+                Mode mode;
+                std::string name;
+                ss >> mode.index >> mode.size[0] >> mode.size[1] >> mode.subsampling[0] >> mode.subsampling[1];
+                ss >> mode.averaging[0] >> mode.averaging[1] >> mode.summing[0] >> mode.summing[1] >> mode.bits[0] >> mode.bits[1];
+                ss >> mode.pixel_size_um[0] >> mode.pixel_size_um[1] >> mode.preferred_acquisition_mode;
+                if (!ss || mode.index < 0 || !std::getline(ss >> std::ws, name) || name.empty()) {
+                    clear_unlocked();
+                    return false;
+                }
+                m_modes[name] = mode;
+            }
+            else if (kind == "spec") {
+                std::string id_name;
+                int exists = -1;
+                std::string description;
+                if (!(ss >> id_name >> exists) || (exists != 0 && exists != 1)) {
+                    clear_unlocked();
+                    return false;
+                }
+                std::getline(ss >> std::ws, description);
+                m_specs[id_name] = Spec{exists == 1, description};
+            }
+            else if (!kind.empty()) {
+                clear_unlocked();
+                return false;
+            }
+        }
+        m_loaded = !m_modes.empty();
+        if (!m_loaded) {
+            clear_unlocked();
+        }
+        return m_loaded;
+    }
+
+    bool ModeCatalogue::save() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_changed) { return true; }
+        if (!UserDirectory::make(UserDirectory::get_path())) { return false; }
+
+        // written aside and renamed, so a concurrent load never sees half a file
+        const auto path = get_path();
+        const auto temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            if (!out) { return false; }
+            out << M_S_MAGIC << "\n";
+            out << "guid " << m_guid << "\n";
+            out << "sdk " << m_sdk_version << "\n";
+            // full precision, the pixel size is reported as read
+            out.precision(17);
+            for (const auto &e : m_modes) {
+                const auto &m = e.second;
+                out << "mode " << m.index << " " << m.size[0] << " " << m.size[1] << " " << m.subsampling[0] << " " << m.subsampling[1];
+                out << " " << m.averaging[0] << " " << m.averaging[1] << " " << m.summing[0] << " " << m.summing[1] << " " << m.bits[0] << " " << m.bits[1];
+                out << " " << m.pixel_size_um[0] << " " << m.pixel_size_um[1] << " " << m.preferred_acquisition_mode << " " << e.first << "\n";
+            }
+            for (const auto &e : m_specs) {
+                out << "spec " << e.first << " " << (e.second.exists ? 1 : 0) << " " << e.second.description << "\n";
+            }
+            if (!out) { return false; }
+        }
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        m_changed = false;
+        return true;
+    }
+
+    void ModeCatalogue::clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        clear_unlocked();
+    }
+
+    void ModeCatalogue::clear_unlocked() {
+        m_modes.clear();
+        m_specs.clear();
+        m_loaded = false;
+        m_changed = false;
+    }
+
+    bool ModeCatalogue::matches(int mode_count, int virtual_index, const std::string &virtual_name) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (mode_count < 0 || m_modes.size() != static_cast<std::size_t>(mode_count)) { return false; }
+        auto it = m_modes.find(virtual_name);
+        return it != m_modes.cend() && it->second.index == virtual_index;
+    }
+
+    std::map<std::string, ModeCatalogue::Mode> ModeCatalogue::get_modes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_modes;
+    }
+
+    void ModeCatalogue::set_modes(const std::map<std::string, Mode> &modes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_modes = modes;
+        m_changed = true;
+    }
+
+    std::map<std::string, int> ModeCatalogue::get_mode_indices() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<std::string, int> out;
+        for (const auto &e : m_modes) {
+            out.emplace(e.first, e.second.index);
+        }
+        return out;
+    }
+
+    bool ModeCatalogue::find_mode(int index, std::string &name, Mode &mode) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto &e : m_modes) {
+            if (e.second.index == index) {
+                name = e.first;
+                mode = e.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ModeCatalogue::select_mode(int binning, std::string &name) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // a binning should not crop, so the widest sensor area comes first,
+        // then readout time, which goes with the px read, then fewer bits to the host
+        auto rank = [](const Mode &m) {
+            const auto step_x = static_cast<long long>((std::max)(m.subsampling[0], m.get_binning()));
+            const auto step_y = static_cast<long long>((std::max)(m.subsampling[1], (std::max)(m.averaging[1], m.summing[1])));
+            const auto px = static_cast<long long>(m.size[0]) * m.size[1];
+            return std::make_tuple(-px * step_x * step_y, px, m.bits[1]);
+        };
+        const Mode *p_best = nullptr;
+        for (const auto &e : m_modes) {
+            const auto &m = e.second;
+            if (m.get_binning() != binning || (p_best != nullptr && !(rank(m) < rank(*p_best)))) { continue; }
+            p_best = &m;
+            name = e.first;
+        }
+        return p_best != nullptr;
+    }
+
+    bool ModeCatalogue::find_spec(const std::string &id_name, Spec &spec) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_specs.find(id_name);
+        if (it == m_specs.cend()) { return false; }
+        spec = it->second;
+        return true;
+    }
+
+    void ModeCatalogue::set_spec(const std::string &id_name, const Spec &spec) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_specs[id_name] = spec;
+        m_changed = true;
+    }
+
+    bool ModeCatalogue::is_loaded() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_loaded;
+    }
+
+    std::string ModeCatalogue::get_path() const {
+        const auto directory = UserDirectory::get_path();
+        if (directory.empty()) { return ""; }
+        return directory + "/modes-" + UserDirectory::sanitize(m_guid) + ".txt";
+    }
+
+    int ModeCatalogue::Mode::get_binning() const {
+        return (std::max)(averaging[0], summing[0]);
+    }
+
+    const std::string ModeCatalogue::M_S_MAGIC{"prokyon mode catalogue 2"};
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef PROKYON_MODE_CATALOGUE_H_
+#define PROKYON_MODE_CATALOGUE_H_
+
+#include <array>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace Prokyon {
+    // Image modes and parameter specifications found at Initialize, kept on disk per camera and SDK version.
+    // Listing the image modes writes the virtual mode index once per mode and reads its descriptor back,
+    // a valid catalogue replaces that walk and the specification queries on later starts.
+    // Thread safe, the deferred initialization adds specifications while the core selects modes.
+    class ModeCatalogue {
+    public:
+        struct Spec {
+            bool exists;
+            std::string description; // short specification, as logged
+        };
+
+        // fixed per mode, ParameterIdImageMode*, x by y where there are two
+        struct Mode {
+            int index;
+            std::array<int, 2> size; // px
+            std::array<int, 2> subsampling;
+            std::array<int, 2> averaging;
+            std::array<int, 2> summing;
+            std::array<int, 2> bits; // read from the sensor, sent to the host
+            std::array<double, 2> pixel_size_um; // of an image px on the sensor
+            int preferred_acquisition_mode;
+
+            int get_binning() const; // sensor px per image px along x, averaged or summed
+        };
+
+        ModeCatalogue(const std::string &guid, const std::string &sdk_version);
+
+        bool load(); // returns success, fails for a missing or damaged file or one of another camera or SDK
+        bool save(); // returns success, only writes if something changed since load
+        void clear();
+
+        // cheap check against the camera, the mode count and the name of the current virtual mode
+        bool matches(int mode_count, int virtual_index, const std::string &virtual_name) const;
+
+        std::map<std::string, Mode> get_modes() const; // by name, a copy
+        void set_modes(const std::map<std::string, Mode> &modes);
+        std::map<std::string, int> get_mode_indices() const; // name to index
+        bool find_mode(int index, std::string &name, Mode &mode) const; // returns if known
+        // the mode with the fewest px to read out among those of the given binning, returns if there is one
+        bool select_mode(int binning, std::string &name) const;
+        bool find_spec(const std::string &id_name, Spec &spec) const; // returns if known
+        void set_spec(const std::string &id_name, const Spec &spec);
+
+        bool is_loaded() const; // by the last load, and not cleared since
+        std::string get_path() const;
+
+    private:
+        std::string m_guid;
+        std::string m_sdk_version;
+        std::map<std::string, Mode> m_modes;
+        std::map<std::string, Spec> m_specs;
+        bool m_loaded;
+        bool m_changed;
+        mutable std::mutex m_mutex; // guards all of the above
+
+        void clear_unlocked();
+
+        static const std::string M_S_MAGIC;
+    };
+}
+
+#endif
\ No newline at end of file
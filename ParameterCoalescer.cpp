@@ -0,0 +1,122 @@
+#include "ParameterCoalescer.h"
+
+#include "Camera.h"
+#include "Parameters.h"
+#include "SdkThread.h"
+
+#include "dijsdkerror.h"
+
+#include <cassert>
+#include <utility>
+
+namespace Prokyon {
+    ParameterCoalescer::ParameterCoalescer(Camera *p_camera, OnApplied on_applied) :
+        m_p_camera{p_camera},
+        m_on_applied{on_applied},
+        m_mutex{},
+        m_cv{},
+        m_pending{},
+        m_in_flight{},
+        m_max_rate_hz{0.0},
+        m_last_write{},
+        m_flush_waiters{0},
+        m_stopping{false},
+        m_staged{0},
+        m_written{0},
+        m_thread{}
+    {
+        m_thread = std::thread(&ParameterCoalescer::run, this);
+    }
+
+    ParameterCoalescer::~ParameterCoalescer() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    void ParameterCoalescer::stage(DijSDK_EParamId id, const Values &values) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending[id] = values;
+            ++m_staged;
+        }
+        m_cv.notify_all();
+    }
+
+    void ParameterCoalescer::flush() {
+        assert(std::this_thread::get_id() != m_thread.get_id());
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_flush_waiters;
+        m_cv.notify_all();
+        m_cv.wait(lock, [this]() { return m_pending.empty() && m_in_flight.empty(); });
+        --m_flush_waiters;
+    }
+
+    bool ParameterCoalescer::is_pending(DijSDK_EParamId id) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending.count(id) != 0 || m_in_flight.count(id) != 0;
+    }
+
+    void ParameterCoalescer::set_max_rate_hz(double hz) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_max_rate_hz = (hz < 0.0) ? 0.0 : hz;
+        }
+        m_cv.notify_all();
+    }
+
+    double ParameterCoalescer::get_max_rate_hz() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_max_rate_hz;
+    }
+
+    std::uint64_t ParameterCoalescer::get_staged_count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_staged;
+    }
+
+    std::uint64_t ParameterCoalescer::get_written_count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    // private
+    void ParameterCoalescer::run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv.wait(lock, [this]() { return !m_pending.empty() || m_stopping; });
+            if (m_pending.empty()) { return; }
+
+            // values staged meanwhile replace the pending ones
+            auto hurry = [this]() { return m_stopping || 0 < m_flush_waiters; };
+            while (0.0 < m_max_rate_hz && !hurry()) {
+                const auto next = m_last_write + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_max_rate_hz));
+                if (m_cv.wait_until(lock, next, hurry) || next <= std::chrono::steady_clock::now()) { break; }
+            }
+
+            m_in_flight.swap(m_pending);
+            lock.unlock();
+
+            // one sdk command for all of them, the capture thread's frames go first
+            std::vector<std::pair<DijSDK_EParamId, bool>> results;
+            SdkThread::call([&]() {
+                for (const auto &e : m_in_flight) {
+                    auto success = write_numeric_parameter<double>(*m_p_camera, e.first, e.second.data(), static_cast<unsigned>(e.second.size())) == E_OK;
+                    results.emplace_back(e.first, success);
+                }
+            });
+            for (const auto &r : results) {
+                m_on_applied(r.first, r.second);
+            }
+
+            lock.lock();
+            m_written += m_in_flight.size();
+            m_in_flight.clear();
+            m_last_write = std::chrono::steady_clock::now();
+            m_cv.notify_all();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef PROKYON_PARAMETER_COALESCER_H_
+#define PROKYON_PARAMETER_COALESCER_H_
+
+#include "parameterif.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Prokyon {
+    class Camera;
+
+    // Writes of double parameters set faster than they are worth applying, e.g. from a slider.
+    // A staged value replaces one still pending for the same parameter, so only the latest is written.
+    // The pending values are written together by one command on the SdkThread, which runs it between two frames,
+    // no sooner than the maximum rate allows. The caller never waits for the camera.
+    class ParameterCoalescer {
+    public:
+        using Values = std::vector<double>;
+        using OnApplied = std::function<void(DijSDK_EParamId id, bool success)>; // on the coalescer thread
+
+        ParameterCoalescer(Camera *p_camera, OnApplied on_applied);
+        ~ParameterCoalescer(); // writes what is pending
+        ParameterCoalescer(const ParameterCoalescer &) = delete;
+        ParameterCoalescer &operator=(const ParameterCoalescer &) = delete;
+
+        void stage(DijSDK_EParamId id, const Values &values); // clipped by the caller
+        void flush(); // waits until everything staged so far is written, ignores the maximum rate
+        bool is_pending(DijSDK_EParamId id) const; // staged and not yet written
+
+        void set_max_rate_hz(double hz); // writes per second, 0 for one per frame boundary of the SdkThread
+        double get_max_rate_hz() const;
+
+        std::uint64_t get_staged_count() const; // changes with every stage
+        std::uint64_t get_written_count() const; // the others were replaced before their turn
+
+    private:
+        void run();
+
+    private:
+        Camera *m_p_camera;
+        OnApplied m_on_applied;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::map<DijSDK_EParamId, Values> m_pending;
+        std::map<DijSDK_EParamId, Values> m_in_flight; // taken by the coalescer thread, being written
+        double m_max_rate_hz;
+        std::chrono::steady_clock::time_point m_last_write;
+        unsigned m_flush_waiters;
+        bool m_stopping;
+        std::uint64_t m_staged;
+        std::uint64_t m_written;
+        std::thread m_thread;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,5 @@
+#include "ParameterRegistry.h"
+
+namespace Prokyon {
+    constexpr ParameterRegistry::Entry ParameterRegistry::M_S_ENTRIES[];
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#ifndef PROKYON_PARAMETER_REGISTRY_H_
+#define PROKYON_PARAMETER_REGISTRY_H_
+
+#include "Parameters.h"
+#include "parameterif.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    // Every parameter of parameterif.csv as documented, in csv order, fixed at compile time.
+    // The table is generated, see utils/generate_parameter_registry.py, the camera may still lack a parameter
+    // or differ in its specification, which PropertyBase queries at runtime.
+    class ParameterRegistry {
+    public:
+        struct Entry {
+            DijSDK_EParamId id;
+            const char *id_name;
+            const char *display_name; // "Group-Name", as properties are named
+            PropertyBase::Type type;
+            unsigned dimension;
+            bool readable;
+            bool writeable;
+        };
+
+        static constexpr std::size_t size() { return sizeof(M_S_ENTRIES) / sizeof(M_S_ENTRIES[0]); }
+        static constexpr const Entry &at(std::size_t index) { return M_S_ENTRIES[index]; }
+        static constexpr std::size_t find(DijSDK_EParamId id) { // returns size() if not documented
+            for (std::size_t i = 0; i < size(); ++i) {
+                if (M_S_ENTRIES[i].id == id) { return i; }
+            }
+            return size();
+        }
+
+    private:
+        static constexpr Entry M_S_ENTRIES[] = {
+#include "ParameterRegistry.inc"
+        };
+    };
+
+    template<PropertyBase::Type T>
+    struct ParameterValue;
+    template<>
+    struct ParameterValue<PropertyBase::Type::Bool> { using type = int; }; // the sdk passes bools as int
+    template<>
+    struct ParameterValue<PropertyBase::Type::Int> { using type = int; };
+    template<>
+    struct ParameterValue<PropertyBase::Type::Double> { using type = double; };
+    template<>
+    struct ParameterValue<PropertyBase::Type::String> { using type = std::string; };
+
+    // What the registry documents of one parameter, e.g. ParameterTraits<ParameterIdImageCaptureGain>::value_type is double.
+    template<DijSDK_EParamId Id>
+    struct ParameterTraits {
+        static constexpr std::size_t index = ParameterRegistry::find(Id);
+        static_assert(index < ParameterRegistry::size(), "parameter not in parameterif.csv");
+        static constexpr PropertyBase::Type type = ParameterRegistry::at(index).type;
+        static constexpr unsigned dimension = ParameterRegistry::at(index).dimension;
+        static constexpr bool readable = ParameterRegistry::at(index).readable;
+        static constexpr bool writeable = ParameterRegistry::at(index).writeable;
+        using value_type = typename ParameterValue<type>::type;
+    };
+
+    // all values of one parameter, sized by the registry
+    template<DijSDK_EParamId Id>
+    using ParameterArray = std::array<typename ParameterTraits<Id>::value_type, ParameterTraits<Id>::dimension>;
+
+    // typed by the registry, not for strings
+    // no allocation
+    template<DijSDK_EParamId Id>
+    error_t read_parameter(DijSDK_Handle handle, ParameterArray<Id> &value, DijSDK_EParamQuery query = DijSDK_EParamQueryCurrent);
+    template<DijSDK_EParamId Id>
+    error_t write_parameter(DijSDK_Handle handle, const ParameterArray<Id> &value);
+    // allocating wrappers
+    template<DijSDK_EParamId Id>
+    NumericParameter<typename ParameterTraits<Id>::value_type> get_parameter(DijSDK_Handle handle, DijSDK_EParamQuery query = DijSDK_EParamQueryCurrent);
+    template<DijSDK_EParamId Id>
+    error_t set_parameter(DijSDK_Handle handle, const std::vector<typename ParameterTraits<Id>::value_type> &value);
+
+    template<DijSDK_EParamId Id>
+    error_t read_parameter(DijSDK_Handle handle, ParameterArray<Id> &value, DijSDK_EParamQuery query) {
+        static_assert(ParameterTraits<Id>::readable, "parameter not readable");
+        static_assert(ParameterTraits<Id>::type != PropertyBase::Type::String, "see read_string_parameter");
+        return read_numeric_parameter<typename ParameterTraits<Id>::value_type>(handle, Id, value.data(), ParameterTraits<Id>::dimension, query);
+    }
+
+    template<DijSDK_EParamId Id>
+    error_t write_parameter(DijSDK_Handle handle, const ParameterArray<Id> &value) {
+        static_assert(ParameterTraits<Id>::writeable, "parameter not writeable");
+        static_assert(ParameterTraits<Id>::type != PropertyBase::Type::String, "not for strings");
+        return write_numeric_parameter<typename ParameterTraits<Id>::value_type>(handle, Id, value.data(), ParameterTraits<Id>::dimension);
+    }
+
+    template<DijSDK_EParamId Id>
+    NumericParameter<typename ParameterTraits<Id>::value_type> get_parameter(DijSDK_Handle handle, DijSDK_EParamQuery query) {
+        ParameterArray<Id> value;
+        auto error = read_parameter<Id>(handle, value, query);
+        return {std::vector<typename ParameterTraits<Id>::value_type>(value.cbegin(), value.cend()), error};
+    }
+
+    template<DijSDK_EParamId Id>
+    error_t set_parameter(DijSDK_Handle handle, const std::vector<typename ParameterTraits<Id>::value_type> &value) {
+        assert(value.size() == ParameterTraits<Id>::dimension);
+        ParameterArray<Id> array;
+        std::copy_n(value.cbegin(), array.size(), array.begin());
+        return write_parameter<Id>(handle, array);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "ParameterShadow.h"
+
+namespace Prokyon {
+    ParameterShadow::ParameterShadow() :
+        m_mutex{},
+        m_values{},
+        m_strings{}
+    {}
+
+    bool ParameterShadow::find(DijSDK_EParamId id, Values &values) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_values.find(id);
+        if (it == m_values.cend()) { return false; }
+        values = it->second;
+        return true;
+    }
+
+    bool ParameterShadow::find(DijSDK_EParamId id, std::string &value) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_strings.find(id);
+        if (it == m_strings.cend()) { return false; }
+        value = it->second;
+        return true;
+    }
+
+    bool ParameterShadow::store(DijSDK_EParamId id, const Values &values) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_values.find(id);
+        if (it != m_values.end() && it->second == values) { return false; }
+        m_values[id] = values;
+        return true;
+    }
+
+    bool ParameterShadow::store(DijSDK_EParamId id, const std::string &value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_strings.find(id);
+        if (it != m_strings.end() && it->second == value) { return false; }
+        m_strings[id] = value;
+        return true;
+    }
+
+    void ParameterShadow::forget(DijSDK_EParamId id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_values.erase(id);
+        m_strings.erase(id);
+    }
+
+    void ParameterShadow::clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_values.clear();
+        m_strings.clear();
+    }
+}
\ No newline at end of file
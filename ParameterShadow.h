@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef PROKYON_PARAMETER_SHADOW_H_
+#define PROKYON_PARAMETER_SHADOW_H_
+
+#include "parameterif.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    // Last known value of each parameter, written where the adapter sets or polls it and read instead of the SDK.
+    // Shared by the threads of the core and the poller.
+    class ParameterShadow {
+    public:
+        using Values = std::vector<double>; // int parameters are exact
+
+        ParameterShadow();
+
+        bool find(DijSDK_EParamId id, Values &values) const; // returns if known
+        bool find(DijSDK_EParamId id, std::string &value) const; // returns if known
+        bool store(DijSDK_EParamId id, const Values &values); // returns if the value changed, or was unknown
+        bool store(DijSDK_EParamId id, const std::string &value); // returns if the value changed, or was unknown
+        void forget(DijSDK_EParamId id);
+        void clear(); // after changes that may move any value, e.g. clipping to the ranges of a new image mode
+
+    private:
+        mutable std::mutex m_mutex;
+        std::map<DijSDK_EParamId, Values> m_values;
+        std::map<DijSDK_EParamId, std::string> m_strings;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Parameters.h"
+#include "SdkThread.h"
 
 #include "dijsdk.h"
 #include "parameterif.h"
@@ -8,38 +9,38 @@
 namespace Prokyon {
     PropertyBase::PropertyBase(DijSDK_Handle handle, DijSDK_EParamId id) :
         m_handle{handle},
-        m_id{id}
-    {}
+        m_id{id},
+        m_exists{false},
+        m_type{Type::Unspecified},
+        m_dimension{0},
+        m_writeable{false},
+        m_discrete{false}
+    {
+        // both sdk calls as one command
+        SdkThread::call([this]() { query_specification(); });
+    }
 
     bool PropertyBase::exists() const {
-        return DijSDK_HasParameter(m_handle, m_id) == E_OK;
+        return m_exists;
+    }
+
+    DijSDK_EParamId PropertyBase::get_id() const {
+        return m_id;
     }
 
     unsigned PropertyBase::dimension() const {
         assert(exists());
-
-        unsigned dimension = 0;
-        auto result = DijSDK_GetParameterSpec(m_handle, m_id, nullptr, nullptr, &dimension);
-        if (result) { assert(false); }
-        return dimension;
+        return m_dimension;
     }
 
     bool PropertyBase::writeable() const {
         assert(exists());
-
-        auto access = static_cast<DijSDK_EParamAccess>(0);
-        auto result = DijSDK_GetParameterSpec(m_handle, m_id, nullptr, &access);
-        if (result) { assert(false); }
-        return (access == DijSDK_EParamAccessReadWrite) || (access == DijSDK_EParamAccessWriteOnly);
+        return m_writeable;
     }
 
     bool PropertyBase::is_discrete() const {
         assert(exists());
-
-        DijSDK_EParamValueType value_type = static_cast<DijSDK_EParamValueType>(0);
-        auto result = DijSDK_GetParameterSpec(m_handle, m_id, nullptr, nullptr, nullptr, &value_type);
-        if (result) { assert(false); }
-        return value_type == DijSDK_EParamValueTypeDiscreteSet;
+        return m_discrete;
     }
 
     std::string PropertyBase::short_specification_to_string() const {
@@ -66,36 +67,7 @@ namespace Prokyon {
 
     PropertyBase::Type PropertyBase::type() const {
         assert(exists());
-
-        auto mm_type = static_cast<DijSDK_EParamType>(0);
-        auto result = DijSDK_GetParameterSpec(m_handle, m_id, &mm_type);
-        if (result) { assert(false); }
-        auto out = Type::Unspecified;
-        switch (mm_type) {
-            case DijSDK_EParamTypeNotSpecified:
-                out = Type::Unspecified;
-                break;
-            case DijSDK_EParamTypeBool:
-                out = Type::Bool;
-                break;
-            case DijSDK_EParamTypeInteger:
-                if (is_discrete()) {
-                    out = Type::Set;
-                }
-                else {
-                    out = Type::Int;
-                }
-                break;
-            case DijSDK_EParamTypeDouble:
-                out = Type::Double;
-                break;
-            case DijSDK_EParamTypeString:
-                out = Type::String;
-                break;
-            default:
-                assert(false);
-        }
-        return out;
+        return m_type;
     }
 
     char PropertyBase::delimiter() {
@@ -108,6 +80,14 @@ namespace Prokyon {
         return ss.str();
     }
 
+    void PropertyBase::parse_value(const std::string &s, int &value) {
+        value = std::stoi(s);
+    }
+
+    void PropertyBase::parse_value(const std::string &s, double &value) {
+        value = std::stod(s);
+    }
+
     DijSDK_Handle &PropertyBase::handle() {
         return m_handle;
     }
@@ -124,6 +104,44 @@ namespace Prokyon {
         return m_id;
     }
 
+    void PropertyBase::query_specification() {
+        m_exists = DijSDK_HasParameter(m_handle, m_id) == E_OK;
+        if (!m_exists) { return; }
+
+        // all fields in one call
+        auto sdk_type = static_cast<DijSDK_EParamType>(0);
+        auto access = static_cast<DijSDK_EParamAccess>(0);
+        auto value_type = static_cast<DijSDK_EParamValueType>(0);
+        auto result = DijSDK_GetParameterSpec(m_handle, m_id, &sdk_type, &access, &m_dimension, &value_type);
+        if (result) { assert(false); }
+        m_writeable = (access == DijSDK_EParamAccessReadWrite) || (access == DijSDK_EParamAccessWriteOnly);
+        m_discrete = value_type == DijSDK_EParamValueTypeDiscreteSet;
+        switch (sdk_type) {
+            case DijSDK_EParamTypeNotSpecified:
+                m_type = Type::Unspecified;
+                break;
+            case DijSDK_EParamTypeBool:
+                m_type = Type::Bool;
+                break;
+            case DijSDK_EParamTypeInteger:
+                if (m_discrete) {
+                    m_type = Type::Set;
+                }
+                else {
+                    m_type = Type::Int;
+                }
+                break;
+            case DijSDK_EParamTypeDouble:
+                m_type = Type::Double;
+                break;
+            case DijSDK_EParamTypeString:
+                m_type = Type::String;
+                break;
+            default:
+                assert(false);
+        }
+    }
+
     std::string PropertyBase::dimension_to_string() const {
         std::string out;
         auto d = dimension();
@@ -178,7 +196,7 @@ namespace Prokyon {
 
     StringProperty::StringProperty(DijSDK_Handle handle, DijSDK_EParamId id) :
         PropertyBase(handle, id) {
-        assert(type() == Type::String);
+        assert(!exists() || type() == Type::String);
     }
 
     std::string StringProperty::get() const {
@@ -190,6 +208,14 @@ namespace Prokyon {
         return p.value;
     }
 
+    void StringProperty::set(const std::string &value) {
+        assert(exists());
+        assert(type() == Type::String);
+
+        auto result = SdkThread::call([&]() { return DijSDK_SetStringParameter(handle(), id(), value.c_str()); });
+        if (result) { throw PropertyException(); }
+    }
+
     std::string StringProperty::range_to_string() const {
         assert(exists());
         assert(type() == Type::String);
@@ -197,9 +223,14 @@ namespace Prokyon {
     }
 
     NumericProperty::NumericProperty(DijSDK_Handle handle, DijSDK_EParamId id) :
-        PropertyBase(handle, id) {
+        PropertyBase(handle, id),
+        m_range_cached{false},
+        m_range{0.0, 0.0}
+    {
+        // parameters of the registry the camera lacks are constructed too, then dropped
         assert(
-            type() == Type::Double
+            !exists()
+            || type() == Type::Double
             || type() == Type::Int
             || type() == Type::Set
             || type() == Type::Bool
@@ -302,6 +333,27 @@ namespace Prokyon {
         set<double>(value);
     }
 
+    void NumericProperty::invalidate_range() {
+        m_range_cached = false;
+    }
+
+    std::array<double, 2> NumericProperty::query_range() const {
+        std::array<double, 2> out{0.0, 0.0};
+        if (type() == Type::Double) {
+            auto min = read_numeric_values<double>(handle(), id(), dimension(), DijSDK_EParamQueryMin);
+            auto max = read_numeric_values<double>(handle(), id(), dimension(), DijSDK_EParamQueryMax);
+            if (min.error || max.error) { assert(false); }
+            out = {min.value[0], max.value[0]};
+        }
+        else {
+            auto min = read_numeric_values<int>(handle(), id(), dimension(), DijSDK_EParamQueryMin);
+            auto max = read_numeric_values<int>(handle(), id(), dimension(), DijSDK_EParamQueryMax);
+            if (min.error || max.error) { assert(false); }
+            out = {static_cast<double>(min.value[0]), static_cast<double>(max.value[0])};
+        }
+        return out;
+    }
+
     std::string NumericProperty::range_to_string() const {
         std::string out;
         switch (type()) {
@@ -325,6 +377,9 @@ namespace Prokyon {
         m_pseudo_mapped{pseudo_mapped}
     {
         for (const auto &e : m_forward) {
+            if (!exists()) {
+                break;
+            }
             if (m_pseudo_mapped) {
                 assert(NumericProperty::allowed_int(e.second));
             }
@@ -346,7 +401,8 @@ namespace Prokyon {
         m_range = range;
 
         assert(
-            type() == Type::Set
+            !exists()
+            || type() == Type::Set
             || (type() == Type::Int && m_pseudo_mapped)
             || (type() == Type::Bool && m_pseudo_mapped)
         );
@@ -356,14 +412,17 @@ namespace Prokyon {
         assert(exists());
         assert(type() == Type::Set);
 
-        unsigned value_count = 0;
-        auto result = DijSDK_GetParameterSpec(handle(), id(), nullptr, nullptr, nullptr, nullptr, nullptr, &value_count);
-        if (result) { assert(false); }
-        assert(0 < value_count);
-
-        std::vector<int> range(value_count, 0);
-        result = DijSDK_GetParameterSpec(handle(), id(), nullptr, nullptr, nullptr, nullptr, range.data(), &value_count);
-        if (result) { assert(false); }
+        std::vector<int> range;
+        SdkThread::call([&]() {
+            unsigned value_count = 0;
+            auto result = DijSDK_GetParameterSpec(handle(), id(), nullptr, nullptr, nullptr, nullptr, nullptr, &value_count);
+            if (result) { assert(false); }
+            assert(0 < value_count);
+
+            range.assign(value_count, 0);
+            result = DijSDK_GetParameterSpec(handle(), id(), nullptr, nullptr, nullptr, nullptr, range.data(), &value_count);
+            if (result) { assert(false); }
+        });
         assert(0 < range.size());
 
         return range;
@@ -385,16 +444,24 @@ namespace Prokyon {
     }
 
     std::string DiscreteSetProperty::get() const {
-        auto v = NumericProperty::get_int()[0];
-        return m_reverse.at(v);
+        auto p = read_numeric_values<int>(handle(), id(), dimension());
+        if (p.error) { assert(false); }
+        return m_reverse.at(p.value[0]);
     }
 
     void DiscreteSetProperty::set(const std::string &value) {
         assert(exists());
         auto v = m_forward.at(value);
-        auto old = NumericProperty::get_int();
-        old[0] = v;
-        NumericProperty::set(old);
+        // the other elements of a vector are kept, a scalar needs no read first
+        assert(writeable());
+        auto next = ParameterValues<int>{};
+        next.size = 1;
+        if (dimension() != 1) {
+            next = read_numeric_values<int>(handle(), id(), dimension());
+            if (next.error) { throw PropertyException(); }
+        }
+        next.value[0] = v;
+        if (write_numeric_parameter<int>(handle(), id(), next.value.data(), next.size)) { throw PropertyException(); }
     }
 
     std::string DiscreteSetProperty::range_to_string() const {
@@ -415,35 +482,42 @@ namespace Prokyon {
 
     BoolProperty::BoolProperty(DijSDK_Handle handle, DijSDK_EParamId id) :
         DiscreteSetProperty(handle, id, {{"false", 0}, {"true", 1}}, true) {
-        assert(type() == Type::Bool);
+        assert(!exists() || type() == Type::Bool);
     }
 
     // free functions
+    error_t read_string_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, char *p_value, unsigned int length) {
+        assert(0 < length);
+        auto result = SdkThread::call([&]() { return DijSDK_GetStringParameter(handle, param_id, p_value, length); });
+        p_value[length - 1] = '\0';
+        return result;
+    }
+
     StringParameter get_string_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, unsigned int length) {
-        std::vector<char> value(length, char{});
-        auto result = DijSDK_GetStringParameter(handle, param_id, value.data(), length);
-        auto it = std::find(value.cbegin(), value.cend(), '\0');
-        return {std::string(value.cbegin(), it), result};
+        StringParameter out{std::string(length, '\0'), 0};
+        out.error = read_string_parameter(handle, param_id, &out.value[0], length);
+        out.value.resize(std::find(out.value.cbegin(), out.value.cend(), '\0') - out.value.cbegin());
+        return out;
     }
 
     template<>
     error_t get_numeric_sdk_parameter(DijSDK_Handle handle, DijSDK_EParamId paramId, int *pValue, unsigned int num, DijSDK_EParamQuery query) {
-        return DijSDK_GetIntParameter(handle, paramId, pValue, num, query);
+        return SdkThread::call([&]() { return DijSDK_GetIntParameter(handle, paramId, pValue, num, query); });
     }
 
     template<>
     error_t get_numeric_sdk_parameter(DijSDK_Handle handle, DijSDK_EParamId paramId, double *pValue, unsigned int num, DijSDK_EParamQuery query) {
-        return DijSDK_GetDoubleParameter(handle, paramId, pValue, num, query);
+        return SdkThread::call([&]() { return DijSDK_GetDoubleParameter(handle, paramId, pValue, num, query); });
     }
 
     template<>
     error_t set_numeric_sdk_parameter(DijSDK_Handle handle, DijSDK_EParamId paramId, int *pValue, unsigned int num) {
-        return DijSDK_SetIntParameterArray(handle, paramId, pValue, num);
+        return SdkThread::call([&]() { return DijSDK_SetIntParameterArray(handle, paramId, pValue, num); });
     }
 
     template<>
     error_t set_numeric_sdk_parameter(DijSDK_Handle handle, DijSDK_EParamId paramId, double *pValue, unsigned int num) {
-        return DijSDK_SetDoubleParameterArray(handle, paramId, pValue, num);
+        return SdkThread::call([&]() { return DijSDK_SetDoubleParameterArray(handle, paramId, pValue, num); });
     }
 
     typename std::make_unsigned<int>::type to_unsigned(const int signed_value) {
@@ -6,10 +6,13 @@
 #include "dijsdk.h"
 #include "parameterif.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <exception>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <sstream>
 #include <string>
@@ -22,11 +25,13 @@ using error_t = int;
 namespace Prokyon {
     class PropertyException;
 
+    // The specification of a parameter is fixed, it is queried once at construction and served from members.
     class PropertyBase {
     public:
         PropertyBase(DijSDK_Handle handle, DijSDK_EParamId id);
 
         bool exists() const;
+        DijSDK_EParamId get_id() const;
 
         unsigned dimension() const; // throws PropertyException
         bool writeable() const; // throws PropertyException
@@ -47,6 +52,9 @@ namespace Prokyon {
 
         static char delimiter();
         static std::string readable_delimiter();
+        // values separated by the delimiter, white space ignored
+        template<typename T>
+        static bool parse_values(const std::string &s, std::vector<T> &values); // returns success
 
     protected:
         DijSDK_Handle &handle();
@@ -55,6 +63,8 @@ namespace Prokyon {
         const DijSDK_EParamId &id() const;
 
         virtual std::string range_to_string() const = 0;
+        static void parse_value(const std::string &s, int &value); // throws std::logic_error
+        static void parse_value(const std::string &s, double &value); // throws std::logic_error
         template<typename T>
         std::string vec_to_string(const std::vector<T> values) const;
 
@@ -73,9 +83,17 @@ namespace Prokyon {
         template<typename T>
         static std::string vec_to_string(const std::vector<T> values, const char delimiter, const unsigned precision);
 
+    private:
+        void query_specification();
+
     private:
         DijSDK_Handle m_handle;
         DijSDK_EParamId m_id;
+        bool m_exists;
+        Type m_type;
+        unsigned m_dimension;
+        bool m_writeable;
+        bool m_discrete;
     };
 
     template<typename T>
@@ -112,12 +130,13 @@ namespace Prokyon {
     public:
         StringProperty(DijSDK_Handle handle, DijSDK_EParamId id);
         std::string get() const; // throws PropertyException
-        // no set because no useful read-only properties at this time
+        void set(const std::string &value); // throws PropertyException
 
     protected:
         virtual std::string range_to_string() const;
     };
 
+    // Min and max are cached after the first query, they only move with the image mode, see invalidate_range.
     class NumericProperty : public PropertyBase {
     public:
         NumericProperty(DijSDK_Handle handle, DijSDK_EParamId id);
@@ -139,12 +158,15 @@ namespace Prokyon {
         void set(const std::vector<int> &value); // throws PropertyException
         void set(const std::vector<double> &value); // throws PropertyException
 
+        void invalidate_range(); // queried again on next use, after changes that move it (image mode)
+
     protected:
         virtual std::string range_to_string() const;
 
     protected:
         template<typename T>
         std::vector<T> range() const;
+        std::array<double, 2> query_range() const; // throws PropertyException
         template<typename T>
         void clip(T &v) const;
         template<typename T>
@@ -155,6 +177,10 @@ namespace Prokyon {
         std::vector<T> get() const;
         template<typename T>
         void set(const std::vector<T> &value);
+
+    private:
+        mutable bool m_range_cached;
+        mutable std::array<double, 2> m_range; // exact for int parameters
     };
 
     class DiscreteSetProperty : public NumericProperty {
@@ -188,6 +214,26 @@ namespace Prokyon {
 
     class PropertyException : public std::exception {};
 
+    // Allocation free access, from and into storage of the caller, for per frame and per property paths.
+    // Like every sdk call of the adapter these run on the SdkThread, the caller waits.
+    template<typename T>
+    error_t read_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, T *p_value, unsigned int length, DijSDK_EParamQuery query = DijSDK_EParamQueryCurrent);
+    template<typename T>
+    error_t write_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, const T *p_value, unsigned int length);
+    error_t read_string_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, char *p_value, unsigned int length); // zero terminated
+
+    // values held inline, for reads whose length is only known at runtime
+    template<typename T>
+    struct ParameterValues {
+        static const unsigned int M_S_CAPACITY = 256u; // the histograms are the longest parameters
+        std::array<T, M_S_CAPACITY> value;
+        unsigned int size;
+        error_t error;
+    };
+    template<typename T>
+    ParameterValues<T> read_numeric_values(DijSDK_Handle handle, DijSDK_EParamId param_id, unsigned int length, DijSDK_EParamQuery query = DijSDK_EParamQueryCurrent);
+
+    // allocating wrappers of the above
     template<typename T>
     struct NumericParameter {
         std::vector<T> value;
@@ -218,19 +264,32 @@ namespace Prokyon {
 // template implementation
 namespace Prokyon {
     template<typename T>
-    std::vector<T> NumericProperty::range() const {
-        std::vector<T> range;
-
-        auto p = get_numeric_parameter<T>(handle(), id(), dimension(), DijSDK_EParamQueryMin);
-        if (p.error) { assert(false); }
-        range.push_back(p.value[0]);
-
-        p = get_numeric_parameter<T>(handle(), id(), dimension(), DijSDK_EParamQueryMax);
-        if (p.error) { assert(false); }
-        range.push_back(p.value[0]);
+    bool PropertyBase::parse_values(const std::string &s, std::vector<T> &values) {
+        values.clear();
+        std::stringstream words(s);
+        std::string word;
+        while (std::getline(words, word, delimiter())) {
+            word.erase(std::remove_if(word.begin(), word.end(), [](const char c) {return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f'; }), word.end());
+            T value{};
+            try {
+                parse_value(word, value);
+            }
+            catch (std::logic_error) {
+                return false;
+            }
+            values.push_back(value);
+        }
+        return true;
+    }
 
+    template<typename T>
+    std::vector<T> NumericProperty::range() const {
+        if (!m_range_cached) {
+            m_range = query_range();
+            m_range_cached = true;
+        }
+        std::vector<T> range{static_cast<T>(m_range[0]), static_cast<T>(m_range[1])};
         assert(range[0] <= range[1]);
-        assert(range.size() == 2);
         return range;
     }
 
@@ -243,8 +302,11 @@ namespace Prokyon {
 
     template<typename T>
     void NumericProperty::clip(std::vector<T> &v) const {
-        for (auto i = 0; i < v.size(); ++i) {
-            clip<T>(v[i]);
+        // one range for all elements
+        auto r = range<T>();
+        for (auto &e : v) {
+            if (e < r[0]) { e = r[0]; }
+            if (r[1] < e) { e = r[1]; }
         }
     }
 
@@ -273,20 +335,41 @@ namespace Prokyon {
         }
     }
 
+    template<typename T>
+    error_t read_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, T *p_value, unsigned int length, DijSDK_EParamQuery query) {
+        return get_numeric_sdk_parameter<T>(handle, param_id, p_value, length, query);
+    }
+
+    template<typename T>
+    error_t write_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, const T *p_value, unsigned int length) {
+        // the sdk takes a non-const pointer, but does not write through it
+        return set_numeric_sdk_parameter<T>(handle, param_id, const_cast<T *>(p_value), length);
+    }
+
+    template<typename T>
+    const unsigned int ParameterValues<T>::M_S_CAPACITY;
+
+    template<typename T>
+    ParameterValues<T> read_numeric_values(DijSDK_Handle handle, DijSDK_EParamId param_id, unsigned int length, DijSDK_EParamQuery query) {
+        assert(length <= ParameterValues<T>::M_S_CAPACITY);
+        ParameterValues<T> out;
+        out.size = (std::min)(length, ParameterValues<T>::M_S_CAPACITY);
+        out.error = read_numeric_parameter<T>(handle, param_id, out.value.data(), out.size, query);
+        return out;
+    }
+
     template<typename T>
     NumericParameter<T> get_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, unsigned int length, DijSDK_EParamQuery query) {
-        std::vector<T> value(length);
-        auto result = get_numeric_sdk_parameter<T>(handle, param_id, value.data(), length, query);
-        //assert(value.size() == length);
-        return {value, result};
+        NumericParameter<T> out{std::vector<T>(length), 0};
+        out.error = read_numeric_parameter<T>(handle, param_id, out.value.data(), length, query);
+        return out;
     }
 
     template<typename T>
-    error_t set_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId paramId, const std::vector<T> &value) {
-        std::vector<T> v(value);
+    error_t set_numeric_parameter(DijSDK_Handle handle, DijSDK_EParamId param_id, const std::vector<T> &value) {
         auto num = value.size();
         assert(num <= (std::numeric_limits<unsigned int>::max)());
-        return set_numeric_sdk_parameter<T>(handle, paramId, v.data(), static_cast<unsigned int>(num));
+        return write_numeric_parameter<T>(handle, param_id, value.data(), static_cast<unsigned int>(num));
     };
 }
 
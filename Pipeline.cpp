@@ -0,0 +1,366 @@
+#include "Pipeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace Prokyon {
+    Pipeline::Pipeline(BufferPool *p_pool) :
+        m_p_pool{p_pool},
+        m_stages{},
+        m_plan{},
+        m_timings{},
+        m_sync_slot{},
+        m_sync_input{0, 0, 0, 0, 0, 0},
+        m_slots{},
+        m_workers{},
+        m_worker_policies{},
+        m_delivery{},
+        m_running{false},
+        m_stopping{false},
+        m_queue_mutex{},
+        m_queue_cv{},
+        m_queue{},
+        m_free{},
+        m_p_current{nullptr},
+        m_next_sequence{1},
+        m_next_queued{1},
+        m_order_mutex{},
+        m_order_cv{},
+        m_stage_turn{},
+        m_delivery_mutex{},
+        m_done{},
+        m_next_delivery{1},
+        m_delivered{0},
+        m_dropped{0},
+        m_failed{0},
+        m_policy_failures{0}
+    {}
+
+    Pipeline::~Pipeline() {
+        stop();
+        release_buffers();
+    }
+
+    void Pipeline::set_stages(const std::vector<std::shared_ptr<Stage>> &stages) {
+        if (m_running) { throw PipelineException(); }
+        m_stages = stages;
+        m_plan = Plan{};
+        m_timings = std::vector<StageTiming>(m_stages.size());
+        m_sync_input = FrameLayout{0, 0, 0, 0, 0, 0};
+    }
+
+    std::vector<std::string> Pipeline::get_stage_names() const {
+        std::vector<std::string> names;
+        for (const auto &p_stage : m_stages) {
+            names.push_back(p_stage->get_name());
+        }
+        return names;
+    }
+
+    bool Pipeline::empty() const {
+        return m_stages.empty();
+    }
+
+    FrameLayout Pipeline::compute_output_layout(const FrameLayout &input) const {
+        return make_plan(input).layouts.back();
+    }
+
+    Frame Pipeline::process(const Frame &input) {
+        if (m_running) { throw PipelineException(); }
+        assert(input.p_data != nullptr);
+        if (m_stages.empty()) { return input; }
+
+        if (input.layout != m_sync_input || m_plan.layouts.empty()) {
+            m_plan = make_plan(input.layout);
+            allocate(m_sync_slot);
+            m_sync_input = input.layout;
+        }
+
+        // the caller's buffer stands in for the input buffer unless an in place stage would write over it
+        const auto writes_input = std::find(m_plan.buffer_of.cbegin() + 1, m_plan.buffer_of.cend(), std::size_t{0}) != m_plan.buffer_of.cend();
+        if (writes_input) {
+            std::memcpy(m_sync_slot.buffers[0].data(), input.p_data, input.layout.bytes());
+        }
+
+        m_sync_slot.sequence = input.sequence;
+        m_sync_slot.stamp = input.stamp;
+        m_sync_slot.failed = false;
+        run_stages(m_sync_slot, writes_input ? nullptr : input.p_data, false);
+        if (m_sync_slot.failed) { throw PipelineException(); }
+
+        const auto last = m_plan.layouts.size() - 1;
+        return Frame{m_plan.layouts[last], m_sync_slot.buffers[m_plan.buffer_of[last]].data(), input.sequence, input.stamp};
+    }
+
+    void Pipeline::set_worker_policies(const std::vector<ThreadPolicy> &policies) {
+        if (m_running) { throw PipelineException(); }
+        m_worker_policies = policies;
+    }
+
+    void Pipeline::release_buffers() {
+        assert(!m_running);
+        release(m_sync_slot);
+        m_sync_input = FrameLayout{0, 0, 0, 0, 0, 0};
+        for (auto &p_slot : m_slots) {
+            release(*p_slot);
+        }
+        m_slots.clear();
+        m_free.clear();
+    }
+
+    void Pipeline::start(const FrameLayout &input, unsigned worker_count, unsigned depth, Delivery delivery) {
+        if (m_running) { throw PipelineException(); }
+        assert(delivery);
+
+        m_plan = make_plan(input);
+        release(m_sync_slot);
+        m_sync_input = FrameLayout{0, 0, 0, 0, 0, 0};
+        m_timings = std::vector<StageTiming>(m_stages.size());
+
+        depth = (std::max)(depth, 2u);
+        // the old slots go back first, so buffers of the same size are reused
+        for (auto &p_slot : m_slots) {
+            release(*p_slot);
+        }
+        m_slots.clear();
+        m_free.clear();
+        for (unsigned s = 0; s < depth; ++s) {
+            m_slots.emplace_back(new Slot{});
+            allocate(*m_slots.back());
+            m_free.push_back(m_slots.back().get());
+        }
+        m_queue.assign(depth, nullptr);
+        m_done.assign(depth, nullptr);
+        m_p_current = nullptr;
+        m_next_sequence = 1;
+        m_next_queued = 1;
+        m_next_delivery = 1;
+        m_stage_turn.assign(m_stages.size(), 1);
+        m_delivered = 0;
+        m_dropped = 0;
+        m_failed = 0;
+        m_policy_failures = 0;
+        m_delivery = delivery;
+        m_stopping = false;
+        m_running = true;
+
+        worker_count = (std::max)(worker_count, 1u);
+        for (unsigned w = 0; w < worker_count; ++w) {
+            m_workers.emplace_back(&Pipeline::work, this, w);
+        }
+    }
+
+    void Pipeline::stop() {
+        {
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            if (!m_running) { return; }
+            m_stopping = true;
+            if (m_p_current != nullptr) {
+                m_free.push_back(m_p_current);
+                m_p_current = nullptr;
+            }
+            // everything submitted is delivered once all slots are free again
+            m_queue_cv.wait(lock, [this]() { return m_free.size() == m_slots.size(); });
+            m_running = false;
+        }
+        m_queue_cv.notify_all();
+        for (auto &worker : m_workers) {
+            worker.join();
+        }
+        m_workers.clear();
+        m_delivery = nullptr;
+    }
+
+    bool Pipeline::is_running() const {
+        return m_running;
+    }
+
+    unsigned char *Pipeline::begin_frame() {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        if (!m_running || m_stopping) { return nullptr; }
+        if (m_p_current == nullptr) {
+            if (m_free.empty()) {
+                ++m_dropped;
+                return nullptr;
+            }
+            m_p_current = m_free.back();
+            m_free.pop_back();
+        }
+        return m_p_current->buffers[0].data();
+    }
+
+    void Pipeline::submit_frame(const FrameStamp &stamp) {
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            assert(m_p_current != nullptr);
+            m_p_current->sequence = m_next_sequence++;
+            m_p_current->stamp = stamp;
+            m_p_current->failed = false;
+            m_queue[m_p_current->sequence % m_queue.size()] = m_p_current;
+            m_p_current = nullptr;
+        }
+        m_queue_cv.notify_all();
+    }
+
+    std::uint64_t Pipeline::get_delivered_count() const {
+        return m_delivered;
+    }
+
+    std::uint64_t Pipeline::get_dropped_count() const {
+        return m_dropped;
+    }
+
+    std::uint64_t Pipeline::get_failed_count() const {
+        return m_failed;
+    }
+
+    unsigned Pipeline::get_policy_failure_count() const {
+        return m_policy_failures;
+    }
+
+    std::string Pipeline::timing_to_string() const {
+        std::stringstream ss;
+        for (std::size_t i = 0; i < (std::min)(m_stages.size(), m_timings.size()); ++i) {
+            const auto frames = m_timings[i].frames.load();
+            const auto ms = (frames == 0) ? 0.0 : m_timings[i].ns.load() / 1e6 / frames;
+            if (0 < i) {
+                ss << "; ";
+            }
+            ss << m_stages[i]->get_name() << " " << ms << " ms";
+        }
+        if (!m_stages.empty()) {
+            ss << " | ";
+        }
+        ss << "delivered " << m_delivered << ", dropped " << m_dropped << ", failed " << m_failed;
+        return ss.str();
+    }
+
+    // private
+    Pipeline::Plan Pipeline::make_plan(const FrameLayout &input) const {
+        Plan plan;
+        plan.layouts.push_back(input);
+        plan.buffer_of.push_back(0);
+        plan.buffer_bytes.push_back(input.bytes());
+        for (const auto &p_stage : m_stages) {
+            const auto &in = plan.layouts.back();
+            auto out = p_stage->get_output_layout(in);
+            if (out.bytes() == 0) { throw PipelineException(); }
+            if (p_stage->is_in_place() && out.bytes() == in.bytes()) {
+                plan.buffer_of.push_back(plan.buffer_of.back());
+            }
+            else {
+                plan.buffer_of.push_back(plan.buffer_bytes.size());
+                plan.buffer_bytes.push_back(out.bytes());
+            }
+            plan.layouts.push_back(out);
+        }
+        return plan;
+    }
+
+    void Pipeline::allocate(Slot &slot) {
+        release(slot);
+        try {
+            for (auto bytes : m_plan.buffer_bytes) {
+                slot.buffers.push_back(m_p_pool->take(bytes));
+            }
+        }
+        catch (BufferPoolException) {
+            release(slot);
+            throw PipelineException();
+        }
+        slot.sequence = 0;
+        slot.stamp = FrameStamp{-1, 0};
+        slot.failed = false;
+    }
+
+    void Pipeline::release(Slot &slot) {
+        for (auto &buffer : slot.buffers) {
+            m_p_pool->give(std::move(buffer));
+        }
+        slot.buffers.clear();
+    }
+
+    void Pipeline::run_stages(Slot &slot, const unsigned char *p_input, bool ordered_turns) {
+        auto data = [&](std::size_t layout) {
+            auto buffer = m_plan.buffer_of[layout];
+            return (buffer == 0 && p_input != nullptr) ? const_cast<unsigned char *>(p_input) : slot.buffers[buffer].data();
+        };
+
+        for (std::size_t i = 0; i < m_stages.size(); ++i) {
+            auto &stage = *m_stages[i];
+            const auto ordered = ordered_turns && stage.is_ordered();
+            if (ordered) {
+                std::unique_lock<std::mutex> lock(m_order_mutex);
+                m_order_cv.wait(lock, [&]() { return m_stage_turn[i] == slot.sequence; });
+            }
+
+            // a failed frame still takes its turn in the ordered stages, so later frames are not blocked
+            if (!slot.failed) {
+                const Frame input{m_plan.layouts[i], data(i), slot.sequence, slot.stamp};
+                Frame output{m_plan.layouts[i + 1], data(i + 1), slot.sequence, slot.stamp};
+                auto t0 = std::chrono::steady_clock::now();
+                try {
+                    stage.process(input, output);
+                }
+                catch (PipelineException) {
+                    slot.failed = true;
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                m_timings[i].ns += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                ++m_timings[i].frames;
+            }
+
+            if (ordered) {
+                {
+                    std::lock_guard<std::mutex> lock(m_order_mutex);
+                    ++m_stage_turn[i];
+                }
+                m_order_cv.notify_all();
+            }
+        }
+    }
+
+    void Pipeline::work(unsigned index) {
+        if (!m_worker_policies.empty() && !Scheduling::apply(m_worker_policies[index % m_worker_policies.size()])) {
+            ++m_policy_failures;
+        }
+        while (true) {
+            Slot *p_slot = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_queue_mutex);
+                m_queue_cv.wait(lock, [this]() { return m_next_queued != m_next_sequence || !m_running; });
+                if (m_next_queued == m_next_sequence) { return; }
+                p_slot = m_queue[m_next_queued++ % m_queue.size()];
+            }
+            run_stages(*p_slot, nullptr, true);
+            finish(p_slot);
+        }
+    }
+
+    void Pipeline::finish(Slot *p_slot) {
+        std::lock_guard<std::mutex> lock(m_delivery_mutex);
+        // at most one frame per slot is undelivered, so these sequences differ modulo the depth
+        const auto depth = m_done.size();
+        m_done[p_slot->sequence % depth] = p_slot;
+        const auto last = m_plan.layouts.size() - 1;
+        for (auto p_ready = m_done[m_next_delivery % depth]; p_ready != nullptr; p_ready = m_done[m_next_delivery % depth]) {
+            m_done[m_next_delivery % depth] = nullptr;
+            if (p_ready->failed) {
+                ++m_failed;
+            }
+            else {
+                m_delivery(Frame{m_plan.layouts[last], p_ready->buffers[m_plan.buffer_of[last]].data(), p_ready->sequence, p_ready->stamp});
+                ++m_delivered;
+            }
+            ++m_next_delivery;
+            {
+                std::lock_guard<std::mutex> queue_lock(m_queue_mutex);
+                m_free.push_back(p_ready);
+            }
+            m_queue_cv.notify_all();
+        }
+    }
+}
\ No newline at end of file
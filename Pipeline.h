@@ -0,0 +1,165 @@
+#pragma once
+
+#ifndef PROKYON_PIPELINE_H_
+#define PROKYON_PIPELINE_H_
+
+#include "FrameLayout.h"
+#include "BufferPool.h"
+#include "Scheduling.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Prokyon {
+    class PipelineException;
+
+    // taken by the producer when the frame arrives, carried through the stages unchanged
+    struct FrameStamp {
+        std::int64_t sensor_counter; // -1 if the camera does not count
+        std::uint64_t timestamp_us; // host monotonic clock, from the start of the sequence
+    };
+
+    struct Frame {
+        FrameLayout layout;
+        unsigned char *p_data;
+        std::uint64_t sequence; // counts from 1 per start of the pipeline
+        FrameStamp stamp;
+    };
+
+    // One processing step of a Pipeline.
+    class Stage {
+    public:
+        virtual ~Stage() {}
+
+        virtual std::string get_name() const = 0;
+        // layout this stage produces from the given input, throws PipelineException for unsupported input
+        virtual FrameLayout get_output_layout(const FrameLayout &input) const = 0;
+        // output may share the input buffer, used only if both layouts have the same byte count
+        virtual bool is_in_place() const { return false; }
+        // the stage keeps state across frames, frames then pass it one at a time in sequence order
+        virtual bool is_ordered() const { return false; }
+        virtual void process(const Frame &input, Frame &output) = 0; // throws PipelineException
+    };
+
+    // Ordered list of stages run on a pool of workers.
+    // Each frame lives in a slot holding one buffer per distinct stage output, taken from the pool at start and reused,
+    // in place stages write into their input buffer. A worker takes a frame through all stages,
+    // so frames run in parallel, except through ordered stages. Frames are delivered in sequence order.
+    class Pipeline {
+    public:
+        using Delivery = std::function<void(const Frame &)>;
+
+        Pipeline(BufferPool *p_pool);
+        ~Pipeline();
+        Pipeline(const Pipeline &) = delete;
+        Pipeline &operator=(const Pipeline &) = delete;
+
+        void set_stages(const std::vector<std::shared_ptr<Stage>> &stages); // throws PipelineException while running
+        std::vector<std::string> get_stage_names() const;
+        bool empty() const;
+        FrameLayout compute_output_layout(const FrameLayout &input) const; // throws PipelineException
+
+        // synchronous, on the calling thread, the output stays valid until the next call
+        // not while running
+        Frame process(const Frame &input); // throws PipelineException
+
+        // asynchronous
+        // worker i applies policy i modulo the count at start, no policies leave the workers as created
+        void set_worker_policies(const std::vector<ThreadPolicy> &policies); // throws PipelineException while running
+        void release_buffers(); // back to the pool, not while running
+        void start(const FrameLayout &input, unsigned worker_count, unsigned depth, Delivery delivery); // throws PipelineException
+        void stop(); // delivers the frames already submitted, then joins the workers
+        bool is_running() const;
+
+        // producer side, from one thread
+        unsigned char *begin_frame(); // input buffer of a free slot, nullptr if all slots are busy and the frame has to be dropped
+        void submit_frame(const FrameStamp &stamp); // hands the buffer of the last begin_frame to the workers
+
+        std::uint64_t get_delivered_count() const;
+        std::uint64_t get_dropped_count() const;
+        std::uint64_t get_failed_count() const;
+        unsigned get_policy_failure_count() const; // workers of the last start that could not apply their policy
+        std::string timing_to_string() const;
+
+    private:
+        struct Slot {
+            std::vector<FrameBuffer> buffers;
+            std::uint64_t sequence;
+            FrameStamp stamp;
+            bool failed;
+        };
+
+        struct StageTiming {
+            std::atomic<std::uint64_t> ns{0};
+            std::atomic<std::uint64_t> frames{0};
+        };
+
+        // buffer plan for a given input, shared by all slots
+        struct Plan {
+            std::vector<FrameLayout> layouts; // input, then the output of each stage
+            std::vector<std::size_t> buffer_of; // buffer index of each layout
+            std::vector<std::size_t> buffer_bytes;
+        };
+
+        Plan make_plan(const FrameLayout &input) const; // throws PipelineException
+        void allocate(Slot &slot); // throws PipelineException
+        void release(Slot &slot);
+        // p_input replaces the first buffer of the slot if not nullptr
+        void run_stages(Slot &slot, const unsigned char *p_input, bool ordered_turns);
+        void work(unsigned index);
+        void finish(Slot *p_slot);
+
+    private:
+        BufferPool *m_p_pool;
+        std::vector<std::shared_ptr<Stage>> m_stages;
+        Plan m_plan;
+        std::vector<StageTiming> m_timings;
+
+        // synchronous path
+        Slot m_sync_slot;
+        FrameLayout m_sync_input;
+
+        // asynchronous path
+        std::vector<std::unique_ptr<Slot>> m_slots;
+        std::vector<std::thread> m_workers;
+        std::vector<ThreadPolicy> m_worker_policies;
+        Delivery m_delivery;
+        bool m_running;
+        bool m_stopping;
+
+        std::mutex m_queue_mutex;
+        std::condition_variable m_queue_cv;
+        // submitted frames not yet taken by a worker are the sequences from m_next_queued to before m_next_sequence,
+        // fewer than the depth, so the queue and the delivery below are rings by sequence modulo the depth, free of allocation
+        std::vector<Slot *> m_queue;
+        std::vector<Slot *> m_free;
+        Slot *m_p_current;
+        std::uint64_t m_next_sequence;
+        std::uint64_t m_next_queued;
+
+        std::mutex m_order_mutex;
+        std::condition_variable m_order_cv;
+        std::vector<std::uint64_t> m_stage_turn; // next sequence allowed into each ordered stage
+
+        std::mutex m_delivery_mutex;
+        std::vector<Slot *> m_done; // finished and not yet delivered
+        std::uint64_t m_next_delivery;
+
+        std::atomic<std::uint64_t> m_delivered;
+        std::atomic<std::uint64_t> m_dropped;
+        std::atomic<std::uint64_t> m_failed;
+        std::atomic<unsigned> m_policy_failures;
+    };
+
+    class PipelineException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
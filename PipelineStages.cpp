@@ -0,0 +1,318 @@
+#include "PipelineStages.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace Prokyon {
+    // ConvertStage
+    ConvertStage::ConvertStage(Image *p_image) :
+        m_p_image{p_image},
+        m_p_plan{nullptr}
+    {}
+
+    void ConvertStage::set_plan(const Image::ConversionPlan &plan) {
+        m_p_plan = std::make_unique<Image::ConversionPlan>(plan);
+    }
+
+    const Image::ConversionPlan &ConvertStage::get_plan() const {
+        assert(m_p_plan != nullptr);
+        return *m_p_plan;
+    }
+
+    std::string ConvertStage::get_name() const {
+        return "convert";
+    }
+
+    FrameLayout ConvertStage::get_output_layout(const FrameLayout &input) const {
+        if (m_p_plan == nullptr || input != m_p_plan->raw) { throw PipelineException(); }
+        return m_p_plan->output;
+    }
+
+    void ConvertStage::process(const Frame &input, Frame &output) {
+        assert(input.layout == m_p_plan->raw);
+        m_p_image->convert_frame(*m_p_plan, input.p_data, output.p_data);
+    }
+
+    // ObserveStage
+    ObserveStage::ObserveStage(Image *p_image) :
+        m_p_image{p_image}
+    {}
+
+    std::string ObserveStage::get_name() const {
+        return "observe";
+    }
+
+    FrameLayout ObserveStage::get_output_layout(const FrameLayout &input) const {
+        if (input.is_raw()) { throw PipelineException(); }
+        return input;
+    }
+
+    bool ObserveStage::is_in_place() const {
+        return true;
+    }
+
+    bool ObserveStage::is_ordered() const {
+        return true;
+    }
+
+    void ObserveStage::process(const Frame &input, Frame &output) {
+        assert(input.p_data == output.p_data);
+        m_p_image->observe_frame(input.layout, input.p_data);
+    }
+
+    // BinStage
+    BinStage::BinStage(unsigned factor) :
+        m_factor{factor}
+    {
+        if (factor < 2) { throw PipelineException(); }
+    }
+
+    std::string BinStage::get_name() const {
+        std::stringstream ss;
+        ss << "bin " << m_factor;
+        return ss.str();
+    }
+
+    FrameLayout BinStage::get_output_layout(const FrameLayout &input) const {
+        if (input.is_raw() || (input.bits_per_component != 8 && input.bits_per_component != 16)) { throw PipelineException(); }
+        auto output = input;
+        output.width = input.width / m_factor;
+        output.height = input.height / m_factor;
+        if (output.width == 0 || output.height == 0) { throw PipelineException(); }
+        return output;
+    }
+
+    void BinStage::process(const Frame &input, Frame &output) {
+        if (input.layout.bits_per_component == 8) {
+            bin<std::uint8_t>(input, output);
+        }
+        else {
+            bin<std::uint16_t>(input, output);
+        }
+    }
+
+    template<typename T>
+    void BinStage::bin(const Frame &input, Frame &output) const {
+        const auto &in = input.layout;
+        const auto &out = output.layout;
+        const auto components = in.components;
+        const auto row_values = static_cast<std::size_t>(out.width) * components;
+        const auto area = m_factor * m_factor;
+
+        // sums of one output row, the input is read row by row
+        std::vector<std::uint32_t> sums(row_values);
+        for (unsigned channel = 0; channel < in.channels; ++channel) {
+            auto p_in = reinterpret_cast<const T *>(input.p_data + channel * in.plane_bytes());
+            auto p_out = reinterpret_cast<T *>(output.p_data + channel * out.plane_bytes());
+            for (unsigned oy = 0; oy < out.height; ++oy) {
+                std::fill(sums.begin(), sums.end(), 0u);
+                for (unsigned dy = 0; dy < m_factor; ++dy) {
+                    auto p_row = p_in + static_cast<std::size_t>(oy * m_factor + dy) * in.width * components;
+                    for (unsigned ox = 0; ox < out.width; ++ox) {
+                        auto p_block = p_row + static_cast<std::size_t>(ox) * m_factor * components;
+                        auto p_sum = sums.data() + static_cast<std::size_t>(ox) * components;
+                        for (unsigned dx = 0; dx < m_factor; ++dx) {
+                            for (unsigned c = 0; c < components; ++c) {
+                                p_sum[c] += p_block[dx * components + c];
+                            }
+                        }
+                    }
+                }
+                auto p_out_row = p_out + oy * row_values;
+                for (std::size_t i = 0; i < row_values; ++i) {
+                    p_out_row[i] = static_cast<T>((sums[i] + area / 2) / area);
+                }
+            }
+        }
+    }
+
+    // FrameStatisticsStage
+    FrameStatisticsStage::FrameStatisticsStage() :
+        m_mutex{},
+        m_sequence{0},
+        m_min{0.0},
+        m_max{0.0},
+        m_mean{0.0}
+    {}
+
+    std::string FrameStatisticsStage::get_name() const {
+        return "statistics";
+    }
+
+    FrameLayout FrameStatisticsStage::get_output_layout(const FrameLayout &input) const {
+        if (input.is_raw() || (input.bits_per_component != 8 && input.bits_per_component != 16)) { throw PipelineException(); }
+        return input;
+    }
+
+    bool FrameStatisticsStage::is_in_place() const {
+        return true;
+    }
+
+    bool FrameStatisticsStage::is_ordered() const {
+        return true;
+    }
+
+    void FrameStatisticsStage::process(const Frame &input, Frame &output) {
+        if (input.layout.bits_per_component == 8) {
+            measure<std::uint8_t>(input);
+        }
+        else {
+            measure<std::uint16_t>(input);
+        }
+        if (output.p_data != input.p_data) {
+            std::copy(input.p_data, input.p_data + input.layout.bytes(), output.p_data);
+        }
+    }
+
+    std::string FrameStatisticsStage::get_summary() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::stringstream ss;
+        ss << "frame " << m_sequence << ": min " << m_min << ", max " << m_max << ", mean " << m_mean;
+        return ss.str();
+    }
+
+    template<typename T>
+    void FrameStatisticsStage::measure(const Frame &input) {
+        auto p = reinterpret_cast<const T *>(input.p_data);
+        const auto count = input.layout.bytes() / sizeof(T);
+        T lo = std::numeric_limits<T>::max();
+        T hi = 0;
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            lo = (std::min)(lo, p[i]);
+            hi = (std::max)(hi, p[i]);
+            sum += p[i];
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sequence = input.sequence;
+        m_min = lo;
+        m_max = hi;
+        m_mean = (count == 0) ? 0.0 : static_cast<double>(sum) / count;
+    }
+
+    // PluginStage
+    PluginStage::PluginStage(const std::string &path, const std::string &config) :
+        m_library{nullptr},
+        m_p_api{nullptr},
+        m_p_instance{nullptr}
+    {
+        ProkyonGetStageApi get_api = nullptr;
+#ifdef _WIN32
+        auto module = LoadLibraryA(path.c_str());
+        m_library = module;
+        if (module != nullptr) {
+            get_api = reinterpret_cast<ProkyonGetStageApi>(GetProcAddress(module, "prokyon_get_stage_api"));
+        }
+#else
+        m_library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (m_library != nullptr) {
+            get_api = reinterpret_cast<ProkyonGetStageApi>(dlsym(m_library, "prokyon_get_stage_api"));
+        }
+#endif
+        if (get_api != nullptr) {
+            m_p_api = get_api();
+        }
+        // a library built against a newer header may rely on members this adapter does not know
+        if (m_p_api != nullptr && m_p_api->abi_version <= PROKYON_STAGE_ABI_VERSION
+            && m_p_api->create != nullptr && m_p_api->destroy != nullptr && m_p_api->output_layout != nullptr && m_p_api->process != nullptr) {
+            m_p_instance = m_p_api->create(config.c_str());
+        }
+        if (m_p_instance == nullptr) {
+            m_p_api = nullptr;
+#ifdef _WIN32
+            if (m_library != nullptr) { FreeLibrary(static_cast<HMODULE>(m_library)); }
+#else
+            if (m_library != nullptr) { dlclose(m_library); }
+#endif
+            throw PipelineException();
+        }
+    }
+
+    PluginStage::~PluginStage() {
+        m_p_api->destroy(m_p_instance);
+#ifdef _WIN32
+        FreeLibrary(static_cast<HMODULE>(m_library));
+#else
+        dlclose(m_library);
+#endif
+    }
+
+    std::string PluginStage::get_name() const {
+        return (m_p_api->name != nullptr) ? m_p_api->name : "plugin";
+    }
+
+    FrameLayout PluginStage::get_output_layout(const FrameLayout &input) const {
+        if (input.is_raw()) { throw PipelineException(); }
+        auto c_input = to_c(input);
+        ProkyonFrameLayout c_output = c_input;
+        if (m_p_api->output_layout(m_p_instance, &c_input, &c_output) != PROKYON_STAGE_OK) { throw PipelineException(); }
+        return {c_output.width, c_output.height, c_output.components, c_output.bits_per_component, c_output.channels, 0u};
+    }
+
+    bool PluginStage::is_in_place() const {
+        return (m_p_api->flags & PROKYON_STAGE_IN_PLACE) != 0;
+    }
+
+    bool PluginStage::is_ordered() const {
+        return (m_p_api->flags & PROKYON_STAGE_ORDERED) != 0;
+    }
+
+    void PluginStage::process(const Frame &input, Frame &output) {
+        auto c_input = to_c(input.layout);
+        auto c_output = to_c(output.layout);
+        auto result = m_p_api->process(m_p_instance, &c_input, input.p_data, &c_output, output.p_data, input.sequence);
+        if (result != PROKYON_STAGE_OK) { throw PipelineException(); }
+    }
+
+    // private
+    ProkyonFrameLayout PluginStage::to_c(const FrameLayout &layout) {
+        return {layout.width, layout.height, layout.components, layout.bits_per_component, layout.channels};
+    }
+
+    // factory
+    std::vector<std::shared_ptr<Stage>> make_stages(const std::string &spec) {
+        std::vector<std::shared_ptr<Stage>> stages;
+        std::stringstream entries(spec);
+        std::string entry;
+        while (std::getline(entries, entry, ';')) {
+            std::stringstream words(entry);
+            std::string kind;
+            if (!(words >> kind)) { continue; }
+
+            if (kind == "bin") {
+                unsigned factor = 0;
+                if (!(words >> factor)) { throw PipelineException(); }
+                stages.push_back(std::make_shared<BinStage>(factor));
+            }
+            else if (kind == "statistics") {
+                stages.push_back(std::make_shared<FrameStatisticsStage>());
+            }
+            else if (kind == "plugin") {
+                std::string path;
+                if (!(words >> path)) { throw PipelineException(); }
+                std::string config;
+                std::getline(words >> std::ws, config);
+                stages.push_back(std::make_shared<PluginStage>(path, config));
+            }
+            else {
+                throw PipelineException();
+            }
+        }
+        return stages;
+    }
+}
\ No newline at end of file
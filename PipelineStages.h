@@ -0,0 +1,119 @@
+#pragma once
+
+#ifndef PROKYON_PIPELINE_STAGES_H_
+#define PROKYON_PIPELINE_STAGES_H_
+
+#include "Image.h"
+#include "Pipeline.h"
+#include "ProkyonStageApi.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    // Raw SDK frame to the adapter output, see Image::convert_frame.
+    // Unordered, the workers convert frames in parallel, ObserveStage takes them in order afterwards.
+    class ConvertStage : public Stage {
+    public:
+        ConvertStage(Image *p_image);
+
+        void set_plan(const Image::ConversionPlan &plan); // not while a pipeline runs this stage
+        const Image::ConversionPlan &get_plan() const; // after set_plan
+
+        std::string get_name() const override;
+        FrameLayout get_output_layout(const FrameLayout &input) const override;
+        void process(const Frame &input, Frame &output) override;
+
+    private:
+        Image *m_p_image;
+        std::unique_ptr<Image::ConversionPlan> m_p_plan;
+    };
+
+    // Feeds preview, focus metric and publisher with the converted frames, see Image::observe_frame.
+    // Ordered, since those keep state across frames, leaves the pixels alone.
+    class ObserveStage : public Stage {
+    public:
+        ObserveStage(Image *p_image);
+
+        std::string get_name() const override;
+        FrameLayout get_output_layout(const FrameLayout &input) const override;
+        bool is_in_place() const override;
+        bool is_ordered() const override;
+        void process(const Frame &input, Frame &output) override;
+
+    private:
+        Image *m_p_image;
+    };
+
+    // Software binning, averages factor x factor blocks, drops the remainder at the right and bottom edges.
+    class BinStage : public Stage {
+    public:
+        BinStage(unsigned factor); // throws PipelineException
+
+        std::string get_name() const override;
+        FrameLayout get_output_layout(const FrameLayout &input) const override;
+        void process(const Frame &input, Frame &output) override;
+
+    private:
+        template<typename T>
+        void bin(const Frame &input, Frame &output) const;
+
+    private:
+        unsigned m_factor;
+    };
+
+    // Minimum, maximum and mean of each frame, leaves the pixels alone.
+    class FrameStatisticsStage : public Stage {
+    public:
+        FrameStatisticsStage();
+
+        std::string get_name() const override;
+        FrameLayout get_output_layout(const FrameLayout &input) const override;
+        bool is_in_place() const override;
+        bool is_ordered() const override;
+        void process(const Frame &input, Frame &output) override;
+
+        std::string get_summary() const; // of the latest frame
+
+    private:
+        template<typename T>
+        void measure(const Frame &input);
+
+    private:
+        mutable std::mutex m_mutex;
+        std::uint64_t m_sequence;
+        double m_min;
+        double m_max;
+        double m_mean;
+    };
+
+    // Stage from a library implementing ProkyonStageApi.h.
+    class PluginStage : public Stage {
+    public:
+        PluginStage(const std::string &path, const std::string &config); // throws PipelineException
+        ~PluginStage();
+        PluginStage(const PluginStage &) = delete;
+        PluginStage &operator=(const PluginStage &) = delete;
+
+        std::string get_name() const override;
+        FrameLayout get_output_layout(const FrameLayout &input) const override;
+        bool is_in_place() const override;
+        bool is_ordered() const override;
+        void process(const Frame &input, Frame &output) override;
+
+    private:
+        static ProkyonFrameLayout to_c(const FrameLayout &layout);
+
+    private:
+        void *m_library;
+        const ProkyonStageApi *m_p_api;
+        void *m_p_instance;
+    };
+
+    // stages from a spec like "bin 2; statistics; plugin C:\stages\flat.dll gain.tif", empty for none
+    std::vector<std::shared_ptr<Stage>> make_stages(const std::string &spec); // throws PipelineException
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "PresetStore.h"
+#include "UserDirectory.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace Prokyon {
+    PresetStore::PresetStore(const std::string &guid) :
+        m_guid{guid}
+    {}
+
+    bool PresetStore::save(const std::string &name, const Values &values) const {
+        const auto path = get_path(name);
+        if (path.empty() || !UserDirectory::make(get_directory())) { return false; }
+
+        // written aside and renamed, as the catalogue
+        const auto temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            if (!out) { return false; }
+            out << M_S_MAGIC << "\n";
+            // names hold no tabs, values no line breaks
+            for (const auto &value : values) {
+                out << value.first << "\t" << value.second << "\n";
+            }
+            if (!out) {
+                out.close();
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool PresetStore::load(const std::string &name, Values &values) const {
+        values.clear();
+        const auto path = get_path(name);
+        if (path.empty()) { return false; }
+        std::ifstream in(path);
+        if (!in) { return false; }
+
+        std::string line;
+        if (!std::getline(in, line) || line != M_S_MAGIC) { return false; }
+        while (std::getline(in, line)) {
+            if (line.empty()) { continue; }
+            const auto tab = line.find('\t');
+            if (tab == std::string::npos || tab == 0) {
+                values.clear();
+                return false;
+            }
+            values[line.substr(0, tab)] = line.substr(tab + 1);
+        }
+        return true;
+    }
+
+    std::string PresetStore::get_path(const std::string &name) const {
+        const auto directory = get_directory();
+        if (directory.empty()) { return ""; }
+        return directory + "/" + UserDirectory::sanitize(name) + ".txt";
+    }
+
+    // private
+    std::string PresetStore::get_directory() const {
+        const auto directory = UserDirectory::get_path();
+        if (directory.empty()) { return ""; }
+        return directory + "/presets-" + UserDirectory::sanitize(m_guid);
+    }
+
+    const std::string PresetStore::M_S_MAGIC{"prokyon preset 1"};
+}
\ No newline at end of file
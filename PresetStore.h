@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef PROKYON_PRESET_STORE_H_
+#define PROKYON_PRESET_STORE_H_
+
+#include <map>
+#include <string>
+
+namespace Prokyon {
+    // Named snapshots of parameter values, one file per preset in the user directory of the adapter.
+    class PresetStore {
+    public:
+        using Values = std::map<std::string, std::string>; // property name to value
+
+        PresetStore(const std::string &guid);
+
+        bool save(const std::string &name, const Values &values) const; // returns success
+        bool load(const std::string &name, Values &values) const; // returns success, fails for a missing or damaged file
+        std::string get_path(const std::string &name) const; // empty if the user directory is unknown
+
+    private:
+        std::string get_directory() const;
+
+    private:
+        std::string m_guid;
+
+        static const std::string M_S_MAGIC;
+    };
+}
+
+#endif
\ No newline at end of file
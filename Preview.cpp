@@ -0,0 +1,232 @@
+#include "Preview.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <sstream>
+
+namespace Prokyon {
+    Preview::Preview() :
+        m_decimation{M_S_DECIMATION_DEFAULT},
+        m_auto_scale{false},
+        m_max_rate_hz{M_S_MAX_RATE_HZ_DEFAULT},
+        m_decimation_frame{1},
+        m_width{0},
+        m_components{0},
+        m_bits_per_component{0},
+        m_rows_in_block{0},
+        m_out_width{0},
+        m_out_height{0},
+        m_out_row{0},
+        m_row_sums{},
+        m_staging{},
+        m_last_frame{},
+        m_active{false},
+        m_sequence{0},
+        m_mutex{},
+        m_p_front{nullptr},
+        m_p_back{nullptr}
+    {}
+
+    unsigned Preview::get_decimation() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_decimation;
+    }
+
+    void Preview::set_decimation(unsigned factor) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_decimation = (std::max)(1u, factor);
+    }
+
+    bool Preview::get_auto_scale() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_auto_scale;
+    }
+
+    void Preview::set_auto_scale(bool auto_scale) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_auto_scale = auto_scale;
+    }
+
+    double Preview::get_max_rate_hz() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_max_rate_hz;
+    }
+
+    void Preview::set_max_rate_hz(double rate_hz) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_rate_hz = rate_hz;
+    }
+
+    bool Preview::begin_frame(unsigned width, unsigned height, unsigned components, unsigned bits_per_component) {
+        assert(!m_active);
+        assert(bits_per_component == 8 || bits_per_component == 16);
+
+        unsigned decimation = 1;
+        double max_rate_hz = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            decimation = m_decimation;
+            max_rate_hz = m_max_rate_hz;
+        }
+        if (decimation <= 1) { return false; }
+
+        auto now = std::chrono::steady_clock::now();
+        if (0.0 < max_rate_hz && m_sequence != 0) {
+            std::chrono::duration<double> since_last = now - m_last_frame;
+            if (since_last.count() < 1.0 / max_rate_hz) { return false; }
+        }
+
+        m_out_width = width / decimation;
+        m_out_height = height / decimation;
+        if (m_out_width == 0 || m_out_height == 0) { return false; }
+
+        // decimation is only read here so a change mid frame cannot split a block
+        m_decimation_frame = decimation;
+        m_width = width;
+        m_components = components;
+        m_bits_per_component = bits_per_component;
+        m_rows_in_block = 0;
+        m_out_row = 0;
+        m_row_sums.assign(static_cast<std::size_t>(m_out_width) * m_components, 0u);
+        m_staging.resize(static_cast<std::size_t>(m_out_width) * m_out_height * m_components);
+        m_last_frame = now;
+        m_active = true;
+        return true;
+    }
+
+    unsigned Preview::get_strip_rows() const {
+        return m_decimation_frame;
+    }
+
+    void Preview::accumulate_rows(const unsigned char *p_rows, unsigned row_count) {
+        if (!m_active) { return; }
+        assert(p_rows != nullptr);
+
+        const auto row_bytes = static_cast<std::size_t>(m_width) * m_components * (m_bits_per_component / 8u);
+        for (unsigned r = 0; r < row_count && m_out_row < m_out_height; ++r) {
+            auto p_row = p_rows + r * row_bytes;
+            if (m_bits_per_component == 8) {
+                accumulate_row(p_row);
+            }
+            else {
+                accumulate_row(reinterpret_cast<const std::uint16_t *>(p_row));
+            }
+            ++m_rows_in_block;
+            if (m_rows_in_block == m_decimation_frame) {
+                flush_block_row();
+            }
+        }
+    }
+
+    bool Preview::end_frame() {
+        if (!m_active) { return false; }
+        m_active = false;
+        if (m_out_row < m_out_height) {
+            // short frame, do not publish a partially written preview
+            return false;
+        }
+        publish();
+        return true;
+    }
+
+    std::shared_ptr<const PreviewFrame> Preview::get_frame() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_p_front;
+    }
+
+    std::string Preview::to_string() const {
+        auto p_frame = get_frame();
+        std::stringstream ss;
+        ss << "Preview information:\n";
+        ss << "  address: " << this << "\n";
+        ss << "  decimation: " << get_decimation() << "\n";
+        ss << "  auto scale: " << get_auto_scale() << "\n";
+        ss << "  max rate (Hz): " << get_max_rate_hz() << "\n";
+        if (p_frame != nullptr) {
+            ss << "  size (px): " << p_frame->width << ", " << p_frame->height << "\n";
+            ss << "  bit depth: " << p_frame->bits_per_component << "\n";
+            ss << "  sequence: " << p_frame->sequence << "\n";
+        }
+        return ss.str();
+    }
+
+    // private
+    template<typename T>
+    void Preview::accumulate_row(const T *p_row) {
+        auto p_sum = m_row_sums.data();
+        auto p = p_row;
+        for (unsigned xo = 0; xo < m_out_width; ++xo) {
+            for (unsigned d = 0; d < m_decimation_frame; ++d) {
+                for (unsigned c = 0; c < m_components; ++c) {
+                    p_sum[c] += p[c];
+                }
+                p += m_components;
+            }
+            p_sum += m_components;
+        }
+    }
+
+    void Preview::flush_block_row() {
+        const auto divisor = m_decimation_frame * m_decimation_frame;
+        const auto count = m_row_sums.size();
+        auto p_out = m_staging.data() + m_out_row * count;
+        for (std::size_t i = 0; i < count; ++i) {
+            p_out[i] = static_cast<std::uint16_t>((m_row_sums[i] + divisor / 2u) / divisor);
+        }
+        std::fill(m_row_sums.begin(), m_row_sums.end(), 0u);
+        m_rows_in_block = 0;
+        ++m_out_row;
+    }
+
+    void Preview::publish() {
+        // reuse the back buffer unless a reader still holds it from an earlier swap
+        if (m_p_back == nullptr || 1 < m_p_back.use_count()) {
+            m_p_back = std::make_shared<PreviewFrame>();
+        }
+
+        auto auto_scale = get_auto_scale();
+        auto &frame = *m_p_back;
+        frame.width = m_out_width;
+        frame.height = m_out_height;
+        frame.components = m_components;
+        frame.bits_per_component = auto_scale ? 8u : m_bits_per_component;
+        frame.sequence = ++m_sequence;
+
+        const auto count = m_staging.size();
+        frame.data.resize(count * (frame.bits_per_component / 8u));
+        if (auto_scale) {
+            // alpha is excluded from the range and stays opaque
+            const auto color_components = (m_components == 4) ? 3u : m_components;
+            std::uint16_t lo = 0xffffu;
+            std::uint16_t hi = 0u;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (i % m_components < color_components) {
+                    lo = (std::min)(lo, m_staging[i]);
+                    hi = (std::max)(hi, m_staging[i]);
+                }
+            }
+            const unsigned span = (hi > lo) ? static_cast<unsigned>(hi - lo) : 1u;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (i % m_components < color_components) {
+                    auto v = (m_staging[i] > lo) ? static_cast<unsigned>(m_staging[i] - lo) : 0u;
+                    frame.data[i] = static_cast<unsigned char>((v * 255u + span / 2u) / span);
+                }
+                else {
+                    frame.data[i] = 0xffu;
+                }
+            }
+        }
+        else if (m_bits_per_component == 8) {
+            std::transform(m_staging.cbegin(), m_staging.cend(), frame.data.begin(), [](std::uint16_t v) { return static_cast<unsigned char>(v); });
+        }
+        else {
+            std::memcpy(frame.data.data(), m_staging.data(), frame.data.size());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(m_p_front, m_p_back);
+    }
+
+    const double Preview::M_S_MAX_RATE_HZ_DEFAULT = 15.0;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef PROKYON_PREVIEW_H_
+#define PROKYON_PREVIEW_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    struct PreviewFrame {
+        std::vector<unsigned char> data;
+        unsigned width;
+        unsigned height;
+        unsigned components;
+        unsigned bits_per_component;
+        unsigned long long sequence;
+    };
+
+    // Block averaged, rate limited copy of the converted image.
+    // Fed strip by strip from Image::copy_image_data while the converted rows are still in cache,
+    // so readers of the preview never touch full resolution buffers.
+    class Preview {
+    public:
+        Preview();
+
+        unsigned get_decimation() const;
+        void set_decimation(unsigned factor); // 1 disables preview
+        bool get_auto_scale() const;
+        void set_auto_scale(bool auto_scale); // scale each preview frame to its own 8 bit range
+        double get_max_rate_hz() const;
+        void set_max_rate_hz(double rate_hz);
+
+        // conversion side, returns true if this frame should feed the preview
+        bool begin_frame(unsigned width, unsigned height, unsigned components, unsigned bits_per_component);
+        unsigned get_strip_rows() const; // rows per block of the current frame
+        void accumulate_rows(const unsigned char *p_rows, unsigned row_count);
+        bool end_frame(); // returns if a new preview frame is out
+
+        // reader side, latest complete preview frame or nullptr
+        std::shared_ptr<const PreviewFrame> get_frame() const;
+
+        std::string to_string() const;
+
+    private:
+        template<typename T>
+        void accumulate_row(const T *p_row);
+        void flush_block_row();
+        void publish();
+
+    private:
+        unsigned m_decimation;
+        bool m_auto_scale;
+        double m_max_rate_hz;
+
+        // current frame
+        unsigned m_decimation_frame;
+        unsigned m_width;
+        unsigned m_components;
+        unsigned m_bits_per_component;
+        unsigned m_rows_in_block;
+        unsigned m_out_width;
+        unsigned m_out_height;
+        unsigned m_out_row;
+        std::vector<std::uint32_t> m_row_sums;
+        std::vector<std::uint16_t> m_staging;
+        std::chrono::steady_clock::time_point m_last_frame;
+        bool m_active;
+        unsigned long long m_sequence;
+
+        mutable std::mutex m_mutex;
+        std::shared_ptr<PreviewFrame> m_p_front;
+        std::shared_ptr<PreviewFrame> m_p_back;
+
+        static const unsigned M_S_DECIMATION_DEFAULT = 1u;
+        static const double M_S_MAX_RATE_HZ_DEFAULT;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -1,12 +1,15 @@
 #define NOMINMAX
 
 #include "ProkyonCamera.h"
+#include "ProkyonFocus.h"
 
 #include "Image.h"
 #include "AcquisitionParameters.h"
 #include "RegionOfInterest.h"
 #include "Camera.h"
+#include "SdkThread.h"
 
+#include "MMDevice/ImageMetadata.h"
 #include "MMDevice/ModuleInterface.h"
 #include "MMDevice/MMDeviceConstants.h"
 #include "dijsdk.h"
@@ -14,23 +17,23 @@
 #include "parameterif.h"
 
 #include <cassert>
+#include <cmath>
+#include <chrono>
 #include <sstream>
 #include <string>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <limits>
 #include <algorithm> // debug
 
-// TODO
-// Need to fix a few errors:
-//  (1) document crash when trying to change color mode while live (shouldn't happen??)
-
 // ModuleInterface.h
 // Required for initialization and DLL export
 
 MODULE_API void InitializeModuleData() {
     RegisterDevice(Prokyon::ProkyonCamera::get_name(), MM::CameraDevice, Prokyon::ProkyonCamera::get_description());
+    RegisterDevice(Prokyon::ProkyonFocus::get_name(), MM::StageDevice, Prokyon::ProkyonFocus::get_description());
 }
 
 MODULE_API MM::Device *CreateDevice(const char *name) {
@@ -40,6 +43,9 @@ MODULE_API MM::Device *CreateDevice(const char *name) {
     else if (std::string{name} == Prokyon::ProkyonCamera::get_name()) {
         return new Prokyon::ProkyonCamera{};
     }
+    else if (std::string{name} == Prokyon::ProkyonFocus::get_name()) {
+        return new Prokyon::ProkyonFocus{};
+    }
     else {
         return nullptr;
     }
@@ -50,17 +56,76 @@ MODULE_API void DeleteDevice(MM::Device *pDevice) {
 }
 
 namespace Prokyon {
+    namespace {
+        // one camera per module, see ProkyonCamera::get_instance
+        std::mutex instance_mutex;
+        ProkyonCamera *p_instance = nullptr;
+    }
+
     // DeviceBase
     ProkyonCamera::ProkyonCamera() : CCameraBase<ProkyonCamera>(),
         m_p_camera{std::make_unique<Camera>()},
+        m_p_pool{nullptr},
         m_p_image{nullptr},
         m_p_acq_parameters{nullptr},
         m_p_roi{nullptr},
-        m_discrete_set_properties{}
+        m_p_catalogue{nullptr},
+        m_image_mode_name{},
+        m_image_mode{0, {0, 0}, {1, 1}, {1, 1}, {1, 1}, {0, 0}, {1.0, 1.0}, 0},
+        m_p_presets{nullptr},
+        m_last_preset_switch{},
+        m_p_exposure{nullptr},
+        m_p_transaction{nullptr},
+        m_last_transaction{},
+        m_init_thread{},
+        m_init_cancel{false},
+        m_init_complete{false},
+        m_init_mutex{},
+        m_init_done{},
+        m_pending_properties{},
+        m_init_status{},
+        m_shadow{},
+        m_exposure_writes{0},
+        m_poll_thread{},
+        m_poll_cancel{false},
+        m_poll_mutex{},
+        m_poll_cv{},
+        m_p_characterization{nullptr},
+        m_characterization_settings(SensorCharacterization::default_settings()),
+        m_p_focus_drive{nullptr},
+        m_p_autofocus{nullptr},
+        m_publisher_settings(FramePublisher::default_settings()),
+        m_publisher_enabled{false},
+        m_p_convert_stage{nullptr},
+        m_p_observe_stage{nullptr},
+        m_user_stages{},
+        m_pipeline_spec{},
+        m_pipeline_workers{2},
+        m_pipeline_depth{4},
+        m_p_pipeline{nullptr},
+        m_p_snap_pipeline{nullptr},
+        m_snap_frame{FrameLayout{0, 0, 0, 0, 0, 0}, nullptr, 0, FrameStamp{-1, 0}},
+        m_p_capture{nullptr},
+        m_p_coalescer{nullptr},
+        m_stop_on_overflow{false},
+        m_reconfiguring{false},
+        m_last_reconfiguration{},
+        m_metadata_mutex{},
+        m_frame_metadata{},
+        m_counter_key{},
+        m_transaction_first_key{},
+        m_channel_names{},
+        m_capture_cores{},
+        m_worker_cores{},
+        m_raise_thread_priority{false},
+        m_memory_options(FrameBuffer::default_options()),
+        m_memory_budget{BufferPool::M_S_BUDGET_DEFAULT},
+        m_sdk_properties(ParameterRegistry::size())
     {}
 
     int ProkyonCamera::Initialize() {
         LogMessage("initializing");
+        const auto t0 = std::chrono::steady_clock::now();
         auto status = m_p_camera->initialize(&M_S_KEY, M_S_CAMERA_NAME, M_S_CAMERA_DESCRIPTION, 0);
         int out = DEVICE_ERR;
         switch (status) {
@@ -68,8 +133,19 @@ namespace Prokyon {
             {
                 LogMessage(m_p_camera->to_string());
 
+                m_p_catalogue = std::make_unique<ModeCatalogue>(m_p_camera->get_guid(), Camera::get_sdk_version());
+                LogMessage(m_p_catalogue->load() ? "mode catalogue loaded from " + m_p_catalogue->get_path() : "no mode catalogue for this camera and sdk");
+                m_p_presets = std::make_unique<PresetStore>(m_p_camera->get_guid());
+
                 LogMessage("creating image buffer");
-                m_p_image = std::make_unique<Image>(m_p_camera.get());
+                m_p_pool = std::make_unique<BufferPool>(m_memory_options, m_memory_budget);
+                m_p_image = std::make_unique<Image>(m_p_camera.get(), m_p_pool.get());
+                if (!m_p_image->update()) {
+                    LogMessage("could not size image buffer");
+                }
+                if (!m_p_image->has_supported_format()) {
+                    LogMessage("the camera outputs raw bayer, which is not converted, set an RGB or gray " + M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME);
+                }
                 try { LogMessage(m_p_image->to_string()); }
                 catch (ImageException) {
                     LogMessage("exception creating image object");
@@ -83,45 +159,76 @@ namespace Prokyon {
                     LogMessage("exception creating roi object");
                     return DEVICE_ERR;
                 }
+                m_p_image->set_region_of_interest(m_p_roi.get());
+                if (!m_p_image->update()) {
+                    LogMessage("could not size image buffer for the roi");
+                }
 
                 LogMessage("creating acquisition parameters");
                 m_p_acq_parameters = std::make_unique<AcquisitionParameters>(m_p_camera.get());
+                m_p_exposure = std::make_unique<NumericProperty>(*m_p_camera, ParameterIdImageCaptureExposureTimeUsec);
+                m_p_transaction = std::make_unique<Transaction>(Transaction::Keys{M_S_PRESET_ROI_KEY, M_S_PRESET_EXPOSURE_KEY, M_S_SUB_REGIONS_NAME, {M_S_IMAGE_MODE_NAME, M_S_BINNING_NAME}},
+                    make_transaction_hooks(), m_p_roi.get(), m_p_exposure.get());
                 try { LogMessage("initialized!"); }
                 catch (AcquisitionParametersException) {
                     LogMessage("exception creating acquisition parameters object");
                     return DEVICE_ERR;
                 }
 
+                m_p_characterization = std::make_unique<SensorCharacterization>(m_p_image.get(), m_p_acq_parameters.get());
+                m_p_focus_drive = std::make_unique<FocusDrive>(m_p_camera.get());
+                m_p_autofocus = std::make_unique<Autofocus>(m_p_image.get(), m_p_focus_drive.get());
+                m_p_convert_stage = std::make_shared<ConvertStage>(m_p_image.get());
+                m_p_observe_stage = std::make_shared<ObserveStage>(m_p_image.get());
+                m_p_pipeline = std::make_unique<Pipeline>(m_p_pool.get());
+                m_p_snap_pipeline = std::make_unique<Pipeline>(m_p_pool.get());
+                m_p_capture = std::make_unique<Capture>(m_p_camera.get(), m_p_pipeline.get());
+                m_p_coalescer = std::make_unique<ParameterCoalescer>(m_p_camera.get(), [this](DijSDK_EParamId id, bool success) { on_coalesced_write(id, success); });
+
                 // TODO error handling for setup of props
                 LogMessage("setting properties");
 
                 // special cases
                 setup_image_mode_property();
-
-                // read write
-                setup_numeric_property(ParameterIdImageCaptureGain, "ParameterIdImageCaptureGain", "Image Capture-Gain Target");
-                setup_numeric_property(ParameterIdImageProcessingGammaCorrection, "ParameterIdImageProcessingGammaCorrection", "Image Processing-Gamma");
-                setup_numeric_property(ParameterIdImageProcessingContrast, "ParameterIdImageProcessingContrast", "Image Processing-Contrast");
-                setup_numeric_property(ParameterIdImageProcessingSharpness, "ParameterIdImageProcessingSharpness", "Image Processing-Sharpness");
-                setup_bool_property(ParameterIdImageProcessingHighDynamicRange, "ParameterIdImageProcessingHighDynamicRange", "Image Processing-HDR-Enabled");
-                setup_numeric_property(ParameterIdImageProcessingHdrWeight, "ParameterIdImageProcessingHdrWeight", "Image Processing-HDR-Weight");
-                setup_numeric_property(ParameterIdImageProcessingHdrColorGamma, "ParameterIdImageProcessingHdrColorGamma", "Image Processing-HDR-Gamma");
-                setup_numeric_property(ParameterIdImageProcessingHdrSmoothFieldSize, "ParameterIdImageProcessingHdrSmoothFieldSize", "Image Processing-HDR-Smooth Field Size");
-                setup_numeric_property(ParameterIdImageProcessingColorBalance, "ParameterIdImageProcessingColorBalance", "Image Processing-HDR-Color Balance");
-                setup_bool_property(ParameterIdImageProcessingColorBalKeepBrightness, "ParameterIdImageProcessingColorBalKeepBrightness", "Image Processing-HDR-Color Balance-Keep Brightness?");
-                setup_numeric_property(ParameterIdImageProcessingSaturation, "ParameterIdImageProcessingSaturation", "Image Processing-Saturation");
-
-                // read only
-                setup_numeric_property(ParameterIdSensorSize, "ParameterIdSensorSize", "Sensor-Size (px)");
-                setup_numeric_property(ParameterIdSensorPixelSizeUm, "ParameterIdSensorPixelSizeUm", "Sensor-Pixel Size (um)");
-                setup_numeric_property(ParameterIdImageModeSubsampling, "ParameterIdImageModeSubsampling", "Image Mode-Subsampling Bin Size (px)");
-                setup_numeric_property(ParameterIdImageModeAveraging, "ParameterIdImageModeAveraging", M_S_BINNING_NAME);
-                setup_numeric_property(ParameterIdImageModeSumming, "ParameterIdImageModeSumming", "Image Mode-Summing Bin Size (px)");
-                setup_string_property(ParameterIdGlobalSettingsCameraName, "ParameterIdGlobalSettingsCameraName", "Global-Camera Name");
-                // TODO better error checking
-                //setup_string_property(ParameterIdGlobalSettingsCameraSerialNumber, "ParameterIdGlobalSettingsCameraSerialNumber", "Global-Camera Serial Number");
+                setup_output_properties();
+                setup_preview_properties();
+                setup_sub_regions_property();
+                setup_characterization_properties();
+                setup_focus_metric_properties();
+                setup_publisher_properties();
+                setup_pipeline_properties();
+                setup_thread_properties();
+                setup_memory_properties();
+                setup_sequence_properties();
+                setup_preset_properties();
+                setup_coalescing_properties();
+                setup_transaction_properties();
+
+                // essential for snapping, binning is a standard core property
+                setup_binning_property();
+
+                // the other sdk properties follow in the background, see adopt_deferred_properties
+                {
+                    std::stringstream ss;
+                    ss << "essential in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() << " ms";
+                    ss << ", image modes " << (m_p_catalogue->is_loaded() ? "from catalogue" : "listed from camera");
+                    LogMessage(ss.str());
+                    std::lock_guard<std::mutex> lock(m_init_mutex);
+                    m_init_status = ss.str();
+                }
+                setup_initialization_property();
+                m_init_cancel = false;
+                m_init_complete = false;
+                m_init_thread = std::thread(&ProkyonCamera::initialize_deferred, this, t0);
+                m_shadow.clear();
+                m_poll_cancel = false;
+                m_poll_thread = std::thread(&ProkyonCamera::poll_parameters, this);
 
                 this->UpdateStatus();
+                {
+                    std::lock_guard<std::mutex> lock(instance_mutex);
+                    p_instance = this;
+                }
                 LogMessage("done");
 
                 out = DEVICE_OK;
@@ -148,14 +255,60 @@ namespace Prokyon {
 
     int ProkyonCamera::Shutdown() {
         LogMessage("shutting down");
+        if (m_init_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_init_mutex);
+                m_init_cancel = true;
+            }
+            m_init_done.notify_all();
+            m_init_thread.join();
+        }
+        stop_polling();
+        {
+            std::lock_guard<std::mutex> lock(m_init_mutex);
+            m_pending_properties.clear();
+        }
+        if (m_p_capture != nullptr) {
+            m_p_capture->stop();
+        }
+        // writes what is still pending, the coalescer stays for a camera that did not shut down
+        if (m_p_coalescer != nullptr) {
+            m_p_coalescer->flush();
+        }
         auto status = m_p_camera->shutdown();
         int out = DEVICE_ERR;
         switch (status) {
             case Camera::Status::state_changed:
             {
+                {
+                    std::lock_guard<std::mutex> lock(instance_mutex);
+                    if (p_instance == this) {
+                        p_instance = nullptr;
+                    }
+                }
+                m_p_capture.reset(nullptr);
+                m_p_coalescer.reset(nullptr);
+                m_p_pipeline.reset(nullptr);
+                m_p_snap_pipeline.reset(nullptr);
+                m_snap_frame.p_data = nullptr;
+                m_user_stages.clear();
+                m_p_convert_stage.reset();
+                m_p_observe_stage.reset();
+                m_p_autofocus.reset(nullptr);
+                m_p_focus_drive.reset(nullptr);
+                m_p_characterization.reset(nullptr);
                 m_p_acq_parameters.reset(nullptr);
+                m_p_transaction.reset(nullptr);
+                m_p_exposure.reset(nullptr);
+                if (m_p_image != nullptr) {
+                    m_p_image->set_region_of_interest(nullptr);
+                }
                 m_p_roi.reset(nullptr);
+                m_p_catalogue.reset(nullptr);
+                m_image_mode_name.clear();
+                m_p_presets.reset(nullptr);
                 m_p_image.reset(nullptr);
+                m_p_pool.reset(nullptr);
                 out = DEVICE_OK;
                 break;
             }
@@ -181,6 +334,7 @@ namespace Prokyon {
     }
 
     int ProkyonCamera::GetProperty(const char *name, char *value) const {
+        adopt_deferred_properties_for(name);
         auto ret = CCameraBase<ProkyonCamera>::GetProperty(name, value);
         if (ret == DEVICE_ERR) {
             std::stringstream ss;
@@ -193,14 +347,12 @@ namespace Prokyon {
     }
 
     int ProkyonCamera::SetProperty(const char *name, const char *value) {
-        // TODO FIGURE OUT A WAY TO REVERT TO OLD PROPERTY IF BINNING
-        int ret = DEVICE_ERR;
-        if (std::string{name} == M_S_BINNING_NAME) {
-            // noop
-        }
-        else {
-            ret = CCameraBase<ProkyonCamera>::SetProperty(name, value);
+        // applied together by commit_transaction
+        if (is_transaction_open() && M_S_TRANSACTION_EXCLUDED.count(name) == 0) {
+            return stage_transaction_value(name, value);
         }
+        adopt_deferred_properties_for(name);
+        auto ret = CCameraBase<ProkyonCamera>::SetProperty(name, value);
 
         if (ret == DEVICE_ERR) {
             std::stringstream ss;
@@ -212,9 +364,22 @@ namespace Prokyon {
         return ret;
     }
 
+    bool ProkyonCamera::HasProperty(const char *name) const {
+        adopt_deferred_properties_for(name);
+        return CCameraBase<ProkyonCamera>::HasProperty(name);
+    }
+
+    unsigned ProkyonCamera::GetNumberOfProperties() const {
+        // the core lists by index from here on, adopting later would shift the indices under it
+        const_cast<ProkyonCamera *>(this)->adopt_deferred_properties(false);
+        return CCameraBase<ProkyonCamera>::GetNumberOfProperties();
+    }
+
     // CameraBase
     int ProkyonCamera::SnapImage() {
         //LogMessage("snapping image");
+        // the snap shows the values last set
+        m_p_coalescer->flush();
         auto success = m_p_image->acquire();
         if (!success) {
             return DEVICE_ERR;
@@ -222,23 +387,78 @@ namespace Prokyon {
         else {
             //LogMessage(m_p_image->to_string());
         }
+        if (!m_user_stages.empty()) {
+            try {
+                m_snap_frame = m_p_snap_pipeline->process(Frame{m_p_image->get_layout(), const_cast<unsigned char *>(m_p_image->get_image_buffer()), 0, FrameStamp{-1, 0}});
+            }
+            catch (PipelineException) {
+                LogMessage("exception processing snapped image");
+                m_snap_frame.p_data = nullptr;
+                return DEVICE_ERR;
+            }
+        }
         return DEVICE_OK;
     }
 
     const unsigned char *ProkyonCamera::GetImageBuffer() {
         //LogMessage("getting image buffer");
         if (m_p_image != nullptr) {
-            return m_p_image->get_image_buffer();
+            return get_output_buffer(0);
         }
         else {
             return nullptr;
         }
     }
 
+    const unsigned char *ProkyonCamera::GetImageBuffer(unsigned channel) {
+        if (m_p_image == nullptr || GetNumberOfChannels() <= channel) {
+            return nullptr;
+        }
+        return get_output_buffer(channel);
+    }
+
+    unsigned ProkyonCamera::GetNumberOfChannels() const {
+        if (m_p_image == nullptr) {
+            return 1;
+        }
+        return get_output_layout().channels;
+    }
+
+    int ProkyonCamera::GetChannelName(unsigned channel, char *name) {
+        if (m_p_image == nullptr) {
+            return DEVICE_NOT_CONNECTED;
+        }
+        if (GetNumberOfChannels() <= channel) {
+            return DEVICE_NONEXISTENT_CHANNEL;
+        }
+        if (m_p_image->get_number_of_channels() <= channel) {
+            // a user stage added planes
+            CDeviceUtils::CopyLimitedString(name, ("Channel " + std::to_string(channel)).c_str());
+            return DEVICE_OK;
+        }
+        CDeviceUtils::CopyLimitedString(name, m_p_image->get_channel_name(channel).c_str());
+        return DEVICE_OK;
+    }
+
+    int ProkyonCamera::InsertImage() {
+        // one image per sub region, tagged so the core can split them into channels
+        char label[MM::MaxStrLength];
+        this->GetLabel(label);
+        int ret = DEVICE_OK;
+        for (unsigned channel = 0; channel < GetNumberOfChannels() && ret == DEVICE_OK; ++channel) {
+            Metadata md;
+            md.put(MM::g_Keyword_Metadata_CameraLabel, label);
+            md.put(MM::g_Keyword_CameraChannelIndex, CDeviceUtils::ConvertToString(static_cast<long>(channel)));
+            md.put(MM::g_Keyword_CameraChannelName, m_p_image->get_channel_name(channel));
+            ret = GetCoreCallback()->InsertImage(this, GetImageBuffer(channel), GetImageWidth(), GetImageHeight(), GetImageBytesPerPixel(), md.Serialize().c_str());
+        }
+        return ret;
+    }
+
     unsigned ProkyonCamera::GetNumberOfComponents() const {
         //LogMessage("getting number of components");
         assert(m_p_image != nullptr);
-        return m_p_image->get_number_of_components();
+        return get_output_layout().components;
     }
 
     int ProkyonCamera::GetComponentName(unsigned component, char *name) {
@@ -264,7 +484,7 @@ namespace Prokyon {
             LogMessage("failed");
             return DEVICE_NOT_CONNECTED;
         }
-        return m_p_image->get_image_buffer_size();
+        return static_cast<long>(get_output_layout().plane_bytes());
     }
 
     unsigned ProkyonCamera::GetImageWidth() const {
@@ -274,7 +494,7 @@ namespace Prokyon {
             return DEVICE_NOT_CONNECTED;
         }
         else {
-            return m_p_image->get_image_width();
+            return get_output_layout().width;
         }
     }
 
@@ -285,7 +505,7 @@ namespace Prokyon {
             return DEVICE_NOT_CONNECTED;
         }
         else {
-            return m_p_image->get_image_height();
+            return get_output_layout().height;
         }
     }
 
@@ -296,7 +516,7 @@ namespace Prokyon {
             return DEVICE_NOT_CONNECTED;
         }
         else {
-            return m_p_image->get_image_bytes_per_pixel();
+            return static_cast<unsigned>(get_output_layout().bytes_per_px());
         }
     }
 
@@ -307,16 +527,22 @@ namespace Prokyon {
             return DEVICE_NOT_CONNECTED;
         }
         else {
-            return m_p_image->get_bit_depth();
+            return get_output_layout().bits_per_component;
         }
     }
 
     double ProkyonCamera::GetPixelSizeUm() const {
-        // TODO
-        return 1.0;
+        if (m_image_mode_name.empty()) {
+            LogMessage("unknown image mode getting pixel size");
+            return 1.0;
+        }
+        return m_image_mode.pixel_size_um[0];
     }
 
     int ProkyonCamera::GetBinning() const {
+        if (!m_image_mode_name.empty()) {
+            return m_image_mode.get_binning();
+        }
         int out = 1;
         if (m_p_acq_parameters == nullptr) { LogMessage("nullptr getting binning"); }
         else {
@@ -326,24 +552,59 @@ namespace Prokyon {
         return out;
     }
 
-    int ProkyonCamera::SetBinning(int) {
-        LogMessage("hardware forbids setting binning directly, ignoring request, see Image Mode property");
-        return DEVICE_OK;
+    int ProkyonCamera::SetBinning(int binSize) {
+        // the hardware bins by image mode only, the fastest mode of that binning stands in, unless the current one bins so
+        if (!m_image_mode_name.empty() && m_image_mode.get_binning() == binSize) {
+            return DEVICE_OK;
+        }
+        std::string name;
+        if (m_p_catalogue == nullptr || !m_p_catalogue->select_mode(binSize, name)) {
+            LogMessage("no image mode with binning " + std::to_string(binSize));
+            return DEVICE_INVALID_PROPERTY_VALUE;
+        }
+        LogMessage("binning " + std::to_string(binSize) + " by image mode " + name);
+        return this->SetProperty(M_S_IMAGE_MODE_NAME.c_str(), name.c_str());
     }
 
     void ProkyonCamera::SetExposure(double exp_ms) {
-        if (m_p_acq_parameters == nullptr) { LogMessage("nullptr setting exposure"); }
+        if (is_transaction_open()) {
+            stage_transaction_value(M_S_PRESET_EXPOSURE_KEY, std::to_string(exp_ms));
+        }
+        else if (m_p_acq_parameters == nullptr) { LogMessage("nullptr setting exposure"); }
         else {
-            try { m_p_acq_parameters->set_exposure_ms(exp_ms); }
-            catch (AcquisitionParametersException) { LogMessage("exception setting exposure"); }
+            // odd while the write is in flight, the poller drops what it read meanwhile
+            ++m_exposure_writes;
+            try {
+                auto set_ms = m_p_acq_parameters->set_exposure_ms(exp_ms);
+                m_shadow.store(ParameterIdImageCaptureExposureTimeUsec, ParameterShadow::Values{std::round(set_ms * 1000.0)});
+                ++m_exposure_writes;
+                // the core only knows the requested value
+                if (set_ms != exp_ms) {
+                    OnExposureChanged(set_ms);
+                }
+            }
+            catch (AcquisitionParametersException) {
+                ++m_exposure_writes;
+                LogMessage("exception setting exposure");
+            }
+            if (IsCapturing()) {
+                update_frame_metadata();
+            }
         }
     }
 
     double ProkyonCamera::GetExposure() const {
         double out = 0.0;
-        if (m_p_acq_parameters == nullptr) { LogMessage("nullptr getting exposure"); }
+        ParameterShadow::Values known;
+        if (m_shadow.find(ParameterIdImageCaptureExposureTimeUsec, known)) {
+            out = known.at(0) / 1000.0;
+        }
+        else if (m_p_acq_parameters == nullptr) { LogMessage("nullptr getting exposure"); }
         else {
-            try { out = m_p_acq_parameters->get_exposure_ms(); }
+            try {
+                out = m_p_acq_parameters->get_exposure_ms();
+                m_shadow.store(ParameterIdImageCaptureExposureTimeUsec, ParameterShadow::Values{std::round(out * 1000.0)});
+            }
             catch (AcquisitionParametersException) { LogMessage("exception getting exposure"); }
         }
         return out;
@@ -357,13 +618,19 @@ namespace Prokyon {
             LogMessage("nullptr setting roi");
             return DEVICE_NOT_CONNECTED;
         }
+        else if (is_transaction_open()) {
+            return stage_transaction_value(M_S_PRESET_ROI_KEY, regions_to_string({ROI{x, y, xSize, ySize}}));
+        }
         else {
-            try { m_p_roi->set({x, y, xSize, ySize}); }
-            catch (RegionOfInterestException) {
-                LogMessage("exception setting roi");
-                return DEVICE_CAN_NOT_SET_PROPERTY;
-            }
-            return DEVICE_OK;
+            return reconfigure("roi", [&]() {
+                clear_sub_regions();
+                try { m_p_roi->set({x, y, xSize, ySize}); }
+                catch (RegionOfInterestException) {
+                    LogMessage("exception setting roi");
+                    return DEVICE_CAN_NOT_SET_PROPERTY;
+                }
+                return m_p_image->update() ? DEVICE_OK : DEVICE_ERR;
+            });
         }
     }
 
@@ -389,13 +656,20 @@ namespace Prokyon {
             LogMessage("nullptr clearing roi");
             return DEVICE_NOT_CONNECTED;
         }
+        else if (is_transaction_open()) {
+            // empty for the full frame of the image mode the commit leaves, see set_preset_value
+            return stage_transaction_value(M_S_PRESET_ROI_KEY, "");
+        }
         else {
-            try { m_p_roi->clear(); }
-            catch (RegionOfInterestException) {
-                LogMessage("exception clearing roi");
-                return DEVICE_CAN_NOT_SET_PROPERTY;
-            }
-            return DEVICE_OK;
+            return reconfigure("roi", [&]() {
+                clear_sub_regions();
+                try { m_p_roi->clear(); }
+                catch (RegionOfInterestException) {
+                    LogMessage("exception clearing roi");
+                    return DEVICE_CAN_NOT_SET_PROPERTY;
+                }
+                return m_p_image->update() ? DEVICE_OK : DEVICE_ERR;
+            });
         }
     }
 
@@ -405,6 +679,159 @@ namespace Prokyon {
         return DEVICE_OK;
     }
 
+    int ProkyonCamera::StartSequenceAcquisition(long numImages, double, bool stopOnOverflow) {
+        if (m_p_image == nullptr) {
+            return DEVICE_NOT_CONNECTED;
+        }
+        if (IsCapturing()) {
+            return DEVICE_CAMERA_BUSY_ACQUIRING;
+        }
+
+        apply_thread_policies();
+        m_p_image->reset_conversion_statistics();
+        m_stop_on_overflow = stopOnOverflow;
+        auto ret = start_pipeline();
+        if (ret != DEVICE_OK) {
+            return ret;
+        }
+        const auto &raw = m_p_convert_stage->get_plan().raw;
+
+        ret = GetCoreCallback()->PrepareForAcq(this);
+        if (ret != DEVICE_OK) {
+            m_p_pipeline->stop();
+            return ret;
+        }
+
+        auto started = m_p_capture->start(raw.bytes(), numImages, [this](bool failed) {
+            // every frame already captured is still delivered
+            m_p_pipeline->stop();
+            if (failed) {
+                LogMessage("sequence acquisition failed");
+            }
+            GetCoreCallback()->AcqFinished(this, failed ? DEVICE_ERR : DEVICE_OK);
+        });
+        if (!started) {
+            m_p_pipeline->stop();
+            return DEVICE_CAMERA_BUSY_ACQUIRING;
+        }
+        return DEVICE_OK;
+    }
+
+    int ProkyonCamera::StartSequenceAcquisition(double interval_ms) {
+        return StartSequenceAcquisition(std::numeric_limits<long>::max(), interval_ms, false);
+    }
+
+    int ProkyonCamera::StopSequenceAcquisition() {
+        if (m_p_capture != nullptr) {
+            m_p_capture->stop();
+        }
+        return DEVICE_OK;
+    }
+
+    int ProkyonCamera::PrepareSequenceAcqusition() {
+        return DEVICE_OK;
+    }
+
+    bool ProkyonCamera::IsCapturing() {
+        return m_p_capture != nullptr && m_p_capture->is_running();
+    }
+
+    std::shared_ptr<const PreviewFrame> ProkyonCamera::get_preview_frame() const {
+        if (m_p_image == nullptr) {
+            return nullptr;
+        }
+        return m_p_image->get_preview().get_frame();
+    }
+
+    FocusDrive *ProkyonCamera::get_focus_drive() {
+        return m_p_focus_drive.get();
+    }
+
+    Autofocus *ProkyonCamera::get_autofocus() {
+        return m_p_autofocus.get();
+    }
+
+    int ProkyonCamera::run_autofocus(const Autofocus::Settings &settings) {
+        if (m_p_autofocus == nullptr) {
+            return DEVICE_NOT_CONNECTED;
+        }
+        if (IsCapturing()) {
+            return DEVICE_CAMERA_BUSY_ACQUIRING;
+        }
+        try {
+            auto result = m_p_autofocus->run(settings);
+            std::stringstream ss;
+            ss << "autofocus done at " << result.position << " after " << result.frames << " frames";
+            LogMessage(ss.str());
+        }
+        catch (FocusException) {
+            LogMessage("exception during autofocus");
+            return DEVICE_ERR;
+        }
+        return DEVICE_OK;
+    }
+
+    void ProkyonCamera::begin_transaction() {
+        if (m_p_transaction == nullptr) { return; }
+        const auto discarded = m_p_transaction->begin();
+        if (0 < discarded) {
+            LogMessage("discarding " + std::to_string(discarded) + " values of a transaction not committed");
+        }
+    }
+
+    int ProkyonCamera::stage_transaction_value(const std::string &key, const std::string &value) {
+        if (!is_transaction_open()) { return DEVICE_ERR; }
+        const auto check = m_p_transaction->stage(key, value);
+        if (check != Transaction::Check::ok) {
+            LogMessage("not staging " + key + " " + value + ", out of range or not settable");
+            return to_error_code(check);
+        }
+        return DEVICE_OK;
+    }
+
+    int ProkyonCamera::commit_transaction() {
+        if (!is_transaction_open()) { return DEVICE_ERR; }
+        if (m_p_transaction->get_staged_count() == 0) {
+            m_p_transaction->discard();
+            return DEVICE_OK;
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+
+        const auto number = m_p_transaction->get_number() + 1;
+        const auto count = m_p_transaction->get_ordered().size();
+        unsigned failed = 0;
+        // no frame is delivered before the pipeline starts again, the next one is the first with all values
+        auto ret = reconfigure("transaction " + std::to_string(number), [&]() {
+            failed = m_p_transaction->commit();
+            return DEVICE_OK;
+        });
+
+        std::stringstream ss;
+        ss << "transaction " << number << ": " << count << " values";
+        if (0 < failed) {
+            ss << ", " << failed << " failed";
+        }
+        ss << ", " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() << " ms";
+        m_last_transaction = ss.str();
+        LogMessage(m_last_transaction);
+        return (ret == DEVICE_OK && 0 < failed) ? DEVICE_ERR : ret;
+    }
+
+    void ProkyonCamera::discard_transaction() {
+        if (m_p_transaction != nullptr) {
+            m_p_transaction->discard();
+        }
+    }
+
+    bool ProkyonCamera::is_transaction_open() const {
+        return m_p_transaction != nullptr && m_p_transaction->is_open();
+    }
+
+    ProkyonCamera *ProkyonCamera::get_instance() {
+        std::lock_guard<std::mutex> lock(instance_mutex);
+        return p_instance;
+    }
+
     const char *ProkyonCamera::get_name() {
         return M_S_CAMERA_NAME.c_str();
     }
@@ -412,7 +839,7 @@ namespace Prokyon {
     const char *ProkyonCamera::get_description() {
         const unsigned int length = 128;
         char version[length];
-        auto result = DijSDK_GetVersion(version, length);
+        auto result = SdkThread::call([&]() { return DijSDK_GetVersion(version, length); });
 
         std::stringstream ss;
         ss << M_S_CAMERA_DESCRIPTION << std::endl;
@@ -423,34 +850,225 @@ namespace Prokyon {
     }
 
     // private
-    void ProkyonCamera::setup_numeric_property(DijSDK_EParamId id, std::string id_name, std::string display_name) {
-        auto p_property = std::make_unique<NumericProperty>(*m_p_camera, id);
-        if (!check_property(p_property.get(), id_name)) {
-            return;
+    void ProkyonCamera::setup_property(const PropertyDefinition &definition) {
+        PendingProperty pending;
+        if (query_property(definition, pending)) {
+            create_property(pending);
         }
-        auto p_callback = new CPropertyAction(this, &ProkyonCamera::update_numeric_property);
-        this->CreateStringProperty(display_name.c_str(), p_property->get_as_string().c_str(), !p_property->writeable(), p_callback, false);
-        m_numeric_properties[display_name] = std::move(p_property);
     }
 
-    void ProkyonCamera::setup_bool_property(DijSDK_EParamId id, std::string id_name, std::string display_name) {
-        auto p_property = std::make_unique<BoolProperty>(*m_p_camera, id);
-        if (!check_property(p_property.get(), id_name)) {
-            return;
+    bool ProkyonCamera::query_property(const PropertyDefinition &definition, PendingProperty &pending) const {
+        pending.definition = definition;
+        switch (definition.kind) {
+            case PropertyKind::numeric:
+            {
+                auto p_property = std::make_unique<NumericProperty>(*m_p_camera, definition.id);
+                if (!check_property(p_property.get(), definition.id_name)) {
+                    return false;
+                }
+                pending.value = p_property->get_as_string();
+                pending.read_only = !p_property->writeable();
+                pending.p_numeric = std::move(p_property);
+                break;
+            }
+            case PropertyKind::boolean:
+            {
+                auto p_property = std::make_unique<BoolProperty>(*m_p_camera, definition.id);
+                if (!check_property(p_property.get(), definition.id_name)) {
+                    return false;
+                }
+                pending.allowed_values = p_property->range();
+                pending.value = p_property->get();
+                pending.read_only = !p_property->writeable();
+                pending.p_bool = std::move(p_property);
+                break;
+            }
+            case PropertyKind::string:
+            {
+                auto p_property = std::make_unique<StringProperty>(*m_p_camera, definition.id);
+                if (!check_property(p_property.get(), definition.id_name)) {
+                    return false;
+                }
+                pending.value = p_property->get();
+                pending.read_only = !p_property->writeable();
+                pending.p_string = std::move(p_property);
+                break;
+            }
         }
-        this->CreatePropertyWithHandler(display_name.c_str(), p_property->range()[0].c_str(), MM::PropertyType::String, !p_property->writeable(), &ProkyonCamera::update_bool_property, false);
-        this->SetAllowedValues(display_name.c_str(), p_property->range());
-        m_bool_properties[display_name] = std::move(p_property);
+        return true;
     }
 
-    void ProkyonCamera::setup_string_property(DijSDK_EParamId id, std::string id_name, std::string display_name) {
-        auto p_property = std::make_unique<StringProperty>(*m_p_camera, id);
-        if (!check_property(p_property.get(), id_name)) {
-            return;
+    void ProkyonCamera::create_property(PendingProperty &pending) {
+        const auto &name = pending.definition.display_name;
+        const auto index = ParameterRegistry::find(pending.definition.id);
+        assert(index < m_sdk_properties.size());
+        auto &property = m_sdk_properties[index];
+        property.name = name;
+        switch (pending.definition.kind) {
+            case PropertyKind::numeric:
+            {
+                auto p_callback = new CPropertyActionEx(this, &ProkyonCamera::update_numeric_property, static_cast<long>(index));
+                this->CreateStringProperty(name.c_str(), pending.value.c_str(), pending.read_only, p_callback, false);
+                property.p_numeric = std::move(pending.p_numeric);
+                break;
+            }
+            case PropertyKind::boolean:
+            {
+                auto p_callback = new CPropertyActionEx(this, &ProkyonCamera::update_bool_property, static_cast<long>(index));
+                this->CreateStringProperty(name.c_str(), pending.value.c_str(), pending.read_only, p_callback, false);
+                this->SetAllowedValues(name.c_str(), pending.allowed_values);
+                property.p_bool = std::move(pending.p_bool);
+                break;
+            }
+            case PropertyKind::string:
+            {
+                auto p_callback = new CPropertyActionEx(this, &ProkyonCamera::update_string_property, static_cast<long>(index));
+                this->CreateStringProperty(name.c_str(), pending.value.c_str(), pending.read_only, p_callback, false);
+                property.p_string = std::move(pending.p_string);
+                break;
+            }
+        }
+    }
+
+    std::vector<ProkyonCamera::PropertyDefinition> ProkyonCamera::make_deferred_properties() {
+        // every parameter the camera documents as readable, whether the connected one has it is checked on query
+        std::vector<PropertyDefinition> definitions;
+        for (std::size_t i = 0; i < ParameterRegistry::size(); ++i) {
+            const auto &entry = ParameterRegistry::at(i);
+            if (!entry.readable || M_S_UNLISTED_PARAMETERS.count(entry.id)) {
+                continue;
+            }
+            auto kind = PropertyKind::numeric;
+            if (entry.type == PropertyBase::Type::Bool) {
+                kind = PropertyKind::boolean;
+            }
+            else if (entry.type == PropertyBase::Type::String) {
+                kind = PropertyKind::string;
+            }
+            auto it = M_S_DISPLAY_NAMES.find(entry.id);
+            definitions.push_back(PropertyDefinition{kind, entry.id, entry.id_name, (it == M_S_DISPLAY_NAMES.cend()) ? entry.display_name : it->second});
+        }
+        return definitions;
+    }
+
+    void ProkyonCamera::initialize_deferred(std::chrono::steady_clock::time_point t0) {
+        for (const auto &definition : M_S_DEFERRED_PROPERTIES) {
+            if (m_init_cancel) { return; }
+            PendingProperty pending;
+            try {
+                if (!query_property(definition, pending)) {
+                    continue;
+                }
+            }
+            catch (PropertyException) {
+                LogMessage("exception querying " + definition.id_name);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_init_mutex);
+            m_pending_properties.push_back(std::move(pending));
+        }
+
+        // specifications found meanwhile go into the catalogue as well
+        if (!m_p_catalogue->save()) {
+            LogMessage("could not save mode catalogue");
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_init_mutex);
+            std::stringstream ss;
+            ss << m_init_status << ", all in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() << " ms";
+            m_init_status = ss.str();
+            LogMessage("initialization complete, " + m_init_status);
+            m_init_complete = true;
+        }
+        m_init_done.notify_all();
+        // the core lists the properties again, which creates the pending ones on its thread
+        OnPropertiesChanged();
+    }
+
+    bool ProkyonCamera::adopt_deferred_properties(bool wait) {
+        // before Initialize started the thread, after Shutdown joined it, or a callback of the core on the thread itself
+        if (!m_init_thread.joinable() || std::this_thread::get_id() == m_init_thread.get_id()) { return false; }
+        std::vector<PendingProperty> pending;
+        {
+            std::unique_lock<std::mutex> lock(m_init_mutex);
+            if (wait) {
+                m_init_done.wait(lock, [this]() { return m_init_complete || m_init_cancel; });
+            }
+            if (!m_init_complete || m_pending_properties.empty()) { return false; }
+            pending.swap(m_pending_properties);
+        }
+        for (auto &p : pending) {
+            create_property(p);
+        }
+        // a listing of the core in progress is stale now, so it is told to list again
+        OnPropertiesChanged();
+        return true;
+    }
+
+    void ProkyonCamera::adopt_deferred_properties_for(const char *name) const {
+        // the core asks through const accessors, the deferred properties are all these create
+        const_cast<ProkyonCamera *>(this)->adopt_deferred_properties(!CCameraBase<ProkyonCamera>::HasProperty(name));
+    }
+
+    void ProkyonCamera::poll_parameters() {
+        // only parameters the camera may change on its own, read without the property maps the core thread creates
+        // not shadowed yet means the core has not asked for it, so it has nothing to be notified of
+        auto poll_exposure = [this]() {
+            ParameterShadow::Values known;
+            if (!m_shadow.find(ParameterIdImageCaptureExposureTimeUsec, known)) { return; }
+            // a value set before or during the read is newer than the camera's
+            const auto writes = m_exposure_writes.load();
+            if (writes % 2 != 0) { return; }
+            ParameterArray<ParameterIdImageCaptureExposureTimeUsec> p;
+            if (read_parameter<ParameterIdImageCaptureExposureTimeUsec>(*m_p_camera, p) || m_exposure_writes != writes) { return; }
+            if (!m_shadow.store(ParameterIdImageCaptureExposureTimeUsec, ParameterShadow::Values{static_cast<double>(p[0])})) { return; }
+            OnExposureChanged(p[0] / 1000.0);
+        };
+        auto poll_gain = [this]() {
+            ParameterShadow::Values known;
+            if (!m_shadow.find(ParameterIdImageCaptureGain, known)) { return; }
+            // a value staged before or during the read is newer than the camera's
+            const auto staged = m_p_coalescer->get_staged_count();
+            if (m_p_coalescer->is_pending(ParameterIdImageCaptureGain)) { return; }
+            ParameterArray<ParameterIdImageCaptureGain> p;
+            if (read_parameter<ParameterIdImageCaptureGain>(*m_p_camera, p) || m_p_coalescer->get_staged_count() != staged) { return; }
+            if (!m_shadow.store(ParameterIdImageCaptureGain, ParameterShadow::Values{p[0]})) { return; }
+            std::stringstream ss;
+            ss << p[0];
+            OnPropertyChanged(M_S_GAIN_NAME.c_str(), ss.str().c_str());
+        };
+
+        std::unique_lock<std::mutex> lock(m_poll_mutex);
+        while (!m_poll_cv.wait_for(lock, std::chrono::milliseconds(M_S_POLL_INTERVAL_MS), [this]() { return m_poll_cancel.load(); })) {
+            lock.unlock();
+            poll_exposure();
+            poll_gain();
+            lock.lock();
+        }
+    }
+
+    void ProkyonCamera::stop_polling() {
+        {
+            std::lock_guard<std::mutex> lock(m_poll_mutex);
+            m_poll_cancel = true;
+        }
+        m_poll_cv.notify_all();
+        if (m_poll_thread.joinable()) {
+            m_poll_thread.join();
+        }
+    }
+
+    void ProkyonCamera::setup_initialization_property() {
+        LogMessage("initialization | r | adapter");
+        this->CreatePropertyWithHandler(M_S_INITIALIZATION_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_initialization_property, false);
+    }
+
+    int ProkyonCamera::update_initialization_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        if (type == MM::BeforeGet) {
+            std::lock_guard<std::mutex> lock(m_init_mutex);
+            p_prop->Set(((m_init_complete ? "complete, " : "running, ") + m_init_status).c_str());
         }
-        auto p_callback = new CPropertyAction(this, &ProkyonCamera::update_string_property);
-        this->CreateStringProperty(display_name.c_str(), p_property->get().c_str(), !p_property->writeable(), p_callback, false);
-        m_string_properties[display_name] = std::move(p_property);
+        return DEVICE_OK;
     }
 
     void ProkyonCamera::setup_image_mode_property() {
@@ -459,27 +1077,48 @@ namespace Prokyon {
         NumericProperty image_mode_base(*m_p_camera, ParameterIdImageModeIndex);
         NumericProperty virtual_image_mode_base(*m_p_camera, ParameterIdImageModeVirtualIndex);
         StringProperty virtual_image_mode_name(*m_p_camera, ParameterIdImageModeName);
-        std::map<std::string, int> image_mode_forward;
-        std::vector<int> range(image_mode_base.range_int()[1], 0);
-        std::iota(range.begin(), range.end(), 0);
-        for (const auto value : range) {
-            virtual_image_mode_base.set(std::vector<int>{value});
+        auto read_key = [&]() {
             auto key = virtual_image_mode_name.get();
             key.erase(std::remove(key.begin(), key.end(), ','), key.end());
             key.erase(std::remove(key.begin(), key.end(), '('), key.end());
             key.erase(std::remove(key.begin(), key.end(), ')'), key.end());
-            image_mode_forward.emplace(key, value);
+            return key;
+        };
+        const auto mode_count = image_mode_base.range_int()[1];
+        if (!m_p_catalogue->is_loaded() || !m_p_catalogue->matches(mode_count, virtual_image_mode_base.get_int()[0], read_key())) {
+            // specifications of a catalogue that does not match are not trusted either
+            m_p_catalogue->clear();
+            std::map<std::string, ModeCatalogue::Mode> modes;
+            std::vector<int> range(mode_count, 0);
+            std::iota(range.begin(), range.end(), 0);
+            for (const auto value : range) {
+                virtual_image_mode_base.set(std::vector<int>{value});
+                modes.emplace(read_key(), query_image_mode(value));
+            }
+            m_p_catalogue->set_modes(modes);
         }
+        const auto image_mode_forward = m_p_catalogue->get_mode_indices();
         auto p_image_mode = std::make_unique<DiscreteSetProperty>(*m_p_camera, ParameterIdImageModeIndex, image_mode_forward, true);
         for (const auto value : p_image_mode->range()) {
             LogMessage(value);
         }
-        this->CreatePropertyWithHandler(M_S_IMAGE_MODE_NAME.c_str(), p_image_mode->range()[0].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_discrete_set_property, false);
+        // mode switches, layout updates and binning go by the descriptor of the current mode, not by sdk queries
+        m_image_mode_name.clear();
+        if (!m_p_catalogue->find_mode(image_mode_base.get_int()[0], m_image_mode_name, m_image_mode)) {
+            LogMessage("current image mode not in catalogue");
+        }
+        const auto initial = m_image_mode_name.empty() ? p_image_mode->range()[0] : m_image_mode_name;
+        const auto image_mode_index = ParameterTraits<ParameterIdImageModeIndex>::index;
+        auto p_callback = new CPropertyActionEx(this, &ProkyonCamera::update_discrete_set_property, static_cast<long>(image_mode_index));
+        this->CreateStringProperty(M_S_IMAGE_MODE_NAME.c_str(), initial.c_str(), false, p_callback, false);
         this->SetAllowedValues(M_S_IMAGE_MODE_NAME.c_str(), p_image_mode->range());
-        m_discrete_set_properties[M_S_IMAGE_MODE_NAME] = std::move(p_image_mode);
+        m_sdk_properties[image_mode_index].name = M_S_IMAGE_MODE_NAME;
+        m_sdk_properties[image_mode_index].p_set = std::move(p_image_mode);
 
+        // no core property, set along with the image mode
         auto p_virtual_image_mode = std::make_unique<DiscreteSetProperty>(*m_p_camera, ParameterIdImageModeVirtualIndex, image_mode_forward, true);
-        m_discrete_set_properties[M_S_VIRTUAL_IMAGE_MODE_NAME] = std::move(p_virtual_image_mode);
+        m_sdk_properties[ParameterTraits<ParameterIdImageModeVirtualIndex>::index].name = M_S_VIRTUAL_IMAGE_MODE_NAME;
+        m_sdk_properties[ParameterTraits<ParameterIdImageModeVirtualIndex>::index].p_set = std::move(p_virtual_image_mode);
 
         LogMessage("ParameterIdImageProcessingOutputFormat | rw | discrete");
         NumericProperty output_format_base(*m_p_camera, ParameterIdImageProcessingOutputFormat);
@@ -489,63 +1128,297 @@ namespace Prokyon {
             {"Gray 16 bpp", DijSDK_EImageFormatGrey16}
         };
         auto p_output_format = std::make_unique<DiscreteSetProperty>(*m_p_camera, ParameterIdImageProcessingOutputFormat, output_format_forward, false);
-        this->CreatePropertyWithHandler(M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME.c_str(), p_output_format->range()[0].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_discrete_set_property, false);
+        const auto output_format_index = ParameterTraits<ParameterIdImageProcessingOutputFormat>::index;
+        p_callback = new CPropertyActionEx(this, &ProkyonCamera::update_discrete_set_property, static_cast<long>(output_format_index));
+        this->CreateStringProperty(M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME.c_str(), p_output_format->range()[0].c_str(), false, p_callback, false);
         this->SetAllowedValues(M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME.c_str(), p_output_format->range());
-        m_discrete_set_properties[M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME] = std::move(p_output_format);
+        m_sdk_properties[output_format_index].name = M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME;
+        m_sdk_properties[output_format_index].p_set = std::move(p_output_format);
     }
 
-    bool ProkyonCamera::check_property(PropertyBase *p_property, std::string id_name) const {
-        auto exists = p_property->exists();
-        std::string status;
-        if (!exists) {
-            status = "property " + id_name + " does not exist";
+    ModeCatalogue::Mode ProkyonCamera::query_image_mode(int index) const {
+        ModeCatalogue::Mode mode{index, {0, 0}, {1, 1}, {1, 1}, {1, 1}, {0, 0}, {1.0, 1.0}, 0};
+        auto pair = [this](DijSDK_EParamId id) {
+            auto v = NumericProperty(*m_p_camera, id).get_int();
+            if (v.empty()) { throw PropertyException(); }
+            return std::array<int, 2>{v.front(), v.back()};
+        };
+        try {
+            mode.size = pair(ParameterIdImageModeSize);
+            mode.subsampling = pair(ParameterIdImageModeSubsampling);
+            mode.averaging = pair(ParameterIdImageModeAveraging);
+            mode.summing = pair(ParameterIdImageModeSumming);
+            mode.bits = pair(ParameterIdImageModeBits);
+            auto pixel_size = NumericProperty(*m_p_camera, ParameterIdImageModePixelSizeMicroMeter).get_double();
+            if (pixel_size.empty()) { throw PropertyException(); }
+            mode.pixel_size_um = {pixel_size.front(), pixel_size.back()};
+            mode.preferred_acquisition_mode = pair(ParameterIdImageModePreferredAcqMode)[0];
         }
-        else {
-            std::stringstream ss;
-            ss << id_name << p_property->readable_delimiter() << p_property->short_specification_to_string();
-            status = ss.str();
+        catch (PropertyException) {
+            LogMessage("exception reading descriptor of image mode " + std::to_string(index));
         }
-        LogMessage(status);
-        return exists;
+        return mode;
     }
 
-    int ProkyonCamera::update_numeric_property(MM::PropertyBase *p_prop, MM::ActionType) {
-        // TODO untangle spaghetti
-        auto name = get_mm_property_name(p_prop);
-        log_property_name(name);
+    void ProkyonCamera::setup_binning_property() {
+        LogMessage("binning | rw | by image mode");
+        std::set<int> binnings;
+        for (const auto &e : m_p_catalogue->get_modes()) {
+            binnings.insert(e.second.get_binning());
+        }
+        std::vector<std::string> values;
+        for (const auto binning : binnings) {
+            values.push_back(std::to_string(binning));
+        }
+        this->CreatePropertyWithHandler(M_S_BINNING_NAME.c_str(), std::to_string(GetBinning()).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_binning_property, false);
+        if (!values.empty()) {
+            this->SetAllowedValues(M_S_BINNING_NAME.c_str(), values);
+        }
+    }
 
-        auto p = get_numeric_property(p_prop);
-        bool success = false;
-        unsigned dimension = 0;
-        bool writeable = false;
-        try {
-            dimension = p->dimension();
-            writeable = p->writeable();
-            switch (p->type()) {
-                case(NumericProperty::Type::Int):
-                {
-                    auto v = get_numeric_value<int>(p_prop, success);
-                    if (!success || v.size() != dimension || !writeable) {
-                        set_numeric_value(p->get_int(), p_prop);
-                    }
-                    else {
-                        p->clip_int(v);
-                        p->set(v);
-                        set_numeric_value(v, p_prop);
-                    }
-                    break;
-                }
-                case(NumericProperty::Type::Double):
-                {
-                    auto v = get_numeric_value<double>(p_prop, success);
-                    if (!success || v.size() != dimension || !writeable) {
-                        set_numeric_value(p->get_double(), p_prop);
-                    }
-                    else {
-                        p->clip_double(v);
-                        p->set(v);
-                        set_numeric_value(v, p_prop);
+    void ProkyonCamera::setup_output_properties() {
+        LogMessage("output mode | rw | adapter");
+        std::vector<std::string> modes;
+        for (const auto &e : M_S_OUTPUT_MODES) {
+            modes.emplace_back(e.first);
+        }
+        auto p_mode_callback = new CPropertyAction(this, &ProkyonCamera::update_output_mode_property);
+        this->CreateStringProperty(M_S_OUTPUT_MODE_NAME.c_str(), "Native", false, p_mode_callback, false);
+        this->SetAllowedValues(M_S_OUTPUT_MODE_NAME.c_str(), modes);
+
+        LogMessage("luminance weights | rw | adapter");
+        auto weights = m_p_image->get_luminance_weights();
+        std::stringstream ss;
+        ss << weights[0] << PropertyBase::readable_delimiter() << weights[1] << PropertyBase::readable_delimiter() << weights[2];
+        auto p_weights_callback = new CPropertyAction(this, &ProkyonCamera::update_luminance_weights_property);
+        this->CreateStringProperty(M_S_LUMINANCE_WEIGHTS_NAME.c_str(), ss.str().c_str(), false, p_weights_callback, false);
+    }
+
+    void ProkyonCamera::setup_preview_properties() {
+        LogMessage("preview | rw | adapter");
+        const auto &preview = m_p_image->get_preview();
+
+        std::vector<std::string> decimations;
+        std::string current_decimation;
+        for (const auto &e : M_S_PREVIEW_DECIMATIONS) {
+            decimations.emplace_back(e.first);
+            if (e.second == preview.get_decimation()) {
+                current_decimation = e.first;
+            }
+        }
+        this->CreatePropertyWithHandler(M_S_PREVIEW_DECIMATION_NAME.c_str(), current_decimation.c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_preview_property, false);
+        this->SetAllowedValues(M_S_PREVIEW_DECIMATION_NAME.c_str(), decimations);
+
+        std::vector<std::string> bools{"false", "true"};
+        this->CreatePropertyWithHandler(M_S_PREVIEW_AUTO_SCALE_NAME.c_str(), bools[preview.get_auto_scale()].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_preview_property, false);
+        this->SetAllowedValues(M_S_PREVIEW_AUTO_SCALE_NAME.c_str(), bools);
+        // readers of the shared memory ring get the preview on its own channel, see Shared Memory-Enabled
+        this->CreatePropertyWithHandler(M_S_PREVIEW_PUBLISH_NAME.c_str(), bools[m_p_image->get_publish_preview()].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_preview_property, false);
+        this->SetAllowedValues(M_S_PREVIEW_PUBLISH_NAME.c_str(), bools);
+
+        std::stringstream ss;
+        ss << preview.get_max_rate_hz();
+        this->CreatePropertyWithHandler(M_S_PREVIEW_MAX_RATE_NAME.c_str(), ss.str().c_str(), MM::PropertyType::Float, false, &ProkyonCamera::update_preview_property, false);
+        this->SetPropertyLimits(M_S_PREVIEW_MAX_RATE_NAME.c_str(), 0.0, 100.0);
+
+        this->CreatePropertyWithHandler(M_S_PREVIEW_SIZE_NAME.c_str(), "0 | 0", MM::PropertyType::String, true, &ProkyonCamera::update_preview_property, false);
+    }
+
+    void ProkyonCamera::setup_sub_regions_property() {
+        LogMessage("sub regions | rw | adapter");
+        auto p_callback = new CPropertyAction(this, &ProkyonCamera::update_sub_regions_property);
+        this->CreateStringProperty(M_S_SUB_REGIONS_NAME.c_str(), "", false, p_callback, false);
+    }
+
+    void ProkyonCamera::setup_characterization_properties() {
+        LogMessage("characterization | rw | adapter");
+        const auto &settings = m_characterization_settings;
+        auto to_string = [](const std::vector<double> &values) {
+            std::stringstream ss;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (0 < i) {
+                    ss << PropertyBase::readable_delimiter();
+                }
+                ss << values[i];
+            }
+            return ss.str();
+        };
+        this->CreatePropertyWithHandler(M_S_CHARACTERIZATION_EXPOSURES_NAME.c_str(), to_string(settings.exposures_ms).c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_characterization_property, false);
+        this->CreatePropertyWithHandler(M_S_CHARACTERIZATION_GAINS_NAME.c_str(), to_string(settings.gains).c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_characterization_property, false);
+        this->CreatePropertyWithHandler(M_S_CHARACTERIZATION_FRAMES_NAME.c_str(), std::to_string(settings.frames_per_step).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_characterization_property, false);
+        this->SetPropertyLimits(M_S_CHARACTERIZATION_FRAMES_NAME.c_str(), 2, 1024);
+        this->CreatePropertyWithHandler(M_S_CHARACTERIZATION_REPORT_NAME.c_str(), settings.report_file.c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_characterization_property, false);
+
+        std::vector<std::string> run{"Idle", "Run"};
+        this->CreatePropertyWithHandler(M_S_CHARACTERIZATION_RUN_NAME.c_str(), run[0].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_characterization_property, false);
+        this->SetAllowedValues(M_S_CHARACTERIZATION_RUN_NAME.c_str(), run);
+        this->CreatePropertyWithHandler(M_S_CHARACTERIZATION_RESULT_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_characterization_property, false);
+    }
+
+    void ProkyonCamera::setup_focus_metric_properties() {
+        LogMessage("focus metric | rw | adapter");
+        const auto &metric = m_p_image->get_focus_metric();
+        std::vector<std::string> bools{"false", "true"};
+        this->CreatePropertyWithHandler(M_S_FOCUS_METRIC_ENABLED_NAME.c_str(), bools[metric.get_enabled()].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_focus_metric_property, false);
+        this->SetAllowedValues(M_S_FOCUS_METRIC_ENABLED_NAME.c_str(), bools);
+        this->CreatePropertyWithHandler(M_S_FOCUS_METRIC_ROI_NAME.c_str(), "", MM::PropertyType::String, false, &ProkyonCamera::update_focus_metric_property, false);
+        this->CreatePropertyWithHandler(M_S_FOCUS_METRIC_VALUE_NAME.c_str(), "0", MM::PropertyType::Float, true, &ProkyonCamera::update_focus_metric_property, false);
+    }
+
+    void ProkyonCamera::setup_publisher_properties() {
+        LogMessage("shared memory publisher | rw | adapter");
+        const auto &settings = m_publisher_settings;
+        std::vector<std::string> bools{"false", "true"};
+        this->CreatePropertyWithHandler(M_S_PUBLISHER_ENABLED_NAME.c_str(), bools[m_publisher_enabled].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_publisher_property, false);
+        this->SetAllowedValues(M_S_PUBLISHER_ENABLED_NAME.c_str(), bools);
+        this->CreatePropertyWithHandler(M_S_PUBLISHER_NAME_NAME.c_str(), settings.name.c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_publisher_property, false);
+        this->CreatePropertyWithHandler(M_S_PUBLISHER_SLOTS_NAME.c_str(), std::to_string(settings.slot_count).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_publisher_property, false);
+        this->SetPropertyLimits(M_S_PUBLISHER_SLOTS_NAME.c_str(), 2, 256);
+        this->CreatePropertyWithHandler(M_S_PUBLISHER_SLOT_SIZE_NAME.c_str(), std::to_string(settings.slot_size_mb).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_publisher_property, false);
+        this->SetPropertyLimits(M_S_PUBLISHER_SLOT_SIZE_NAME.c_str(), 0, 256);
+        this->CreatePropertyWithHandler(M_S_PUBLISHER_STATUS_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_publisher_property, false);
+    }
+
+    void ProkyonCamera::setup_pipeline_properties() {
+        LogMessage("pipeline | rw | adapter");
+        this->CreatePropertyWithHandler(M_S_PIPELINE_STAGES_NAME.c_str(), m_pipeline_spec.c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_pipeline_property, false);
+        this->CreatePropertyWithHandler(M_S_PIPELINE_WORKERS_NAME.c_str(), std::to_string(m_pipeline_workers).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_pipeline_property, false);
+        this->SetPropertyLimits(M_S_PIPELINE_WORKERS_NAME.c_str(), 1, 16);
+        this->CreatePropertyWithHandler(M_S_PIPELINE_DEPTH_NAME.c_str(), std::to_string(m_pipeline_depth).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_pipeline_property, false);
+        this->SetPropertyLimits(M_S_PIPELINE_DEPTH_NAME.c_str(), 2, 64);
+        this->CreatePropertyWithHandler(M_S_PIPELINE_TIMING_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_pipeline_property, false);
+    }
+
+    void ProkyonCamera::setup_thread_properties() {
+        LogMessage("threads | rw | adapter");
+        std::vector<std::string> bools{"false", "true"};
+        this->CreatePropertyWithHandler(M_S_THREADS_CAPTURE_CORES_NAME.c_str(), "", MM::PropertyType::String, false, &ProkyonCamera::update_thread_property, false);
+        this->CreatePropertyWithHandler(M_S_THREADS_WORKER_CORES_NAME.c_str(), "", MM::PropertyType::String, false, &ProkyonCamera::update_thread_property, false);
+        this->CreatePropertyWithHandler(M_S_THREADS_RAISE_PRIORITY_NAME.c_str(), bools[m_raise_thread_priority].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_thread_property, false);
+        this->SetAllowedValues(M_S_THREADS_RAISE_PRIORITY_NAME.c_str(), bools);
+        this->CreatePropertyWithHandler(M_S_THREADS_STATUS_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_thread_property, false);
+    }
+
+    void ProkyonCamera::setup_coalescing_properties() {
+        LogMessage("property writes | rw | adapter");
+        std::stringstream ss;
+        ss << m_p_coalescer->get_max_rate_hz();
+        this->CreatePropertyWithHandler(M_S_WRITES_MAX_RATE_NAME.c_str(), ss.str().c_str(), MM::PropertyType::Float, false, &ProkyonCamera::update_coalescing_property, false);
+        this->SetPropertyLimits(M_S_WRITES_MAX_RATE_NAME.c_str(), 0.0, 100.0);
+        this->CreatePropertyWithHandler(M_S_WRITES_STATUS_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_coalescing_property, false);
+    }
+
+    void ProkyonCamera::setup_sequence_properties() {
+        LogMessage("sequence | r | adapter");
+        this->CreatePropertyWithHandler(M_S_SEQUENCE_LAST_SWITCH_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_sequence_property, false);
+        this->CreatePropertyWithHandler(M_S_SEQUENCE_DROPPED_FRAMES_NAME.c_str(), "0", MM::PropertyType::Integer, true, &ProkyonCamera::update_sequence_property, false);
+    }
+
+    void ProkyonCamera::setup_preset_properties() {
+        LogMessage("presets | rw | adapter");
+        this->CreatePropertyWithHandler(M_S_PRESET_SAVE_NAME.c_str(), "", MM::PropertyType::String, false, &ProkyonCamera::update_preset_property, false);
+        this->CreatePropertyWithHandler(M_S_PRESET_APPLY_NAME.c_str(), "", MM::PropertyType::String, false, &ProkyonCamera::update_preset_property, false);
+        this->CreatePropertyWithHandler(M_S_PRESET_LAST_SWITCH_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_preset_property, false);
+    }
+
+    void ProkyonCamera::setup_transaction_properties() {
+        LogMessage("transactions | rw | adapter");
+        std::vector<std::string> begin{"Idle", "Begin"};
+        this->CreatePropertyWithHandler(M_S_TRANSACTION_BEGIN_NAME.c_str(), begin[0].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_transaction_property, false);
+        this->SetAllowedValues(M_S_TRANSACTION_BEGIN_NAME.c_str(), begin);
+        std::vector<std::string> commit{"Idle", "Commit", "Discard"};
+        this->CreatePropertyWithHandler(M_S_TRANSACTION_COMMIT_NAME.c_str(), commit[0].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_transaction_property, false);
+        this->SetAllowedValues(M_S_TRANSACTION_COMMIT_NAME.c_str(), commit);
+        this->CreatePropertyWithHandler(M_S_TRANSACTION_STATUS_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_transaction_property, false);
+    }
+
+    void ProkyonCamera::setup_memory_properties() {
+        LogMessage("frame memory | rw | adapter");
+        std::vector<std::string> bools{"false", "true"};
+        this->CreatePropertyWithHandler(M_S_MEMORY_LOCK_NAME.c_str(), bools[m_memory_options.lock].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_memory_property, false);
+        this->SetAllowedValues(M_S_MEMORY_LOCK_NAME.c_str(), bools);
+        this->CreatePropertyWithHandler(M_S_MEMORY_HUGE_PAGES_NAME.c_str(), bools[m_memory_options.huge_pages].c_str(), MM::PropertyType::String, false, &ProkyonCamera::update_memory_property, false);
+        this->SetAllowedValues(M_S_MEMORY_HUGE_PAGES_NAME.c_str(), bools);
+        this->CreatePropertyWithHandler(M_S_MEMORY_BUDGET_NAME.c_str(), std::to_string(m_memory_budget >> 20).c_str(), MM::PropertyType::Integer, false, &ProkyonCamera::update_memory_property, false);
+        this->SetPropertyLimits(M_S_MEMORY_BUDGET_NAME.c_str(), 64, 16384);
+        this->CreatePropertyWithHandler(M_S_MEMORY_STATUS_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonCamera::update_memory_property, false);
+    }
+
+    bool ProkyonCamera::check_property(PropertyBase *p_property, std::string id_name) const {
+        ModeCatalogue::Spec spec;
+        if (!m_p_catalogue->find_spec(id_name, spec)) {
+            spec.exists = p_property->exists();
+            spec.description = spec.exists ? p_property->short_specification_to_string() : "";
+            m_p_catalogue->set_spec(id_name, spec);
+        }
+        std::string status;
+        if (!spec.exists) {
+            status = "property " + id_name + " does not exist";
+        }
+        else {
+            std::stringstream ss;
+            ss << id_name << p_property->readable_delimiter() << spec.description;
+            status = ss.str();
+        }
+        LogMessage(status);
+        return spec.exists;
+    }
+
+    int ProkyonCamera::update_numeric_property(MM::PropertyBase *p_prop, MM::ActionType type, long index) {
+        const auto &name = m_sdk_properties[index].name;
+        log_property_name(name);
+
+        // the camera is written on AfterSet only, every other access is served from the shadow
+        auto p = get_numeric_property(index);
+        try {
+            const auto dimension = p->dimension();
+            const auto writeable = p->writeable();
+            ParameterShadow::Values known;
+            switch (p->type()) {
+                case(NumericProperty::Type::Int):
+                {
+                    bool success = false;
+                    auto v = (type == MM::AfterSet) ? get_numeric_value<int>(p_prop, success) : std::vector<int>{};
+                    if (success && v.size() == dimension && writeable) {
+                        p->clip_int(v);
+                        p->set(v);
+                        m_shadow.store(p->get_id(), ParameterShadow::Values(v.cbegin(), v.cend()));
+                    }
+                    else if (m_shadow.find(p->get_id(), known)) {
+                        v.clear();
+                        for (auto k : known) {
+                            v.push_back(static_cast<int>(k));
+                        }
+                    }
+                    else {
+                        v = p->get_int();
+                        m_shadow.store(p->get_id(), ParameterShadow::Values(v.cbegin(), v.cend()));
+                    }
+                    set_numeric_value(v, p_prop);
+                    break;
+                }
+                case(NumericProperty::Type::Double):
+                {
+                    bool success = false;
+                    auto v = (type == MM::AfterSet) ? get_numeric_value<double>(p_prop, success) : std::vector<double>{};
+                    if (success && v.size() == dimension && writeable) {
+                        p->clip_double(v);
+                        if (M_S_COALESCED_PARAMETERS.count(p->get_id())) {
+                            m_p_coalescer->stage(p->get_id(), v);
+                        }
+                        else {
+                            p->set(v);
+                        }
+                        m_shadow.store(p->get_id(), v);
+                    }
+                    else if (m_shadow.find(p->get_id(), known)) {
+                        v = known;
                     }
+                    else {
+                        v = p->get_double();
+                        m_shadow.store(p->get_id(), v);
+                    }
+                    set_numeric_value(v, p_prop);
                     break;
                 }
                 default:
@@ -556,16 +1429,30 @@ namespace Prokyon {
             LogMessage(update_exception_msg(name));
             return DEVICE_ERR;
         }
+
+        if (type == MM::AfterSet && p->get_id() == ParameterIdImageCaptureGain && IsCapturing()) {
+            update_frame_metadata();
+        }
         return DEVICE_OK;
     }
 
-    int ProkyonCamera::update_string_property(MM::PropertyBase *p_prop, MM::ActionType) {
-        auto name = get_mm_property_name(p_prop);
+    int ProkyonCamera::update_string_property(MM::PropertyBase *p_prop, MM::ActionType type, long index) {
+        const auto &name = m_sdk_properties[index].name;
         log_property_name(name);
 
-        auto p = get_string_property(p_prop);
+        auto p = get_string_property(index);
         try {
-            p_prop->Set(p->get().c_str());
+            std::string v;
+            if (type == MM::AfterSet && p->writeable()) {
+                p_prop->Get(v);
+                p->set(v);
+                m_shadow.store(p->get_id(), v);
+            }
+            else if (!m_shadow.find(p->get_id(), v)) {
+                v = p->get();
+                m_shadow.store(p->get_id(), v);
+            }
+            p_prop->Set(v.c_str());
         }
         catch (PropertyException) {
             LogMessage(update_exception_msg(name));
@@ -574,15 +1461,24 @@ namespace Prokyon {
         return DEVICE_OK;
     }
 
-    int ProkyonCamera::update_bool_property(MM::PropertyBase *p_prop, MM::ActionType) {
-        auto name = get_mm_property_name(p_prop);
+    int ProkyonCamera::update_bool_property(MM::PropertyBase *p_prop, MM::ActionType type, long index) {
+        const auto &name = m_sdk_properties[index].name;
         log_property_name(name);
 
         try {
             std::string v;
-            p_prop->Get(v);
-            auto p = get_bool_property(p_prop);
-            p->set(v);
+            auto p = get_bool_property(index);
+            // written on a set only, a read shows the camera's value
+            if (type == MM::AfterSet && p->writeable()) {
+                p_prop->Get(v);
+                p->set(v);
+                m_shadow.store(p->get_id(), v);
+            }
+            else if (!m_shadow.find(p->get_id(), v)) {
+                v = p->get();
+                m_shadow.store(p->get_id(), v);
+            }
+            p_prop->Set(v.c_str());
         }
         catch (PropertyException) {
             LogMessage(update_exception_msg(name));
@@ -591,125 +1487,1101 @@ namespace Prokyon {
         return DEVICE_OK;
     }
 
-    int ProkyonCamera::update_discrete_set_property(MM::PropertyBase *p_prop, MM::ActionType type) {
-        auto name = get_mm_property_name(p_prop);
+    int ProkyonCamera::update_discrete_set_property(MM::PropertyBase *p_prop, MM::ActionType type, long index) {
+        const auto &name = m_sdk_properties[index].name;
         log_property_name(name);
 
-        if (name == M_S_IMAGE_MODE_NAME) {
-            update_image_mode_property(p_prop, type);
+        if (index == ParameterTraits<ParameterIdImageModeIndex>::index) {
+            return update_image_mode_property(p_prop, type, index);
         }
-        else {
+
+        const auto is_output_format = index == ParameterTraits<ParameterIdImageProcessingOutputFormat>::index;
+        auto set = [&]() {
+            std::string v;
+            p_prop->Get(v);
             try {
-                std::string v;
-                p_prop->Get(v);
-                auto p = get_discrete_set_property(p_prop);
+                auto p = get_discrete_set_property(index);
                 p->set(v);
             }
             catch (PropertyException) {
                 LogMessage(update_exception_msg(name));
                 return DEVICE_ERR;
             }
+            if (is_output_format && !m_p_image->has_supported_format()) {
+                LogMessage(name + " " + v + " is raw bayer, which is not converted, set an RGB or gray mode");
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            if (is_output_format && !m_p_image->update()) {
+                return DEVICE_ERR;
+            }
+            return DEVICE_OK;
+        };
+
+        if (is_output_format) {
+            // the colour format changes the raw layout, the sdk must not be acquiring meanwhile
+            if (type != MM::AfterSet) {
+                return DEVICE_OK;
+            }
+            return reconfigure(name, set);
+        }
+        return set();
+    }
+
+    int ProkyonCamera::update_image_mode_property(MM::PropertyBase *p_prop, MM::ActionType type, long index) {
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
         }
 
-        if (name == M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME) {
+        const auto &name = m_sdk_properties[index].name;
+        std::string s;
+        p_prop->Get(s);
+
+        return reconfigure(name, [&]() {
+            try {
+                get_discrete_set_property(index)->set(s);
+                get_discrete_set_property(ParameterTraits<ParameterIdImageModeVirtualIndex>::index)->set(s);
+                // ranges such as the gain limits may move with the mode, and values clipped to them
+                invalidate_property_ranges();
+                m_shadow.clear();
+                // the sensor area depends on the mode, known from its descriptor
+                const auto modes = m_p_catalogue->get_modes();
+                auto it = modes.find(s);
+                if (it != modes.cend() && 0 < it->second.size[0] && 0 < it->second.size[1]) {
+                    m_image_mode_name = s;
+                    m_image_mode = it->second;
+                    m_p_roi->refresh(static_cast<unsigned>(m_image_mode.size[0]), static_cast<unsigned>(m_image_mode.size[1]));
+                }
+                else {
+                    m_image_mode_name.clear();
+                    m_p_roi->refresh();
+                }
+            }
+            catch (PropertyException) {
+                LogMessage(update_exception_msg(name));
+                return DEVICE_ERR;
+            }
+            catch (RegionOfInterestException) {
+                LogMessage("exception reading roi after image mode change");
+                return DEVICE_ERR;
+            }
+
             if (!m_p_image->update()) {
                 return DEVICE_ERR;
             }
+            return DEVICE_OK;
+        });
+    }
+
+    void ProkyonCamera::invalidate_property_ranges() {
+        if (m_p_exposure != nullptr) {
+            m_p_exposure->invalidate_range();
+        }
+        for (auto &property : m_sdk_properties) {
+            if (property.p_numeric != nullptr) {
+                property.p_numeric->invalidate_range();
+            }
+            if (property.p_bool != nullptr) {
+                property.p_bool->invalidate_range();
+            }
+            if (property.p_set != nullptr) {
+                property.p_set->invalidate_range();
+            }
         }
+    }
 
+    int ProkyonCamera::update_binning_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        if (type == MM::BeforeGet) {
+            p_prop->Set(static_cast<long>(GetBinning()));
+        }
+        else if (type == MM::AfterSet) {
+            long binning = 1;
+            p_prop->Get(binning);
+            return SetBinning(static_cast<int>(binning));
+        }
         return DEVICE_OK;
     }
 
-    int ProkyonCamera::update_image_mode_property(MM::PropertyBase *p_prop, MM::ActionType) {
+    int ProkyonCamera::update_output_mode_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+
         auto name = get_mm_property_name(p_prop);
-        std::string s;
-        p_prop->Get(s);
+        log_property_name(name);
 
-        assert(m_discrete_set_properties.count(M_S_IMAGE_MODE_NAME));
-        assert(m_discrete_set_properties.count(M_S_VIRTUAL_IMAGE_MODE_NAME));
+        std::string v;
+        p_prop->Get(v);
+        auto it = M_S_OUTPUT_MODES.find(v);
+        if (it == M_S_OUTPUT_MODES.cend()) {
+            return DEVICE_INVALID_PROPERTY_VALUE;
+        }
+        return reconfigure(name, [&]() {
+            m_p_image->set_output_mode(it->second);
+            return m_p_image->update() ? DEVICE_OK : DEVICE_ERR;
+        });
+    }
 
-        try {
-            auto p = m_discrete_set_properties.at(M_S_IMAGE_MODE_NAME).get();
-            p->set(s);
-            p = m_discrete_set_properties.at(M_S_VIRTUAL_IMAGE_MODE_NAME).get();
-            p->set(s);
+    int ProkyonCamera::update_luminance_weights_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
         }
-        catch (PropertyException) {
-            LogMessage(update_exception_msg(name));
-            return DEVICE_ERR;
+
+        auto name = get_mm_property_name(p_prop);
+        log_property_name(name);
+
+        bool success = false;
+        auto v = get_numeric_value<double>(p_prop, success);
+        auto weights = m_p_image->get_luminance_weights();
+        if (!success || v.size() != weights.size()) {
+            set_numeric_value(std::vector<double>(weights.cbegin(), weights.cend()), p_prop);
+            return DEVICE_INVALID_PROPERTY_VALUE;
         }
+        std::copy(v.cbegin(), v.cend(), weights.begin());
+        return reconfigure(name, [&]() {
+            m_p_image->set_luminance_weights(weights);
+            return m_p_image->update() ? DEVICE_OK : DEVICE_ERR;
+        });
+    }
 
-        if (!m_p_image->update()) {
-            return DEVICE_ERR;
+    int ProkyonCamera::update_preview_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        auto name = get_mm_property_name(p_prop);
+        auto &preview = m_p_image->get_preview();
+
+        if (name == M_S_PREVIEW_SIZE_NAME) {
+            if (type == MM::BeforeGet) {
+                auto p_frame = preview.get_frame();
+                std::vector<unsigned> size{0, 0};
+                if (p_frame != nullptr) {
+                    size = {p_frame->width, p_frame->height};
+                }
+                set_numeric_value(size, p_prop);
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        if (name == M_S_PREVIEW_DECIMATION_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            auto it = M_S_PREVIEW_DECIMATIONS.find(v);
+            if (it == M_S_PREVIEW_DECIMATIONS.cend()) {
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            preview.set_decimation(it->second);
+        }
+        else if (name == M_S_PREVIEW_AUTO_SCALE_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            preview.set_auto_scale(v == "true");
+        }
+        else if (name == M_S_PREVIEW_PUBLISH_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            m_p_image->set_publish_preview(v == "true");
+        }
+        else if (name == M_S_PREVIEW_MAX_RATE_NAME) {
+            double v = 0.0;
+            p_prop->Get(v);
+            preview.set_max_rate_hz(v);
+        }
+        else {
+            assert(false);
         }
         return DEVICE_OK;
     }
 
-    std::string ProkyonCamera::update_exception_msg(std::string name) {
-        return "exception updating property " + name;
+    int ProkyonCamera::update_sub_regions_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+
+        auto name = get_mm_property_name(p_prop);
+        log_property_name(name);
+
+        std::string v;
+        p_prop->Get(v);
+        std::vector<ROI> regions;
+        if (!parse_regions(v, regions) || !Image::check_crops(regions)) {
+            // checked before the roi is touched
+            LogMessage("sub regions must parse and all have the same size");
+            p_prop->Set(regions_to_string(m_p_image->get_crops()).c_str());
+            return DEVICE_INVALID_PROPERTY_VALUE;
+        }
+
+        if (regions.empty() && m_p_image->get_crops().empty()) {
+            return DEVICE_OK;
+        }
+
+        return reconfigure(name, [&]() {
+            auto ret = DEVICE_OK;
+            try {
+                if (regions.empty()) {
+                    // back to a single full roi channel
+                    m_p_roi->clear();
+                    m_p_image->set_crops({});
+                }
+                else {
+                    // read out only the bounding box of all regions, crop each during conversion
+                    m_p_image->set_sub_regions(*m_p_roi, regions);
+                }
+            }
+            catch (RegionOfInterestException) {
+                LogMessage(update_exception_msg(name));
+                ret = DEVICE_CAN_NOT_SET_PROPERTY;
+            }
+            catch (ImageException) {
+                ret = DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            // also after a failure, the raw size of the frames follows the roi the camera has now
+            if (!m_p_image->update()) {
+                return DEVICE_ERR;
+            }
+            if (ret != DEVICE_OK) {
+                p_prop->Set(regions_to_string(m_p_image->get_crops()).c_str());
+            }
+            return ret;
+        });
     }
 
-    NumericProperty *ProkyonCamera::get_numeric_property(MM::PropertyBase *p_prop) {
+    int ProkyonCamera::update_characterization_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_numeric_properties.count(name));
-        return m_numeric_properties.at(name).get();
+
+        if (name == M_S_CHARACTERIZATION_RESULT_NAME) {
+            if (type == MM::BeforeGet) {
+                p_prop->Set(m_p_characterization->summary_to_string().c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        auto &settings = m_characterization_settings;
+        if (name == M_S_CHARACTERIZATION_EXPOSURES_NAME || name == M_S_CHARACTERIZATION_GAINS_NAME) {
+            auto &target = (name == M_S_CHARACTERIZATION_GAINS_NAME) ? settings.gains : settings.exposures_ms;
+            bool success = false;
+            auto v = get_numeric_value<double>(p_prop, success);
+            auto is_positive = std::all_of(v.cbegin(), v.cend(), [](double d) { return 0.0 < d; });
+            if (!success || v.empty() || !is_positive) {
+                set_numeric_value(target, p_prop);
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            target = v;
+        }
+        else if (name == M_S_CHARACTERIZATION_FRAMES_NAME) {
+            long v = 0;
+            p_prop->Get(v);
+            settings.frames_per_step = static_cast<unsigned>(v);
+        }
+        else if (name == M_S_CHARACTERIZATION_REPORT_NAME) {
+            p_prop->Get(settings.report_file);
+        }
+        else if (name == M_S_CHARACTERIZATION_RUN_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            if (v != "Run") {
+                return DEVICE_OK;
+            }
+            if (IsCapturing()) {
+                p_prop->Set("Idle");
+                return DEVICE_CAMERA_BUSY_ACQUIRING;
+            }
+
+            // the sweep sets the gain itself, a pending slider value must not land in between
+            m_p_coalescer->flush();
+            auto out = DEVICE_OK;
+            try {
+                m_p_characterization->run(settings);
+                LogMessage("characterization done: " + m_p_characterization->summary_to_string());
+            }
+            catch (SensorCharacterizationException) {
+                // needs a single component output, i.e. a gray color mode or a luminance output mode
+                LogMessage(update_exception_msg(name));
+                out = DEVICE_ERR;
+            }
+            p_prop->Set("Idle");
+            m_p_image->update();
+            return out;
+        }
+        else {
+            assert(false);
+        }
+        return DEVICE_OK;
     }
 
-    const NumericProperty *ProkyonCamera::get_numeric_property(MM::PropertyBase *p_prop) const {
+    int ProkyonCamera::update_focus_metric_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_numeric_properties.count(name));
-        return m_numeric_properties.at(name).get();
+        auto &metric = m_p_image->get_focus_metric();
+
+        if (name == M_S_FOCUS_METRIC_VALUE_NAME) {
+            if (type == MM::BeforeGet) {
+                p_prop->Set(metric.get_value().value);
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        if (name == M_S_FOCUS_METRIC_ENABLED_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            metric.set_enabled(v == "true");
+        }
+        else if (name == M_S_FOCUS_METRIC_ROI_NAME) {
+            // relative to the delivered image, empty for all of it
+            std::string v;
+            p_prop->Get(v);
+            std::vector<ROI> regions;
+            if (!parse_regions(v, regions) || 1 < regions.size()) {
+                auto roi = metric.get_roi();
+                p_prop->Set((roi[W_ind] == 0) ? "" : regions_to_string({roi}).c_str());
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            metric.set_roi(regions.empty() ? ROI{0, 0, 0, 0} : regions[0]);
+        }
+        else {
+            assert(false);
+        }
+        return DEVICE_OK;
     }
 
-    BoolProperty *ProkyonCamera::get_bool_property(MM::PropertyBase *p_prop) {
+    int ProkyonCamera::update_publisher_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_bool_properties.count(name));
-        return m_bool_properties.at(name).get();
+        auto &publisher = m_p_image->get_publisher();
+
+        if (name == M_S_PUBLISHER_STATUS_NAME) {
+            if (type == MM::BeforeGet) {
+                std::stringstream ss;
+                ss << "published " << publisher.get_published_count() << ", skipped " << publisher.get_skipped_count();
+                p_prop->Set(ss.str().c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        auto &settings = m_publisher_settings;
+        if (name == M_S_PUBLISHER_ENABLED_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            m_publisher_enabled = (v == "true");
+        }
+        else if (name == M_S_PUBLISHER_NAME_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            if (v.empty() || v.find_first_of("/\\") != std::string::npos) {
+                p_prop->Set(settings.name.c_str());
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            settings.name = v;
+        }
+        else if (name == M_S_PUBLISHER_SLOTS_NAME) {
+            long v = 0;
+            p_prop->Get(v);
+            settings.slot_count = static_cast<unsigned>(v);
+        }
+        else if (name == M_S_PUBLISHER_SLOT_SIZE_NAME) {
+            long v = 0;
+            p_prop->Get(v);
+            settings.slot_size_mb = static_cast<unsigned>(v);
+        }
+        else {
+            assert(false);
+        }
+
+        // any change takes effect by reopening the ring
+        if (!m_publisher_enabled) {
+            publisher.close();
+            return DEVICE_OK;
+        }
+        return open_publisher();
+    }
+
+    int ProkyonCamera::open_publisher() {
+        const auto &settings = m_publisher_settings;
+        std::size_t capacity = static_cast<std::size_t>(settings.slot_size_mb) << 20;
+        if (capacity == 0) {
+            capacity = static_cast<std::size_t>(m_p_image->get_image_buffer_size());
+        }
+        if (!m_p_image->get_publisher().open(settings.name, settings.slot_count, capacity)) {
+            LogMessage("could not open shared memory " + settings.name);
+            return DEVICE_ERR;
+        }
+        LogMessage(m_p_image->get_publisher().to_string());
+        return DEVICE_OK;
     }
 
-    const BoolProperty *ProkyonCamera::get_bool_property(MM::PropertyBase *p_prop) const {
+    int ProkyonCamera::update_pipeline_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_bool_properties.count(name));
-        return m_bool_properties.at(name).get();
+
+        if (name == M_S_PIPELINE_TIMING_NAME) {
+            if (type == MM::BeforeGet) {
+                auto timing = IsCapturing() ? m_p_pipeline->timing_to_string() : m_p_snap_pipeline->timing_to_string();
+                for (const auto &p_stage : m_user_stages) {
+                    auto p_statistics = std::dynamic_pointer_cast<FrameStatisticsStage>(p_stage);
+                    if (p_statistics != nullptr) {
+                        timing += " | " + p_statistics->get_summary();
+                    }
+                }
+                p_prop->Set(timing.c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        if (name == M_S_PIPELINE_STAGES_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            if (IsCapturing()) {
+                p_prop->Set(m_pipeline_spec.c_str());
+                return DEVICE_CAMERA_BUSY_ACQUIRING;
+            }
+            try {
+                auto stages = make_stages(v);
+                m_p_snap_pipeline->set_stages(stages);
+                m_user_stages = stages;
+                m_pipeline_spec = v;
+                m_snap_frame.p_data = nullptr;
+            }
+            catch (PipelineException) {
+                LogMessage("invalid pipeline stages " + v);
+                p_prop->Set(m_pipeline_spec.c_str());
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            std::stringstream ss;
+            ss << "pipeline stages:";
+            for (const auto &stage_name : m_p_snap_pipeline->get_stage_names()) {
+                ss << " " << stage_name;
+            }
+            LogMessage(ss.str());
+        }
+        else if (name == M_S_PIPELINE_WORKERS_NAME || name == M_S_PIPELINE_DEPTH_NAME) {
+            auto &setting = (name == M_S_PIPELINE_WORKERS_NAME) ? m_pipeline_workers : m_pipeline_depth;
+            if (IsCapturing()) {
+                p_prop->Set(static_cast<long>(setting));
+                return DEVICE_CAMERA_BUSY_ACQUIRING;
+            }
+            long v = 0;
+            p_prop->Get(v);
+            setting = static_cast<unsigned>(v);
+        }
+        else {
+            assert(false);
+        }
+        return DEVICE_OK;
+    }
+
+    int ProkyonCamera::update_thread_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        auto name = get_mm_property_name(p_prop);
+
+        if (name == M_S_THREADS_STATUS_NAME) {
+            if (type == MM::BeforeGet) {
+                // compare the frame interval spread with and without pinning to judge the settings
+                auto intervals = m_p_capture->get_interval_statistics();
+                std::stringstream ss;
+                ss << "capture policy " << (m_p_capture->is_policy_applied() ? "applied" : "failed");
+                ss << ", worker policy failures " << m_p_pipeline->get_policy_failure_count();
+                ss << " | interval mean " << intervals.mean_ms << " ms, sd " << intervals.sd_ms << " ms, max " << intervals.max_ms << " ms over " << intervals.count;
+                auto sdk = SdkThread::get_statistics();
+                ss << " | sdk thread frames " << sdk.frame_commands << ", parameter calls " << sdk.parameter_commands << " in " << sdk.batches << " batches, largest " << sdk.max_batch;
+                p_prop->Set(ss.str().c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        if (name == M_S_THREADS_CAPTURE_CORES_NAME || name == M_S_THREADS_WORKER_CORES_NAME) {
+            auto &cores = (name == M_S_THREADS_CAPTURE_CORES_NAME) ? m_capture_cores : m_worker_cores;
+            std::string v;
+            p_prop->Get(v);
+            std::vector<unsigned> parsed;
+            if (!Scheduling::parse_cores(v, parsed)) {
+                p_prop->Set(Scheduling::cores_to_string(cores).c_str());
+                return DEVICE_INVALID_PROPERTY_VALUE;
+            }
+            cores = parsed;
+        }
+        else if (name == M_S_THREADS_RAISE_PRIORITY_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            m_raise_thread_priority = (v == "true");
+        }
+        else {
+            assert(false);
+        }
+        // takes effect with the next sequence
+        return DEVICE_OK;
+    }
+
+    void ProkyonCamera::apply_thread_policies() {
+        // the capture thread ranks above the workers, so it never waits for conversion work
+        m_p_capture->set_policy({m_capture_cores, m_raise_thread_priority ? ThreadPriority::highest : ThreadPriority::normal});
+
+        const auto worker_priority = m_raise_thread_priority ? ThreadPriority::raised : ThreadPriority::normal;
+        std::vector<ThreadPolicy> policies;
+        for (auto core : m_worker_cores) {
+            policies.push_back({{core}, worker_priority});
+        }
+        if (policies.empty() && m_raise_thread_priority) {
+            policies.push_back({{}, worker_priority});
+        }
+        m_p_pipeline->set_worker_policies(policies);
+    }
+
+    int ProkyonCamera::update_memory_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        auto name = get_mm_property_name(p_prop);
+
+        if (name == M_S_MEMORY_STATUS_NAME) {
+            if (type == MM::BeforeGet) {
+                // the first frame after an allocation shows whether fresh buffers still fault
+                auto statistics = m_p_image->get_conversion_statistics();
+                std::stringstream ss;
+                ss << "locked " << (m_p_image->is_buffer_locked() ? "yes" : "no");
+                ss << ", huge pages " << (m_p_image->is_buffer_huge() ? "yes" : "no");
+                ss << " | first frame " << statistics.first_ms << " ms, " << statistics.first_page_faults << " page faults";
+                ss << " | last frame " << statistics.last_ms << " ms, " << statistics.last_page_faults << " page faults";
+                auto pool = m_p_pool->get_statistics();
+                ss << " | pool " << (pool.allocated_bytes >> 20) << " MB allocated, " << (pool.in_use_bytes >> 20) << " MB in use";
+                ss << ", " << pool.allocations << " allocations, " << pool.reuses << " reuses";
+                p_prop->Set(ss.str().c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        if (name == M_S_MEMORY_BUDGET_NAME) {
+            // frames taken while capturing fail beyond the budget, lowering it is fine at any time
+            long v = 0;
+            p_prop->Get(v);
+            m_memory_budget = static_cast<std::size_t>(v) << 20;
+            m_p_pool->set_budget(m_memory_budget);
+            return DEVICE_OK;
+        }
+
+        std::string v;
+        p_prop->Get(v);
+        auto options = m_memory_options;
+        if (name == M_S_MEMORY_LOCK_NAME) {
+            options.lock = (v == "true");
+        }
+        else if (name == M_S_MEMORY_HUGE_PAGES_NAME) {
+            options.huge_pages = (v == "true");
+        }
+        else {
+            assert(false);
+        }
+
+        if (IsCapturing()) {
+            p_prop->Set((name == M_S_MEMORY_LOCK_NAME) ? (m_memory_options.lock ? "true" : "false") : (m_memory_options.huge_pages ? "true" : "false"));
+            return DEVICE_CAMERA_BUSY_ACQUIRING;
+        }
+        // buffers given back after the change are released, the next ones are allocated with the new options
+        m_p_pool->set_options(options);
+        m_p_pipeline->release_buffers();
+        m_p_snap_pipeline->release_buffers();
+        m_snap_frame.p_data = nullptr;
+        m_p_image->release_buffer();
+        m_memory_options = options;
+        if (!m_p_image->update()) {
+            LogMessage("could not allocate image buffer");
+            return DEVICE_ERR;
+        }
+        if ((options.lock && !m_p_image->is_buffer_locked()) || (options.huge_pages && !m_p_image->is_buffer_huge())) {
+            LogMessage("frame buffer allocated without locking or huge pages, missing privileges");
+        }
+        return DEVICE_OK;
+    }
+
+    FrameLayout ProkyonCamera::get_output_layout() const {
+        auto layout = m_p_image->get_layout();
+        if (m_user_stages.empty()) {
+            return layout;
+        }
+        try {
+            return m_p_snap_pipeline->compute_output_layout(layout);
+        }
+        catch (PipelineException) {
+            return layout;
+        }
+    }
+
+    const unsigned char *ProkyonCamera::get_output_buffer(unsigned channel) const {
+        if (m_user_stages.empty() || m_snap_frame.p_data == nullptr) {
+            return m_p_image->get_image_buffer(channel);
+        }
+        return m_snap_frame.p_data + channel * m_snap_frame.layout.plane_bytes();
+    }
+
+    void ProkyonCamera::insert_frame(const Frame &frame, bool stop_on_overflow) {
+        // deliveries are serialized by the pipeline, the lock only guards against update_frame_metadata
+        std::lock_guard<std::mutex> lock(m_metadata_mutex);
+        auto &md = m_frame_metadata;
+        md.put(MM::g_Keyword_Elapsed_Time_ms, std::to_string(frame.stamp.timestamp_us / 1000.0));
+        if (0 <= frame.stamp.sensor_counter) {
+            md.put(m_counter_key, std::to_string(frame.stamp.sensor_counter));
+        }
+        md.put(m_transaction_first_key, m_p_transaction->take_first_frame() ? "1" : "0");
+        const auto &layout = frame.layout;
+        for (unsigned channel = 0; channel < layout.channels; ++channel) {
+            md.put(MM::g_Keyword_CameraChannelIndex, std::to_string(channel));
+            md.put(MM::g_Keyword_CameraChannelName, (channel < m_channel_names.size()) ? m_channel_names[channel] : std::string{});
+            auto p_plane = frame.p_data + channel * layout.plane_bytes();
+            auto bytes_per_px = static_cast<unsigned>(layout.bytes_per_px());
+            auto ret = GetCoreCallback()->InsertImage(this, p_plane, layout.width, layout.height, bytes_per_px, md.Serialize().c_str());
+            if (ret == DEVICE_BUFFER_OVERFLOW) {
+                if (stop_on_overflow) {
+                    LogMessage("circular buffer overflow, stopping sequence acquisition");
+                    m_p_capture->request_stop();
+                    return;
+                }
+                GetCoreCallback()->ClearImageBuffer(this);
+                GetCoreCallback()->InsertImage(this, p_plane, layout.width, layout.height, bytes_per_px, md.Serialize().c_str(), false);
+            }
+        }
+    }
+
+    int ProkyonCamera::start_pipeline() {
+        // the plan of the last image update, made by every change of format, mode, roi or output,
+        // changes while capturing restart the pipeline through reconfigure
+        try {
+            m_p_convert_stage->set_plan(m_p_image->get_conversion_plan());
+        }
+        catch (ImageException) {
+            LogMessage("exception planning conversion");
+            return DEVICE_ERR;
+        }
+        update_frame_metadata();
+
+        std::vector<std::shared_ptr<Stage>> stages{m_p_convert_stage, m_p_observe_stage};
+        stages.insert(stages.end(), m_user_stages.begin(), m_user_stages.end());
+        try {
+            m_p_pipeline->set_stages(stages);
+            m_p_pipeline->start(m_p_convert_stage->get_plan().raw, m_pipeline_workers, m_pipeline_depth, [this](const Frame &frame) {
+                insert_frame(frame, m_stop_on_overflow);
+            });
+        }
+        catch (PipelineException) {
+            LogMessage("exception starting pipeline");
+            return DEVICE_ERR;
+        }
+        return DEVICE_OK;
     }
 
-    StringProperty *ProkyonCamera::get_string_property(MM::PropertyBase *p_prop) {
+    int ProkyonCamera::reconfigure(const std::string &what, const std::function<int()> &change) {
+        if (m_reconfiguring || m_p_capture == nullptr || !m_p_capture->pause()) {
+            auto ret = change();
+            m_p_coalescer->flush();
+            return ret;
+        }
+        m_reconfiguring = true;
+        m_last_reconfiguration = what;
+
+        // the sdk is not acquiring now, frames already captured are delivered with the old layout
+        m_p_pipeline->stop();
+        FrameLayout before{0, 0, 0, 0, 0, 0};
+        try { before = m_p_pipeline->compute_output_layout(m_p_convert_stage->get_plan().raw); }
+        catch (PipelineException) {}
+
+        auto ret = change();
+        // coalesced writes of the change land before the first frame with the new settings
+        m_p_coalescer->flush();
+        // slots are taken from the pool again, buffers are only allocated if the frames grew beyond them
+        auto started = start_pipeline();
+        if (started == DEVICE_OK) {
+            const auto after = m_p_pipeline->compute_output_layout(m_p_convert_stage->get_plan().raw);
+            if (after != before) {
+                GetCoreCallback()->InitializeImageBuffer(after.channels, 1, after.width, after.height, static_cast<unsigned>(after.bytes_per_px()));
+            }
+        }
+        else {
+            LogMessage("reconfiguration failed, stopping sequence acquisition");
+            m_p_capture->request_stop();
+        }
+        m_p_capture->resume(m_p_convert_stage->get_plan().raw.bytes());
+        m_reconfiguring = false;
+        return (ret != DEVICE_OK) ? ret : started;
+    }
+
+    int ProkyonCamera::update_coalescing_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_string_properties.count(name));
-        return m_string_properties.at(name).get();
+
+        if (name == M_S_WRITES_STATUS_NAME) {
+            if (type == MM::BeforeGet) {
+                const auto staged = m_p_coalescer->get_staged_count();
+                const auto written = m_p_coalescer->get_written_count();
+                std::stringstream ss;
+                ss << "staged " << staged << ", written " << written << ", skipped " << ((written < staged) ? staged - written : 0);
+                p_prop->Set(ss.str().c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+        log_property_name(name);
+
+        if (name == M_S_WRITES_MAX_RATE_NAME) {
+            double v = 0.0;
+            p_prop->Get(v);
+            m_p_coalescer->set_max_rate_hz(v);
+        }
+        else {
+            assert(false);
+        }
+        return DEVICE_OK;
     }
 
-    const StringProperty *ProkyonCamera::get_string_property(MM::PropertyBase *p_prop) const {
+    void ProkyonCamera::on_coalesced_write(DijSDK_EParamId id, bool success) {
+        if (success) { return; }
+        // read from the camera again on the next access
+        m_shadow.forget(id);
+        std::stringstream ss;
+        ss << "failed writing coalesced parameter " << id;
+        LogMessage(ss.str());
+    }
+
+    int ProkyonCamera::update_sequence_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_string_properties.count(name));
-        return m_string_properties.at(name).get();
+
+        if (name == M_S_SEQUENCE_LAST_SWITCH_NAME && type == MM::BeforeGet) {
+            // from the request to the first frame with the new settings, e.g. the first frame of a new roi,
+            // compared with the frame interval
+            auto ms = m_p_capture->get_last_switch_ms();
+            auto interval_ms = m_p_capture->get_interval_statistics().mean_ms;
+            std::stringstream ss;
+            ss << m_last_reconfiguration << " " << ms << " ms";
+            if (0.0 < interval_ms) {
+                ss << ", " << ms / interval_ms << " frame intervals";
+            }
+            p_prop->Set(ss.str().c_str());
+        }
+        else if (name == M_S_SEQUENCE_DROPPED_FRAMES_NAME && type == MM::BeforeGet) {
+            // gaps in the sensor counter, plus frames dropped for lack of a free pipeline slot
+            auto dropped = m_p_capture->get_sensor_drop_count() + m_p_pipeline->get_dropped_count();
+            p_prop->Set(static_cast<long>(dropped));
+        }
+        return DEVICE_OK;
     }
 
-    DiscreteSetProperty *ProkyonCamera::get_discrete_set_property(MM::PropertyBase *p_prop) {
+    int ProkyonCamera::update_preset_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_discrete_set_properties.count(name));
-        return m_discrete_set_properties.at(name).get();
+
+        if (name == M_S_PRESET_LAST_SWITCH_NAME) {
+            if (type == MM::BeforeGet) {
+                p_prop->Set(m_last_preset_switch.c_str());
+            }
+            return DEVICE_OK;
+        }
+        if (type != MM::AfterSet) { return DEVICE_OK; }
+        std::string v;
+        p_prop->Get(v);
+        if (v.empty()) { return DEVICE_OK; }
+        if (name == M_S_PRESET_SAVE_NAME) {
+            return save_preset(v);
+        }
+        else if (name == M_S_PRESET_APPLY_NAME) {
+            return apply_preset(v);
+        }
+        return DEVICE_OK;
     }
 
-    const DiscreteSetProperty *ProkyonCamera::get_discrete_set_property(MM::PropertyBase *p_prop) const {
+    int ProkyonCamera::save_preset(const std::string &name) {
+        if (m_p_presets == nullptr || m_p_roi == nullptr) { return DEVICE_NOT_CONNECTED; }
+        PresetStore::Values values;
+        char property_name[MM::MaxStrLength];
+        char value[MM::MaxStrLength];
+        for (unsigned i = 0; i < GetNumberOfProperties(); ++i) {
+            auto read_only = true;
+            if (!GetPropertyName(i, property_name) || GetPropertyReadOnly(property_name, read_only) != DEVICE_OK || read_only) {
+                continue;
+            }
+            if (M_S_PRESET_EXCLUDED.count(property_name) != 0) { continue; }
+            if (GetProperty(property_name, value) == DEVICE_OK) {
+                values[property_name] = value;
+            }
+        }
+        values[M_S_PRESET_ROI_KEY] = get_preset_value(M_S_PRESET_ROI_KEY);
+        values[M_S_PRESET_EXPOSURE_KEY] = get_preset_value(M_S_PRESET_EXPOSURE_KEY);
+
+        if (!m_p_presets->save(name, values)) {
+            LogMessage("failed saving preset " + name);
+            return DEVICE_ERR;
+        }
+        LogMessage("preset " + name + " saved to " + m_p_presets->get_path(name));
+        return DEVICE_OK;
+    }
+
+    int ProkyonCamera::apply_preset(const std::string &name) {
+        if (m_p_presets == nullptr || m_p_roi == nullptr) { return DEVICE_NOT_CONNECTED; }
+        PresetStore::Values values;
+        if (!m_p_presets->load(name, values)) {
+            LogMessage("failed loading preset " + name);
+            return DEVICE_ERR;
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+
+        std::vector<std::pair<std::string, std::string>> ordered(values.cbegin(), values.cend());
+        std::stable_sort(ordered.begin(), ordered.end(), [](const std::pair<std::string, std::string> &a, const std::pair<std::string, std::string> &b) {
+            return get_preset_rank(a.first) < get_preset_rank(b.first);
+        });
+        // sub regions set the roi to their bounding box themselves
+        const auto regions = values.find(M_S_SUB_REGIONS_NAME);
+        const auto has_regions = regions != values.cend() && !regions->second.empty();
+
+        unsigned changed = 0;
+        unsigned failed = 0;
+        auto ret = reconfigure("preset " + name, [&]() {
+            // compared one at a time, the current value may follow from an earlier change, e.g. the roi from the image mode
+            for (const auto &entry : ordered) {
+                if (entry.first == M_S_PRESET_ROI_KEY && has_regions) { continue; }
+                if (get_preset_value(entry.first) == entry.second) { continue; }
+                ++changed;
+                if (set_preset_value(entry.first, entry.second) != DEVICE_OK) {
+                    LogMessage("failed applying " + entry.first + " of preset " + name);
+                    ++failed;
+                }
+            }
+            return DEVICE_OK;
+        });
+
+        std::stringstream ss;
+        ss << name << ": " << changed << " of " << ordered.size() << " changed";
+        if (0 < failed) {
+            ss << ", " << failed << " failed";
+        }
+        ss << ", " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() << " ms";
+        m_last_preset_switch = ss.str();
+        LogMessage("preset " + m_last_preset_switch);
+        return ret;
+    }
+
+    std::string ProkyonCamera::get_preset_value(const std::string &key) {
+        if (key == M_S_PRESET_ROI_KEY) {
+            return regions_to_string({m_p_roi->get()});
+        }
+        if (key == M_S_PRESET_EXPOSURE_KEY) {
+            return std::to_string(GetExposure());
+        }
+        // through the handler, so from the shadow, which the image mode, clipping and the poller keep to the camera's values
+        char value[MM::MaxStrLength];
+        if (!HasProperty(key.c_str()) || GetProperty(key.c_str(), value) != DEVICE_OK) { return ""; }
+        return value;
+    }
+
+    int ProkyonCamera::set_preset_value(const std::string &key, const std::string &value) {
+        if (key == M_S_PRESET_ROI_KEY) {
+            if (value.empty()) { return ClearROI(); }
+            std::vector<ROI> regions;
+            if (!parse_regions(value, regions) || regions.size() != 1) { return DEVICE_INVALID_PROPERTY_VALUE; }
+            const auto &roi = regions[0];
+            return SetROI(roi[X_ind], roi[Y_ind], roi[W_ind], roi[H_ind]);
+        }
+        if (key == M_S_PRESET_EXPOSURE_KEY) {
+            try { SetExposure(std::stod(value)); }
+            catch (std::logic_error) { return DEVICE_INVALID_PROPERTY_VALUE; }
+            return DEVICE_OK;
+        }
+        // e.g. a property of another firmware
+        if (!HasProperty(key.c_str())) { return DEVICE_INVALID_PROPERTY; }
+        return this->SetProperty(key.c_str(), value.c_str());
+    }
+
+    int ProkyonCamera::get_preset_rank(const std::string &key) {
+        // the image mode resizes the sensor area and resets the roi, the exposure range depends on both
+        if (key == M_S_IMAGE_MODE_NAME || key == M_S_BINNING_NAME) { return 0; }
+        if (key == M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME) { return 1; }
+        if (key == M_S_SUB_REGIONS_NAME) { return 2; }
+        if (key == M_S_PRESET_ROI_KEY) { return 3; }
+        if (key == M_S_PRESET_EXPOSURE_KEY) { return 4; }
+        return 5;
+    }
+
+    int ProkyonCamera::update_transaction_property(MM::PropertyBase *p_prop, MM::ActionType type) {
         auto name = get_mm_property_name(p_prop);
-        assert(m_discrete_set_properties.count(name));
-        return m_discrete_set_properties.at(name).get();
+
+        if (name == M_S_TRANSACTION_STATUS_NAME) {
+            if (type == MM::BeforeGet) {
+                auto status = is_transaction_open() ? "open, " + std::to_string(m_p_transaction->get_staged_count()) + " staged" : m_last_transaction;
+                p_prop->Set(status.c_str());
+            }
+            return DEVICE_OK;
+        }
+        if (type != MM::AfterSet) { return DEVICE_OK; }
+        log_property_name(name);
+
+        std::string v;
+        p_prop->Get(v);
+        auto out = DEVICE_OK;
+        if (name == M_S_TRANSACTION_BEGIN_NAME && v == "Begin") {
+            begin_transaction();
+        }
+        else if (name == M_S_TRANSACTION_COMMIT_NAME && v == "Commit") {
+            out = commit_transaction();
+        }
+        else if (name == M_S_TRANSACTION_COMMIT_NAME && v == "Discard") {
+            discard_transaction();
+        }
+        p_prop->Set("Idle");
+        return out;
     }
 
-    std::string ProkyonCamera::get_mm_property_name(MM::PropertyBase *p_prop) const {
-        auto name = p_prop->GetName();
-        return name;
+    Transaction::Hooks ProkyonCamera::make_transaction_hooks() {
+        Transaction::Hooks hooks;
+        hooks.check_settable = [this](const std::string &key) {
+            // e.g. a property of another firmware
+            if (!HasProperty(key.c_str())) { return Transaction::Check::invalid_key; }
+            auto read_only = true;
+            if (GetPropertyReadOnly(key.c_str(), read_only) != DEVICE_OK || read_only) { return Transaction::Check::read_only; }
+            return Transaction::Check::ok;
+        };
+        hooks.find_numeric = [this](const std::string &key) -> const NumericProperty * {
+            for (const auto &property : m_sdk_properties) {
+                if (property.name == key && property.p_numeric != nullptr) { return property.p_numeric.get(); }
+            }
+            return nullptr;
+        };
+        // everything else as the core checks it, allowed values or limits
+        hooks.check_other = [this](const std::string &key, const std::string &value) {
+            const auto count = GetNumberOfPropertyValues(key.c_str());
+            if (0 < count) {
+                char allowed[MM::MaxStrLength];
+                for (unsigned i = 0; i < count; ++i) {
+                    if (GetPropertyValueAt(key.c_str(), i, allowed) && value == allowed) { return Transaction::Check::ok; }
+                }
+                return Transaction::Check::invalid_value;
+            }
+            auto has_limits = false;
+            if (HasPropertyLimits(key.c_str(), has_limits) == DEVICE_OK && has_limits) {
+                double v = 0.0;
+                try { v = std::stod(value); }
+                catch (std::logic_error) { return Transaction::Check::invalid_value; }
+                double lower = 0.0;
+                double upper = 0.0;
+                GetPropertyLowerLimit(key.c_str(), lower);
+                GetPropertyUpperLimit(key.c_str(), upper);
+                return (lower <= v && v <= upper) ? Transaction::Check::ok : Transaction::Check::invalid_value;
+            }
+            return Transaction::Check::ok;
+        };
+        hooks.rank = &ProkyonCamera::get_preset_rank;
+        hooks.apply = [this](const std::string &key, const std::string &value) {
+            if (set_preset_value(key, value) == DEVICE_OK) { return true; }
+            LogMessage("failed applying " + key + " of transaction " + std::to_string(m_p_transaction->get_number() + 1));
+            return false;
+        };
+        return hooks;
+    }
+
+    int ProkyonCamera::to_error_code(Transaction::Check check) {
+        switch (check) {
+            case Transaction::Check::ok: return DEVICE_OK;
+            case Transaction::Check::invalid_value: return DEVICE_INVALID_PROPERTY_VALUE;
+            case Transaction::Check::invalid_key: return DEVICE_INVALID_PROPERTY;
+            case Transaction::Check::read_only: return DEVICE_CAN_NOT_SET_PROPERTY;
+            default: return DEVICE_ERR;
+        }
     }
 
-    template<>
-    int ProkyonCamera::s_to_num<int>(const std::string &s) {
-        return std::stoi(s);
+    void ProkyonCamera::update_frame_metadata() {
+        char label[MM::MaxStrLength];
+        this->GetLabel(label);
+        const std::string prefix = std::string{label} + "-";
+        Metadata md;
+        md.put(MM::g_Keyword_Metadata_CameraLabel, label);
+        md.put(MM::g_Keyword_Metadata_Exposure, std::to_string(GetExposure()));
+        char value[MM::MaxStrLength];
+        if (HasProperty(M_S_GAIN_NAME.c_str()) && GetProperty(M_S_GAIN_NAME.c_str(), value) == DEVICE_OK) {
+            md.put(prefix + M_S_GAIN_NAME, value);
+        }
+        if (GetProperty(M_S_IMAGE_MODE_NAME.c_str(), value) == DEVICE_OK) {
+            md.put(prefix + M_S_IMAGE_MODE_NAME, value);
+        }
+        md.put(MM::g_Keyword_Metadata_ROI_X, std::to_string(m_p_roi->x()));
+        md.put(MM::g_Keyword_Metadata_ROI_Y, std::to_string(m_p_roi->y()));
+        md.put(MM::g_Keyword_Metadata_Width, std::to_string(m_p_roi->w()));
+        md.put(MM::g_Keyword_Metadata_Height, std::to_string(m_p_roi->h()));
+        // settings of frames tagged with the same number came from the same commit
+        md.put(prefix + "Transaction", std::to_string(m_p_transaction->get_number()));
+        // values of that commit the camera did not take, its frames then have none tagged first
+        md.put(prefix + "TransactionFailed", std::to_string(m_p_transaction->get_failed_count()));
+
+        std::vector<std::string> channel_names;
+        for (unsigned channel = 0; channel < m_p_image->get_number_of_channels(); ++channel) {
+            channel_names.push_back(m_p_image->get_channel_name(channel));
+        }
+
+        std::lock_guard<std::mutex> lock(m_metadata_mutex);
+        m_frame_metadata = md;
+        m_counter_key = prefix + "SensorImageCounter";
+        m_transaction_first_key = prefix + "TransactionFirstFrame";
+        m_channel_names = channel_names;
+    }
+
+    void ProkyonCamera::clear_sub_regions() {
+        if (m_p_image->get_crops().empty()) {
+            return;
+        }
+        m_p_image->set_crops({});
+        this->SetProperty(M_S_SUB_REGIONS_NAME.c_str(), "");
+        this->OnPropertyChanged(M_S_SUB_REGIONS_NAME.c_str(), "");
     }
 
-    template<>
-    double ProkyonCamera::s_to_num<double>(const std::string &s) {
-        return std::stod(s);
+    std::string ProkyonCamera::update_exception_msg(std::string name) {
+        return "exception updating property " + name;
+    }
+
+    NumericProperty *ProkyonCamera::get_numeric_property(long index) {
+        assert(0 <= index && static_cast<std::size_t>(index) < m_sdk_properties.size());
+        assert(m_sdk_properties[index].p_numeric != nullptr);
+        return m_sdk_properties[index].p_numeric.get();
+    }
+
+    BoolProperty *ProkyonCamera::get_bool_property(long index) {
+        assert(0 <= index && static_cast<std::size_t>(index) < m_sdk_properties.size());
+        assert(m_sdk_properties[index].p_bool != nullptr);
+        return m_sdk_properties[index].p_bool.get();
+    }
+
+    StringProperty *ProkyonCamera::get_string_property(long index) {
+        assert(0 <= index && static_cast<std::size_t>(index) < m_sdk_properties.size());
+        assert(m_sdk_properties[index].p_string != nullptr);
+        return m_sdk_properties[index].p_string.get();
+    }
+
+    DiscreteSetProperty *ProkyonCamera::get_discrete_set_property(long index) {
+        assert(0 <= index && static_cast<std::size_t>(index) < m_sdk_properties.size());
+        assert(m_sdk_properties[index].p_set != nullptr);
+        return m_sdk_properties[index].p_set.get();
+    }
+
+    std::string ProkyonCamera::get_mm_property_name(MM::PropertyBase *p_prop) const {
+        auto name = p_prop->GetName();
+        return name;
     }
 
     void ProkyonCamera::log_property_name(const std::string &name) const {
@@ -725,4 +2597,121 @@ namespace Prokyon {
     const std::string ProkyonCamera::M_S_VIRTUAL_IMAGE_MODE_NAME{"Virtual Image Mode"};
     const std::string ProkyonCamera::M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME{"Image Processing-Color Mode"};
     const std::string ProkyonCamera::M_S_BINNING_NAME{MM::g_Keyword_Binning};
+    const std::string ProkyonCamera::M_S_OUTPUT_MODE_NAME{"Output-Mode"};
+    const std::string ProkyonCamera::M_S_LUMINANCE_WEIGHTS_NAME{"Output-Luminance Weights (R | G | B)"};
+    const std::map<std::string, OutputMode> ProkyonCamera::M_S_OUTPUT_MODES{
+        {"Native", OutputMode::Native},
+        {"Luminance 8 bpp", OutputMode::Luminance8},
+        {"Luminance 16 bpp", OutputMode::Luminance16}
+    };
+    const std::string ProkyonCamera::M_S_PREVIEW_DECIMATION_NAME{"Preview-Decimation"};
+    const std::string ProkyonCamera::M_S_PREVIEW_AUTO_SCALE_NAME{"Preview-Auto Scale 8 bpp"};
+    const std::string ProkyonCamera::M_S_PREVIEW_MAX_RATE_NAME{"Preview-Max Rate (Hz)"};
+    const std::string ProkyonCamera::M_S_PREVIEW_SIZE_NAME{"Preview-Size (px)"};
+    const std::string ProkyonCamera::M_S_PREVIEW_PUBLISH_NAME{"Preview-Publish To Shared Memory"};
+    const std::string ProkyonCamera::M_S_SUB_REGIONS_NAME{"ROI-Sub Regions (x, y, w, h; ...)"};
+    const std::string ProkyonCamera::M_S_CHARACTERIZATION_EXPOSURES_NAME{"Characterization-Exposures (ms)"};
+    const std::string ProkyonCamera::M_S_CHARACTERIZATION_GAINS_NAME{"Characterization-Gains"};
+    const std::string ProkyonCamera::M_S_CHARACTERIZATION_FRAMES_NAME{"Characterization-Frames Per Step"};
+    const std::string ProkyonCamera::M_S_CHARACTERIZATION_REPORT_NAME{"Characterization-Report File"};
+    const std::string ProkyonCamera::M_S_CHARACTERIZATION_RUN_NAME{"Characterization-Run"};
+    const std::string ProkyonCamera::M_S_CHARACTERIZATION_RESULT_NAME{"Characterization-Result"};
+    const std::string ProkyonCamera::M_S_FOCUS_METRIC_ENABLED_NAME{"Focus Metric-Enabled"};
+    const std::string ProkyonCamera::M_S_FOCUS_METRIC_ROI_NAME{"Focus Metric-ROI (x, y, w, h)"};
+    const std::string ProkyonCamera::M_S_FOCUS_METRIC_VALUE_NAME{"Focus Metric-Value"};
+    const std::string ProkyonCamera::M_S_PUBLISHER_ENABLED_NAME{"Shared Memory-Enabled"};
+    const std::string ProkyonCamera::M_S_PUBLISHER_NAME_NAME{"Shared Memory-Name"};
+    const std::string ProkyonCamera::M_S_PUBLISHER_SLOTS_NAME{"Shared Memory-Slots"};
+    const std::string ProkyonCamera::M_S_PUBLISHER_SLOT_SIZE_NAME{"Shared Memory-Slot Size (MB, 0 for current frame)"};
+    const std::string ProkyonCamera::M_S_PUBLISHER_STATUS_NAME{"Shared Memory-Status"};
+    const std::string ProkyonCamera::M_S_PIPELINE_STAGES_NAME{"Pipeline-Stages (bin <n>; statistics; plugin <path> [config])"};
+    const std::string ProkyonCamera::M_S_PIPELINE_WORKERS_NAME{"Pipeline-Workers"};
+    const std::string ProkyonCamera::M_S_PIPELINE_DEPTH_NAME{"Pipeline-Depth (frames)"};
+    const std::string ProkyonCamera::M_S_PIPELINE_TIMING_NAME{"Pipeline-Timing"};
+    const std::string ProkyonCamera::M_S_THREADS_CAPTURE_CORES_NAME{"Threads-Capture Cores (0, 1, ...)"};
+    const std::string ProkyonCamera::M_S_THREADS_WORKER_CORES_NAME{"Threads-Worker Cores (one per worker)"};
+    const std::string ProkyonCamera::M_S_THREADS_RAISE_PRIORITY_NAME{"Threads-Raise Priority"};
+    const std::string ProkyonCamera::M_S_THREADS_STATUS_NAME{"Threads-Status"};
+    const std::string ProkyonCamera::M_S_MEMORY_LOCK_NAME{"Memory-Lock Buffers"};
+    const std::string ProkyonCamera::M_S_MEMORY_HUGE_PAGES_NAME{"Memory-Huge Pages"};
+    const std::string ProkyonCamera::M_S_MEMORY_BUDGET_NAME{"Memory-Budget (MB)"};
+    const std::string ProkyonCamera::M_S_MEMORY_STATUS_NAME{"Memory-Status"};
+    const std::string ProkyonCamera::M_S_SEQUENCE_LAST_SWITCH_NAME{"Sequence-Last Reconfiguration"};
+    const std::string ProkyonCamera::M_S_SEQUENCE_DROPPED_FRAMES_NAME{"Sequence-Dropped Frames"};
+    const std::string ProkyonCamera::M_S_WRITES_MAX_RATE_NAME{"Property Writes-Max Rate (Hz, 0 for every frame)"};
+    const std::string ProkyonCamera::M_S_WRITES_STATUS_NAME{"Property Writes-Status"};
+    const std::string ProkyonCamera::M_S_GAIN_NAME{"Image Capture-Gain Target"};
+    const std::string ProkyonCamera::M_S_INITIALIZATION_NAME{"Global-Initialization"};
+    const std::string ProkyonCamera::M_S_PRESET_SAVE_NAME{"Presets-Save As"};
+    const std::string ProkyonCamera::M_S_PRESET_APPLY_NAME{"Presets-Apply"};
+    const std::string ProkyonCamera::M_S_PRESET_LAST_SWITCH_NAME{"Presets-Last Switch"};
+    const std::string ProkyonCamera::M_S_PRESET_ROI_KEY{"ROI (x, y, w, h)"};
+    const std::string ProkyonCamera::M_S_PRESET_EXPOSURE_KEY{"Exposure (ms)"};
+    const std::string ProkyonCamera::M_S_TRANSACTION_BEGIN_NAME{"Transaction-Begin"};
+    const std::string ProkyonCamera::M_S_TRANSACTION_COMMIT_NAME{"Transaction-Commit"};
+    const std::string ProkyonCamera::M_S_TRANSACTION_STATUS_NAME{"Transaction-Status"};
+    const std::set<std::string> ProkyonCamera::M_S_PRESET_EXCLUDED{
+        M_S_BINNING_NAME,
+        M_S_CHARACTERIZATION_RUN_NAME,
+        M_S_PRESET_SAVE_NAME,
+        M_S_PRESET_APPLY_NAME,
+        M_S_TRANSACTION_BEGIN_NAME,
+        M_S_TRANSACTION_COMMIT_NAME,
+    };
+    const std::set<std::string> ProkyonCamera::M_S_TRANSACTION_EXCLUDED{
+        M_S_CHARACTERIZATION_RUN_NAME,
+        M_S_PRESET_SAVE_NAME,
+        M_S_PRESET_APPLY_NAME,
+        M_S_TRANSACTION_BEGIN_NAME,
+        M_S_TRANSACTION_COMMIT_NAME,
+    };
+    const std::map<DijSDK_EParamId, std::string> ProkyonCamera::M_S_DISPLAY_NAMES{
+        {ParameterIdImageCaptureGain, M_S_GAIN_NAME},
+        {ParameterIdImageProcessingGammaCorrection, "Image Processing-Gamma"},
+        {ParameterIdImageProcessingHighDynamicRange, "Image Processing-HDR-Enabled"},
+        {ParameterIdImageProcessingHdrWeight, "Image Processing-HDR-Weight"},
+        {ParameterIdImageProcessingHdrColorGamma, "Image Processing-HDR-Gamma"},
+        {ParameterIdImageProcessingHdrSmoothFieldSize, "Image Processing-HDR-Smooth Field Size"},
+        {ParameterIdImageProcessingColorBalance, "Image Processing-HDR-Color Balance"},
+        {ParameterIdImageProcessingColorBalKeepBrightness, "Image Processing-HDR-Color Balance-Keep Brightness?"},
+        {ParameterIdSensorSize, "Sensor-Size (px)"},
+        {ParameterIdSensorPixelSizeUm, "Sensor-Pixel Size (um)"},
+        {ParameterIdImageModeSubsampling, "Image Mode-Subsampling Bin Size (px)"},
+        {ParameterIdImageModeSumming, "Image Mode-Summing Bin Size (px)"},
+        {ParameterIdGlobalSettingsCameraName, "Global-Camera Name"},
+    };
+    const std::set<DijSDK_EParamId> ProkyonCamera::M_S_UNLISTED_PARAMETERS{
+        // core exposure, ROI and binning
+        ParameterIdImageCaptureExposureTimeUsec,
+        ParameterIdImageCaptureRoi,
+        ParameterIdImageModeAveraging,
+        // essential properties, see setup_image_mode_property
+        ParameterIdImageModeIndex,
+        ParameterIdImageModeVirtualIndex,
+        ParameterIdImageModeName,
+        ParameterIdImageProcessingOutputFormat,
+        // the focus drive device
+        ParameterIdCameraFeaturesZPosition,
+        // changes the frames the sdk hands over
+        ParameterIdImageProcessingAttachRawImages,
+        // change on their own, a shadowed value would be stale
+        ParameterIdSensorImageCounter,
+        ParameterIdExposureControlStatus,
+        ParameterIdImageProcessingSecondaryError,
+        // TODO better error checking
+        ParameterIdGlobalSettingsCameraSerialNumber,
+    };
+    const std::set<DijSDK_EParamId> ProkyonCamera::M_S_COALESCED_PARAMETERS{
+        ParameterIdImageCaptureGain,
+        ParameterIdImageProcessingGammaCorrection,
+        ParameterIdImageProcessingContrast,
+        ParameterIdImageProcessingSaturation,
+    };
+    const std::vector<ProkyonCamera::PropertyDefinition> ProkyonCamera::M_S_DEFERRED_PROPERTIES = ProkyonCamera::make_deferred_properties();
+    const std::map<std::string, unsigned> ProkyonCamera::M_S_PREVIEW_DECIMATIONS{
+        {"Off", 1u},
+        {"2", 2u},
+        {"4", 4u},
+        {"8", 8u}
+    };
 } // namespace Prokyon
\ No newline at end of file
@@ -4,18 +4,45 @@
 #define PROKYONCAMERA_H_
 
 #include "MMDevice/DeviceBase.h"
+#include "MMDevice/ImageMetadata.h"
 
+#include "Capture.h"
+#include "BufferPool.h"
+#include "Conversion.h"
+#include "Focus.h"
+#include "FramePublisher.h"
+#include "ModeCatalogue.h"
+#include "ParameterCoalescer.h"
+#include "ParameterRegistry.h"
+#include "ParameterShadow.h"
 #include "Parameters.h"
+#include "Pipeline.h"
+#include "PipelineStages.h"
+#include "PresetStore.h"
+#include "RegionOfInterest.h"
+#include "Scheduling.h"
+#include "SensorCharacterization.h"
+#include "Transaction.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace Prokyon {
     class Camera;
     class Image;
-    class RegionOfInterest;
     class AcquisitionParameters;
+    struct PreviewFrame;
 
     class ProkyonCamera : public CCameraBase<ProkyonCamera> {
         using Camera = ::Prokyon::Camera;
@@ -28,13 +55,21 @@ namespace Prokyon {
         int Shutdown(); // done
         void GetName(char *name) const; // done
 
-        //debug
+        // properties, the deferred sdk properties are created on the first of these after the initialization thread is done,
+        // one asking for a name not known yet waits for that thread first, see adopt_deferred_properties
+        using CCameraBase<ProkyonCamera>::GetProperty;
         int GetProperty(const char *name, char *value) const;
         int SetProperty(const char *name, const char *value);
+        bool HasProperty(const char *name) const;
+        unsigned GetNumberOfProperties() const; // never waits, a listing before the thread is done lacks the deferred properties
 
         // camera
         int SnapImage();
         const unsigned char *GetImageBuffer();
+        const unsigned char *GetImageBuffer(unsigned channel);
+        unsigned GetNumberOfChannels() const;
+        int GetChannelName(unsigned channel, char *name);
+        int InsertImage();
         unsigned GetNumberOfComponents() const;
         int GetComponentName(unsigned component, char *name);
         long GetImageBufferSize() const;
@@ -51,62 +86,292 @@ namespace Prokyon {
         int GetROI(unsigned &x, unsigned &y, unsigned &xSize, unsigned &ySize);
         int ClearROI();
         int IsExposureSequenceable(bool &isSequenceable) const;
+        // frames are converted and processed by the pipeline workers, see Capture and Pipeline
+        int StartSequenceAcquisition(long numImages, double interval_ms, bool stopOnOverflow);
+        int StartSequenceAcquisition(double interval_ms);
+        int StopSequenceAcquisition();
+        int PrepareSequenceAcqusition();
+        bool IsCapturing();
+
+        // decimated preview of the latest converted frame, see Preview
+        std::shared_ptr<const PreviewFrame> get_preview_frame() const;
+
+        // z drive, shared with ProkyonFocus
+        FocusDrive *get_focus_drive();
+        Autofocus *get_autofocus();
+        int run_autofocus(const Autofocus::Settings &settings); // returns MM error code
+
+        // values staged together and applied as one reconfiguration, between two frames of a running sequence,
+        // while open SetProperty, SetExposure and SetROI stage instead of applying, keys as for presets
+        void begin_transaction(); // discards one not committed
+        int stage_transaction_value(const std::string &key, const std::string &value); // checked against the cached ranges, returns MM error code
+        int commit_transaction(); // the first frame after it is tagged, returns MM error code
+        void discard_transaction();
+        bool is_transaction_open() const;
+
+        // the initialized camera of this module, nullptr before Initialize and after Shutdown
+        static ProkyonCamera *get_instance();
 
     public:
         static const char *get_name(); // done
         static const char *get_description(); // done
 
     private:
-        void setup_numeric_property(DijSDK_EParamId id, std::string id_name, std::string display_name);
-        void setup_bool_property(DijSDK_EParamId id, std::string id_name, std::string display_name);
-        void setup_string_property(DijSDK_EParamId id, std::string id_name, std::string display_name);
+        enum class PropertyKind {
+            numeric,
+            boolean,
+            string,
+        };
+        struct PropertyDefinition {
+            PropertyKind kind;
+            DijSDK_EParamId id;
+            std::string id_name;
+            std::string display_name;
+        };
+        // everything the core property needs, queried from the sdk ahead of its creation
+        struct PendingProperty {
+            PropertyDefinition definition;
+            std::string value;
+            bool read_only;
+            std::vector<std::string> allowed_values; // empty for any value
+            std::unique_ptr<NumericProperty> p_numeric; // one of these, as the kind says
+            std::unique_ptr<BoolProperty> p_bool;
+            std::unique_ptr<StringProperty> p_string;
+        };
+        // an sdk backed core property, its registry index is passed to the handler
+        struct SdkProperty {
+            std::string name; // empty until created
+            std::unique_ptr<NumericProperty> p_numeric; // one of these
+            std::unique_ptr<BoolProperty> p_bool;
+            std::unique_ptr<StringProperty> p_string;
+            std::unique_ptr<DiscreteSetProperty> p_set;
+        };
+        static std::vector<PropertyDefinition> make_deferred_properties(); // from the registry
+
+        void setup_property(const PropertyDefinition &definition); // query and create now
+        bool query_property(const PropertyDefinition &definition, PendingProperty &pending) const; // returns if it exists, throws PropertyException
+        void create_property(PendingProperty &pending);
+        // initialization thread, queries the non-essential properties
+        void initialize_deferred(std::chrono::steady_clock::time_point t0);
+        // creates the queried properties on the calling core thread once the initialization thread is done,
+        // waiting for it if asked to, returns if there were any, never on the initialization thread itself
+        bool adopt_deferred_properties(bool wait);
+        // for the core's const accessors, waits if name is not a property yet
+        void adopt_deferred_properties_for(const char *name) const;
+        void setup_initialization_property();
+        // poller thread, notifies the core of values the camera changed itself, see ParameterShadow
+        void poll_parameters();
+        void stop_polling();
+        int update_initialization_property(MM::PropertyBase *p_prop, MM::ActionType type);
         void setup_image_mode_property();
+        ModeCatalogue::Mode query_image_mode(int index) const; // of the virtual image mode, which is set to index
+        void setup_binning_property();
+        void setup_output_properties();
+        void setup_preview_properties();
+        void setup_sub_regions_property();
+        void setup_characterization_properties();
+        void setup_focus_metric_properties();
+        void setup_publisher_properties();
+        void setup_pipeline_properties();
+        void setup_thread_properties();
+        void setup_memory_properties();
+        void setup_sequence_properties();
+        void setup_preset_properties();
+        void setup_coalescing_properties();
+        void setup_transaction_properties();
         bool check_property(PropertyBase *p_property, std::string id_name) const; // returns success
 
-        int update_numeric_property(MM::PropertyBase *p_prop, MM::ActionType type);
-        int update_bool_property(MM::PropertyBase *p_prop, MM::ActionType type);
-        int update_string_property(MM::PropertyBase *p_prop, MM::ActionType type);
-        int update_discrete_set_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        // index into the registry, see SdkProperty
+        int update_numeric_property(MM::PropertyBase *p_prop, MM::ActionType type, long index);
+        int update_bool_property(MM::PropertyBase *p_prop, MM::ActionType type, long index);
+        int update_string_property(MM::PropertyBase *p_prop, MM::ActionType type, long index);
+        int update_discrete_set_property(MM::PropertyBase *p_prop, MM::ActionType type, long index);
         // special case for image mode index and virtual image mode index
-        int update_image_mode_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int update_image_mode_property(MM::PropertyBase *p_prop, MM::ActionType type, long index);
+        void invalidate_property_ranges(); // of all sdk properties, see NumericProperty
+        // picks the image mode, see SetBinning
+        int update_binning_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        // adapter side output conversion, not backed by hardware parameters
+        int update_output_mode_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int update_luminance_weights_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int update_preview_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int update_sub_regions_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        void clear_sub_regions();
+        // photon transfer sweep, runs synchronously when triggered
+        int update_characterization_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int update_focus_metric_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        // shared memory ring for other processes, see FramePublisher
+        int update_publisher_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int open_publisher();
+        // user stages after conversion, for snaps and sequences
+        int update_pipeline_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        FrameLayout get_output_layout() const; // of snapped images
+        const unsigned char *get_output_buffer(unsigned channel) const;
+        void insert_frame(const Frame &frame, bool stop_on_overflow); // pipeline delivery during sequences
+        int start_pipeline(); // conversion plan and stages for the current settings, returns MM error code
+        // runs change between two frames of a running sequence, the pipeline restarts for the new layout,
+        // directly if not capturing or already reconfiguring, returns the result of change
+        int reconfigure(const std::string &what, const std::function<int()> &change);
+        int update_sequence_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        // rate of coalesced writes, see ParameterCoalescer
+        int update_coalescing_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        void on_coalesced_write(DijSDK_EParamId id, bool success); // on the coalescer thread
+        void update_frame_metadata(); // tags fixed between reconfigurations, not read per frame
+        // named snapshots of all writable properties, roi and exposure, see PresetStore
+        int update_preset_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int save_preset(const std::string &name);
+        // sets only what differs from the current values, in dependency order, as one reconfiguration
+        int apply_preset(const std::string &name);
+        std::string get_preset_value(const std::string &key); // current value, sdk parameters from the shadow
+        int set_preset_value(const std::string &key, const std::string &value); // returns MM error code
+        static int get_preset_rank(const std::string &key); // lower ranks are applied first
+        int update_transaction_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        Transaction::Hooks make_transaction_hooks(); // checks and applies through the properties of this device
+        static int to_error_code(Transaction::Check check); // MM error code
+        // affinity and priority of the capture thread and pipeline workers, applied at sequence start
+        int update_thread_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        void apply_thread_policies();
+        // locking and huge pages of frame buffers
+        int update_memory_property(MM::PropertyBase *p_prop, MM::ActionType type);
         static std::string update_exception_msg(std::string id_name);
 
-        NumericProperty *get_numeric_property(MM::PropertyBase *p_prop);
-        const NumericProperty *get_numeric_property(MM::PropertyBase *p_prop) const;
-        BoolProperty *get_bool_property(MM::PropertyBase *p_prop);
-        const BoolProperty *get_bool_property(MM::PropertyBase *p_prop) const;
-        StringProperty *get_string_property(MM::PropertyBase *p_prop);
-        const StringProperty *get_string_property(MM::PropertyBase *p_prop) const;
-        DiscreteSetProperty *get_discrete_set_property(MM::PropertyBase *p_prop);
-        const DiscreteSetProperty *get_discrete_set_property(MM::PropertyBase *p_prop) const;
+        NumericProperty *get_numeric_property(long index);
+        BoolProperty *get_bool_property(long index);
+        StringProperty *get_string_property(long index);
+        DiscreteSetProperty *get_discrete_set_property(long index);
         std::string get_mm_property_name(MM::PropertyBase *p_prop) const;
 
         template<typename T>
         std::vector<T> get_numeric_value(MM::PropertyBase *p_prop, bool &success) const;
         template<typename T>
         void set_numeric_value(std::vector<T> values, MM::PropertyBase *p_prop);
-        template<typename T>
-        static T s_to_num(const std::string &s);
 
         void log_property_name(const std::string &name) const;
 
         std::unique_ptr<Camera> m_p_camera;
+        std::unique_ptr<BufferPool> m_p_pool; // outlives everything holding its buffers
         std::unique_ptr<Image> m_p_image;
         std::unique_ptr<AcquisitionParameters> m_p_acq_parameters;
         std::unique_ptr<RegionOfInterest> m_p_roi;
+        std::unique_ptr<ModeCatalogue> m_p_catalogue; // of earlier starts, see setup_image_mode_property
+        std::string m_image_mode_name; // empty if the current mode is unknown
+        ModeCatalogue::Mode m_image_mode;
+        std::unique_ptr<PresetStore> m_p_presets;
+        std::string m_last_preset_switch;
+        std::unique_ptr<NumericProperty> m_p_exposure; // range only, for checking staged exposures
+        std::unique_ptr<Transaction> m_p_transaction; // staged values, commits since initialize
+        std::string m_last_transaction;
+        std::thread m_init_thread;
+        std::atomic<bool> m_init_cancel;
+        std::atomic<bool> m_init_complete;
+        mutable std::mutex m_init_mutex;
+        std::condition_variable m_init_done; // m_init_complete or m_init_cancel was set
+        std::vector<PendingProperty> m_pending_properties;
+        std::string m_init_status;
+        mutable ParameterShadow m_shadow; // property reads are served from here, not from the camera
+        std::atomic<std::uint64_t> m_exposure_writes; // twice per SetExposure, before and after the write, see poll_parameters
+        std::thread m_poll_thread;
+        std::atomic<bool> m_poll_cancel;
+        std::mutex m_poll_mutex;
+        std::condition_variable m_poll_cv;
+        std::unique_ptr<SensorCharacterization> m_p_characterization;
+        SensorCharacterization::Settings m_characterization_settings;
+        std::unique_ptr<FocusDrive> m_p_focus_drive;
+        std::unique_ptr<Autofocus> m_p_autofocus;
+        FramePublisher::Settings m_publisher_settings;
+        bool m_publisher_enabled;
+        std::shared_ptr<ConvertStage> m_p_convert_stage;
+        std::shared_ptr<ObserveStage> m_p_observe_stage; // right after conversion, ordered
+        std::vector<std::shared_ptr<Stage>> m_user_stages;
+        std::string m_pipeline_spec;
+        unsigned m_pipeline_workers;
+        unsigned m_pipeline_depth;
+        std::unique_ptr<Pipeline> m_p_pipeline; // convert and user stages, sequences
+        std::unique_ptr<Pipeline> m_p_snap_pipeline; // user stages only, snaps
+        Frame m_snap_frame; // output of the snap pipeline, no data without user stages
+        std::unique_ptr<Capture> m_p_capture;
+        std::unique_ptr<ParameterCoalescer> m_p_coalescer; // slider parameters, see M_S_COALESCED_PARAMETERS
+        bool m_stop_on_overflow; // of the running sequence
+        bool m_reconfiguring;
+        std::string m_last_reconfiguration; // what changed, for the switch latency
+        // one object for all frames, insert_frame only overwrites the per frame tags
+        std::mutex m_metadata_mutex;
+        Metadata m_frame_metadata;
+        std::string m_counter_key;
+        std::string m_transaction_first_key;
+        std::vector<std::string> m_channel_names;
+        std::vector<unsigned> m_capture_cores;
+        std::vector<unsigned> m_worker_cores; // one per worker, in turn
+        bool m_raise_thread_priority;
+        FrameBuffer::Options m_memory_options;
+        std::size_t m_memory_budget;
 
-        std::map<std::string, std::unique_ptr<StringProperty>> m_string_properties;
-        std::map<std::string, std::unique_ptr<NumericProperty>> m_numeric_properties;
-        std::map<std::string, std::unique_ptr<BoolProperty>> m_bool_properties;
-        std::map<std::string, std::unique_ptr<DiscreteSetProperty>> m_discrete_set_properties;
+        std::vector<SdkProperty> m_sdk_properties; // one per registry entry
 
         static const DijSDK_CameraKey M_S_KEY;
+        static const unsigned M_S_POLL_INTERVAL_MS = 1000u;
         static const std::string M_S_CAMERA_NAME;
         static const std::string M_S_CAMERA_DESCRIPTION;
         static const std::string M_S_IMAGE_MODE_NAME;
         static const std::string M_S_VIRTUAL_IMAGE_MODE_NAME;
         static const std::string M_S_IMAGE_PROCESSING_OUTPUT_FORMAT_NAME;
         static const std::string M_S_BINNING_NAME;
+        static const std::string M_S_OUTPUT_MODE_NAME;
+        static const std::string M_S_LUMINANCE_WEIGHTS_NAME;
+        static const std::map<std::string, OutputMode> M_S_OUTPUT_MODES;
+        static const std::string M_S_PREVIEW_DECIMATION_NAME;
+        static const std::string M_S_PREVIEW_AUTO_SCALE_NAME;
+        static const std::string M_S_PREVIEW_MAX_RATE_NAME;
+        static const std::string M_S_PREVIEW_SIZE_NAME;
+        static const std::string M_S_PREVIEW_PUBLISH_NAME;
+        static const std::map<std::string, unsigned> M_S_PREVIEW_DECIMATIONS;
+        static const std::string M_S_SUB_REGIONS_NAME;
+        static const std::string M_S_CHARACTERIZATION_EXPOSURES_NAME;
+        static const std::string M_S_CHARACTERIZATION_GAINS_NAME;
+        static const std::string M_S_CHARACTERIZATION_FRAMES_NAME;
+        static const std::string M_S_CHARACTERIZATION_REPORT_NAME;
+        static const std::string M_S_CHARACTERIZATION_RUN_NAME;
+        static const std::string M_S_CHARACTERIZATION_RESULT_NAME;
+        static const std::string M_S_FOCUS_METRIC_ENABLED_NAME;
+        static const std::string M_S_FOCUS_METRIC_ROI_NAME;
+        static const std::string M_S_FOCUS_METRIC_VALUE_NAME;
+        static const std::string M_S_PUBLISHER_ENABLED_NAME;
+        static const std::string M_S_PUBLISHER_NAME_NAME;
+        static const std::string M_S_PUBLISHER_SLOTS_NAME;
+        static const std::string M_S_PUBLISHER_SLOT_SIZE_NAME;
+        static const std::string M_S_PUBLISHER_STATUS_NAME;
+        static const std::string M_S_PIPELINE_STAGES_NAME;
+        static const std::string M_S_PIPELINE_WORKERS_NAME;
+        static const std::string M_S_PIPELINE_DEPTH_NAME;
+        static const std::string M_S_PIPELINE_TIMING_NAME;
+        static const std::string M_S_THREADS_CAPTURE_CORES_NAME;
+        static const std::string M_S_THREADS_WORKER_CORES_NAME;
+        static const std::string M_S_THREADS_RAISE_PRIORITY_NAME;
+        static const std::string M_S_THREADS_STATUS_NAME;
+        static const std::string M_S_MEMORY_LOCK_NAME;
+        static const std::string M_S_MEMORY_HUGE_PAGES_NAME;
+        static const std::string M_S_MEMORY_BUDGET_NAME;
+        static const std::string M_S_MEMORY_STATUS_NAME;
+        static const std::string M_S_SEQUENCE_LAST_SWITCH_NAME;
+        static const std::string M_S_SEQUENCE_DROPPED_FRAMES_NAME;
+        static const std::string M_S_WRITES_MAX_RATE_NAME;
+        static const std::string M_S_WRITES_STATUS_NAME;
+        static const std::string M_S_GAIN_NAME;
+        static const std::string M_S_INITIALIZATION_NAME;
+        static const std::string M_S_PRESET_SAVE_NAME;
+        static const std::string M_S_PRESET_APPLY_NAME;
+        static const std::string M_S_PRESET_LAST_SWITCH_NAME;
+        static const std::string M_S_PRESET_ROI_KEY;
+        static const std::string M_S_PRESET_EXPOSURE_KEY;
+        static const std::set<std::string> M_S_PRESET_EXCLUDED; // writable, but actions or derived
+        static const std::string M_S_TRANSACTION_BEGIN_NAME;
+        static const std::string M_S_TRANSACTION_COMMIT_NAME;
+        static const std::string M_S_TRANSACTION_STATUS_NAME;
+        static const std::set<std::string> M_S_TRANSACTION_EXCLUDED; // set directly while a transaction is open
+        static const std::map<DijSDK_EParamId, std::string> M_S_DISPLAY_NAMES; // where not the registry's, kept for saved configurations
+        static const std::set<DijSDK_EParamId> M_S_UNLISTED_PARAMETERS; // served by other properties, or not by a shadowed one
+        static const std::set<DijSDK_EParamId> M_S_COALESCED_PARAMETERS; // written latest value wins, dragged on sliders
+        static const std::vector<PropertyDefinition> M_S_DEFERRED_PROPERTIES;
         static const std::vector<unsigned char> M_S_TEST_IMAGE;
     };
 } // namespace Prokyon
@@ -117,25 +382,8 @@ namespace Prokyon {
     std::vector<T> ProkyonCamera::get_numeric_value(MM::PropertyBase *p_prop, bool &success) const {
         std::string v;
         p_prop->Get(v);
-
-        // extract values
         std::vector<T> values;
-        std::stringstream words(v);
-        const char token = PropertyBase::delimiter();
-        std::string word;
-        while (std::getline(words, word, token)) {
-            word.erase(std::remove_if(word.begin(), word.end(), [](const char c) {return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f'; }), word.end());
-            T current;
-            try {
-                current = s_to_num<T>(word);
-            }
-            catch (std::invalid_argument) {
-                success = false;
-            }
-            values.push_back(current);
-        }
-        success = true;
-
+        success = PropertyBase::parse_values(v, values);
         return values;
     }
 
@@ -0,0 +1,249 @@
+#include "ProkyonFocus.h"
+
+#include "ProkyonCamera.h"
+
+#include "MMDevice/MMDeviceConstants.h"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+namespace Prokyon {
+    ProkyonFocus::ProkyonFocus() : CStageBase<ProkyonFocus>(),
+        m_step_size_um{1.0},
+        m_autofocus_settings(Autofocus::default_settings()),
+        m_initialized{false}
+    {}
+
+    int ProkyonFocus::Initialize() {
+        LogMessage("initializing");
+        if (m_initialized) {
+            LogMessage("already initialized");
+            return DEVICE_OK;
+        }
+
+        auto p_drive = get_drive();
+        if (p_drive == nullptr) {
+            LogMessage("no initialized camera, load and initialize the camera first");
+            return DEVICE_NOT_CONNECTED;
+        }
+        try { LogMessage(p_drive->to_string()); }
+        catch (FocusException) {
+            LogMessage("camera has no z drive");
+            return DEVICE_NOT_SUPPORTED;
+        }
+
+        LogMessage("setting properties");
+        std::stringstream ss;
+        ss << m_step_size_um;
+        this->CreatePropertyWithHandler(M_S_STEP_SIZE_NAME.c_str(), ss.str().c_str(), MM::PropertyType::Float, false, &ProkyonFocus::update_step_size_property, false);
+        setup_autofocus_properties();
+
+        this->UpdateStatus();
+        m_initialized = true;
+        LogMessage("done");
+        return DEVICE_OK;
+    }
+
+    int ProkyonFocus::Shutdown() {
+        LogMessage("shutting down");
+        m_initialized = false;
+        return DEVICE_OK;
+    }
+
+    void ProkyonFocus::GetName(char *name) const {
+        CDeviceUtils::CopyLimitedString(name, M_S_FOCUS_NAME.c_str());
+    }
+
+    bool ProkyonFocus::Busy() {
+        // moves are synchronous
+        return false;
+    }
+
+    int ProkyonFocus::SetPositionUm(double pos) {
+        return SetPositionSteps(std::lround(pos / m_step_size_um));
+    }
+
+    int ProkyonFocus::GetPositionUm(double &pos) {
+        long steps = 0;
+        auto out = GetPositionSteps(steps);
+        if (out != DEVICE_OK) {
+            return out;
+        }
+        pos = steps * m_step_size_um;
+        return DEVICE_OK;
+    }
+
+    int ProkyonFocus::SetPositionSteps(long steps) {
+        auto p_drive = get_drive();
+        if (p_drive == nullptr) {
+            return DEVICE_NOT_CONNECTED;
+        }
+        try {
+            p_drive->set_position(static_cast<int>(steps));
+        }
+        catch (FocusException) {
+            return DEVICE_ERR;
+        }
+        this->OnStagePositionChanged(steps * m_step_size_um);
+        return DEVICE_OK;
+    }
+
+    int ProkyonFocus::GetPositionSteps(long &steps) {
+        auto p_drive = get_drive();
+        if (p_drive == nullptr) {
+            return DEVICE_NOT_CONNECTED;
+        }
+        try {
+            steps = p_drive->get_position();
+        }
+        catch (FocusException) {
+            return DEVICE_ERR;
+        }
+        return DEVICE_OK;
+    }
+
+    int ProkyonFocus::SetOrigin() {
+        // hardware positions are absolute
+        return DEVICE_UNSUPPORTED_COMMAND;
+    }
+
+    int ProkyonFocus::GetLimits(double &lower, double &upper) {
+        auto p_drive = get_drive();
+        if (p_drive == nullptr) {
+            return DEVICE_NOT_CONNECTED;
+        }
+        try {
+            lower = p_drive->get_min() * m_step_size_um;
+            upper = p_drive->get_max() * m_step_size_um;
+        }
+        catch (FocusException) {
+            return DEVICE_ERR;
+        }
+        return DEVICE_OK;
+    }
+
+    int ProkyonFocus::IsStageSequenceable(bool &isSequenceable) const {
+        isSequenceable = false;
+        return DEVICE_OK;
+    }
+
+    bool ProkyonFocus::IsContinuousFocusDrive() const {
+        return false;
+    }
+
+    const char *ProkyonFocus::get_name() {
+        return M_S_FOCUS_NAME.c_str();
+    }
+
+    const char *ProkyonFocus::get_description() {
+        return M_S_FOCUS_DESCRIPTION.c_str();
+    }
+
+    // private
+    void ProkyonFocus::setup_autofocus_properties() {
+        LogMessage("autofocus | rw | adapter");
+        const auto &settings = m_autofocus_settings;
+        this->CreatePropertyWithHandler(M_S_AUTOFOCUS_RANGE_NAME.c_str(), std::to_string(settings.range_steps).c_str(), MM::PropertyType::Integer, false, &ProkyonFocus::update_autofocus_property, false);
+        this->CreatePropertyWithHandler(M_S_AUTOFOCUS_COARSE_POINTS_NAME.c_str(), std::to_string(settings.coarse_points).c_str(), MM::PropertyType::Integer, false, &ProkyonFocus::update_autofocus_property, false);
+        this->SetPropertyLimits(M_S_AUTOFOCUS_COARSE_POINTS_NAME.c_str(), 3, 51);
+        this->CreatePropertyWithHandler(M_S_AUTOFOCUS_FINE_STEP_NAME.c_str(), std::to_string(settings.fine_step).c_str(), MM::PropertyType::Integer, false, &ProkyonFocus::update_autofocus_property, false);
+        this->CreatePropertyWithHandler(M_S_AUTOFOCUS_SETTLE_NAME.c_str(), std::to_string(settings.settle_ms).c_str(), MM::PropertyType::Integer, false, &ProkyonFocus::update_autofocus_property, false);
+        this->SetPropertyLimits(M_S_AUTOFOCUS_SETTLE_NAME.c_str(), 0, 10000);
+
+        std::vector<std::string> run{"Idle", "Run"};
+        this->CreatePropertyWithHandler(M_S_AUTOFOCUS_RUN_NAME.c_str(), run[0].c_str(), MM::PropertyType::String, false, &ProkyonFocus::update_autofocus_property, false);
+        this->SetAllowedValues(M_S_AUTOFOCUS_RUN_NAME.c_str(), run);
+        this->CreatePropertyWithHandler(M_S_AUTOFOCUS_RESULT_NAME.c_str(), "", MM::PropertyType::String, true, &ProkyonFocus::update_autofocus_property, false);
+    }
+
+    int ProkyonFocus::update_step_size_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+
+        double v = 0.0;
+        p_prop->Get(v);
+        if (v <= 0.0) {
+            p_prop->Set(m_step_size_um);
+            return DEVICE_INVALID_PROPERTY_VALUE;
+        }
+        m_step_size_um = v;
+        return DEVICE_OK;
+    }
+
+    int ProkyonFocus::update_autofocus_property(MM::PropertyBase *p_prop, MM::ActionType type) {
+        std::string name = p_prop->GetName();
+        auto p_camera = ProkyonCamera::get_instance();
+
+        if (name == M_S_AUTOFOCUS_RESULT_NAME) {
+            if (type == MM::BeforeGet && p_camera != nullptr) {
+                auto result = p_camera->get_autofocus()->get_last_result();
+                std::stringstream ss;
+                ss << "position " << result.position << ", metric " << result.value << ", frames " << result.frames;
+                p_prop->Set(ss.str().c_str());
+            }
+            return DEVICE_OK;
+        }
+
+        if (type != MM::AfterSet) {
+            return DEVICE_OK;
+        }
+
+        auto &settings = m_autofocus_settings;
+        if (name == M_S_AUTOFOCUS_RUN_NAME) {
+            std::string v;
+            p_prop->Get(v);
+            if (v != "Run") {
+                return DEVICE_OK;
+            }
+            p_prop->Set("Idle");
+            if (p_camera == nullptr) {
+                return DEVICE_NOT_CONNECTED;
+            }
+            auto out = p_camera->run_autofocus(settings);
+            if (out == DEVICE_OK) {
+                this->OnStagePositionChanged(p_camera->get_autofocus()->get_last_result().position * m_step_size_um);
+            }
+            return out;
+        }
+
+        long v = 0;
+        p_prop->Get(v);
+        if (v < 1 && name != M_S_AUTOFOCUS_SETTLE_NAME) {
+            return DEVICE_INVALID_PROPERTY_VALUE;
+        }
+        if (name == M_S_AUTOFOCUS_RANGE_NAME) {
+            settings.range_steps = static_cast<int>(v);
+        }
+        else if (name == M_S_AUTOFOCUS_COARSE_POINTS_NAME) {
+            settings.coarse_points = static_cast<unsigned>(v);
+        }
+        else if (name == M_S_AUTOFOCUS_FINE_STEP_NAME) {
+            settings.fine_step = static_cast<int>(v);
+        }
+        else if (name == M_S_AUTOFOCUS_SETTLE_NAME) {
+            settings.settle_ms = static_cast<unsigned>(v);
+        }
+        else {
+            assert(false);
+        }
+        return DEVICE_OK;
+    }
+
+    FocusDrive *ProkyonFocus::get_drive() const {
+        auto p_camera = ProkyonCamera::get_instance();
+        return (p_camera == nullptr) ? nullptr : p_camera->get_focus_drive();
+    }
+
+    const std::string ProkyonFocus::M_S_FOCUS_NAME{"Prokyon Z Drive"};
+    const std::string ProkyonFocus::M_S_FOCUS_DESCRIPTION{"Jenoptik Prokyon Z drive (focus)"};
+    const std::string ProkyonFocus::M_S_STEP_SIZE_NAME{"Step Size (um)"};
+    const std::string ProkyonFocus::M_S_AUTOFOCUS_RANGE_NAME{"Autofocus-Range (steps)"};
+    const std::string ProkyonFocus::M_S_AUTOFOCUS_COARSE_POINTS_NAME{"Autofocus-Coarse Points"};
+    const std::string ProkyonFocus::M_S_AUTOFOCUS_FINE_STEP_NAME{"Autofocus-Fine Step (steps)"};
+    const std::string ProkyonFocus::M_S_AUTOFOCUS_SETTLE_NAME{"Autofocus-Settle Time (ms)"};
+    const std::string ProkyonFocus::M_S_AUTOFOCUS_RUN_NAME{"Autofocus-Run"};
+    const std::string ProkyonFocus::M_S_AUTOFOCUS_RESULT_NAME{"Autofocus-Result"};
+}
\ No newline at end of file
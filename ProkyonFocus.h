@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef PROKYONFOCUS_H_
+#define PROKYONFOCUS_H_
+
+#include "MMDevice/DeviceBase.h"
+
+#include "Focus.h"
+
+#include <string>
+
+namespace Prokyon {
+    class ProkyonCamera;
+
+    // The camera's Z drive as a focus stage.
+    // Has no connection of its own, every call goes through the initialized ProkyonCamera of this module.
+    class ProkyonFocus : public CStageBase<ProkyonFocus> {
+    public:
+        ProkyonFocus();
+
+        // device
+        int Initialize();
+        int Shutdown();
+        void GetName(char *name) const;
+        bool Busy();
+
+        // stage
+        int SetPositionUm(double pos);
+        int GetPositionUm(double &pos);
+        int SetPositionSteps(long steps);
+        int GetPositionSteps(long &steps);
+        int SetOrigin();
+        int GetLimits(double &lower, double &upper);
+        int IsStageSequenceable(bool &isSequenceable) const;
+        bool IsContinuousFocusDrive() const;
+
+    public:
+        static const char *get_name();
+        static const char *get_description();
+
+    private:
+        void setup_autofocus_properties();
+        int update_step_size_property(MM::PropertyBase *p_prop, MM::ActionType type);
+        int update_autofocus_property(MM::PropertyBase *p_prop, MM::ActionType type);
+
+        FocusDrive *get_drive() const; // nullptr without an initialized camera
+
+        double m_step_size_um;
+        Autofocus::Settings m_autofocus_settings;
+        bool m_initialized;
+
+        static const std::string M_S_FOCUS_NAME;
+        static const std::string M_S_FOCUS_DESCRIPTION;
+        static const std::string M_S_STEP_SIZE_NAME;
+        static const std::string M_S_AUTOFOCUS_RANGE_NAME;
+        static const std::string M_S_AUTOFOCUS_COARSE_POINTS_NAME;
+        static const std::string M_S_AUTOFOCUS_FINE_STEP_NAME;
+        static const std::string M_S_AUTOFOCUS_SETTLE_NAME;
+        static const std::string M_S_AUTOFOCUS_RUN_NAME;
+        static const std::string M_S_AUTOFOCUS_RESULT_NAME;
+    };
+} // namespace Prokyon
+
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef PROKYON_STAGE_API_H_
+#define PROKYON_STAGE_API_H_
+
+/*
+ * C interface for pipeline stages compiled outside of the adapter, see PipelineStages.h.
+ * Plain C, so a stage library does not depend on the compiler or runtime the adapter was built with.
+ *
+ * A stage library exports
+ *     const ProkyonStageApi *prokyon_get_stage_api(void);
+ * and is added to the pipeline with the stage spec "plugin <path to library> [config]".
+ *
+ * Frames are planes of width * height pixels with components interleaved, one plane per channel,
+ * bits_per_component is 8 or 16, 16 bit values in native byte order.
+ * Add new members only at the end of ProkyonStageApi and raise PROKYON_STAGE_ABI_VERSION when doing so.
+ */
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define PROKYON_STAGE_EXPORT __declspec(dllexport)
+#else
+#define PROKYON_STAGE_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define PROKYON_STAGE_ABI_VERSION 1u
+
+/* flags */
+#define PROKYON_STAGE_IN_PLACE 0x1u /* output may be the input buffer if both layouts have the same size */
+#define PROKYON_STAGE_ORDERED 0x2u /* process is called for one frame at a time, in sequence order */
+
+#define PROKYON_STAGE_OK 0
+#define PROKYON_STAGE_ERROR 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ProkyonFrameLayout {
+    uint32_t width;
+    uint32_t height;
+    uint32_t components;
+    uint32_t bits_per_component;
+    uint32_t channels;
+} ProkyonFrameLayout;
+
+typedef struct ProkyonStageApi {
+    uint32_t abi_version; /* PROKYON_STAGE_ABI_VERSION the library was built with */
+    const char *name;
+    uint32_t flags;
+
+    /* instance per pipeline entry, config is the rest of the stage spec, may be empty, returns NULL on failure */
+    void *(*create)(const char *config);
+    void (*destroy)(void *p_instance);
+    /* returns PROKYON_STAGE_ERROR for unsupported input */
+    int (*output_layout)(void *p_instance, const ProkyonFrameLayout *p_input, ProkyonFrameLayout *p_output);
+    /* called from several threads at once unless PROKYON_STAGE_ORDERED is set */
+    int (*process)(void *p_instance, const ProkyonFrameLayout *p_input, const unsigned char *p_input_data,
+        const ProkyonFrameLayout *p_output, unsigned char *p_output_data, uint64_t sequence);
+} ProkyonStageApi;
+
+typedef const ProkyonStageApi *(*ProkyonGetStageApi)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -3,8 +3,13 @@
 #include "Camera.h"
 #include "Parameters.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace Prokyon {
@@ -12,6 +17,7 @@ namespace Prokyon {
     RegionOfInterest::RegionOfInterest(Camera *p_camera) :
         m_p_camera{p_camera} {
         assert(p_camera != nullptr);
+        m_max = query_max();
         clear();
     }
 
@@ -44,28 +50,52 @@ namespace Prokyon {
     }
 
     void RegionOfInterest::set(ROI roi) {
+        if (!allows(roi)) { throw RegionOfInterestException(); }
+        std::array<int, std::tuple_size<ROI>::value> value;
+        std::copy(roi.cbegin(), roi.cend(), value.begin());
+        auto result = write_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureRoi, value.data(), static_cast<unsigned int>(value.size()));
+        if (result) { throw RegionOfInterestException(); }
+        read_back();
+    }
+
+    bool RegionOfInterest::allows(const ROI &roi) const {
         auto max = get_max();
         for (unsigned int i = 0; i < roi.size(); ++i) {
-            assert(roi.at(i) <= max.at(i));
+            if (max.at(i) < roi.at(i)) { return false; }
         }
-        std::vector<int> value(roi.cbegin(), roi.cend());
-        auto result = set_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureRoi, value);
-        if (result) { throw RegionOfInterestException(); }
+        return roi[W_ind] != 0 && roi[H_ind] != 0 && roi[X_ind] + roi[W_ind] <= max[W_ind] && roi[Y_ind] + roi[H_ind] <= max[H_ind];
+    }
+
+    void RegionOfInterest::refresh() {
+        m_max = query_max();
+        read_back();
+    }
 
-        // make sure cached value reflects hardware state
-        auto count = std::tuple_size<ROI>::value;
-        assert(count < (std::numeric_limits<unsigned int>::max)());
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureRoi, static_cast<unsigned int>(count));
-        if (p.error) { throw RegionOfInterestException(); }
-        assert(p.value.size() == count);
-        auto out = to_unsigned(p.value);
-        m_roi = ROI{out[0], out[1], out[2], out[3]};
+    void RegionOfInterest::refresh(unsigned int width, unsigned int height) {
+        if (width == 0 || height == 0) { throw RegionOfInterestException(); }
+        m_max = {width - 1, height - 1, width, height};
+        read_back();
     }
 
     void RegionOfInterest::clear() {
         set(get_reset_roi());
     }
 
+    std::vector<ROI> RegionOfInterest::set_union(const std::vector<ROI> &regions) {
+        if (regions.empty()) { throw RegionOfInterestException(); }
+        set(bounding_box(regions));
+
+        // hardware may grow the roi to satisfy alignment, so offsets are taken from the applied roi
+        std::vector<ROI> relative;
+        for (const auto &r : regions) {
+            if (r[X_ind] < x() || r[Y_ind] < y() || x_end() < r[X_ind] + r[W_ind] || y_end() < r[Y_ind] + r[H_ind]) {
+                throw RegionOfInterestException();
+            }
+            relative.push_back({r[X_ind] - x(), r[Y_ind] - y(), r[W_ind], r[H_ind]});
+        }
+        return relative;
+    }
+
     std::string RegionOfInterest::to_string() const {
         std::stringstream ss;
         ss << "Region of Interest (ROI) information:\n";
@@ -76,17 +106,85 @@ namespace Prokyon {
     }
 
     // private
+    ROI RegionOfInterest::bounding_box(const std::vector<ROI> &regions) {
+        assert(!regions.empty());
+        auto x0 = (std::numeric_limits<unsigned int>::max)();
+        auto y0 = x0;
+        unsigned int x1 = 0;
+        unsigned int y1 = 0;
+        for (const auto &r : regions) {
+            x0 = (std::min)(x0, r[X_ind]);
+            y0 = (std::min)(y0, r[Y_ind]);
+            x1 = (std::max)(x1, r[X_ind] + r[W_ind]);
+            y1 = (std::max)(y1, r[Y_ind] + r[H_ind]);
+        }
+        return {x0, y0, x1 - x0, y1 - y0};
+    }
+
     ROI RegionOfInterest::get_reset_roi() const {
         auto max = get_max();
         return {0, 0, max.at(W_ind), max.at(H_ind)};
     }
 
+    void RegionOfInterest::read_back() {
+        // make sure cached value reflects hardware state, which may have aligned the roi
+        std::array<int, std::tuple_size<ROI>::value> value;
+        auto result = read_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureRoi, value.data(), static_cast<unsigned int>(value.size()));
+        if (result) { throw RegionOfInterestException(); }
+        m_roi = ROI{to_unsigned(value[0]), to_unsigned(value[1]), to_unsigned(value[2]), to_unsigned(value[3])};
+    }
+
     ROI RegionOfInterest::get_max() const {
-        auto count = std::tuple_size<ROI>::value;
-        assert(count < (std::numeric_limits<unsigned int>::max)());
-        auto p = get_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureRoi, static_cast<unsigned int>(count), DijSDK_EParamQueryMax);
-        if (p.error) { throw RegionOfInterestException(); }
-        auto value = to_unsigned(p.value);
-        return {value.at(X_ind), value.at(Y_ind), value.at(W_ind), value.at(H_ind)};
+        return m_max;
+    }
+
+    ROI RegionOfInterest::query_max() const {
+        std::array<int, std::tuple_size<ROI>::value> value;
+        auto result = read_numeric_parameter<int>(*m_p_camera, ParameterIdImageCaptureRoi, value.data(), static_cast<unsigned int>(value.size()), DijSDK_EParamQueryMax);
+        if (result) { throw RegionOfInterestException(); }
+        return {to_unsigned(value[X_ind]), to_unsigned(value[Y_ind]), to_unsigned(value[W_ind]), to_unsigned(value[H_ind])};
+    }
+
+    // free functions
+    bool parse_regions(const std::string &s, std::vector<ROI> &regions) {
+        // "x, y, w, h; x, y, w, h; ..."
+        regions.clear();
+        std::stringstream entries(s);
+        std::string entry;
+        while (std::getline(entries, entry, ';')) {
+            if (entry.find_first_not_of(" \t") == std::string::npos) {
+                continue;
+            }
+            std::stringstream values(entry);
+            std::string value;
+            std::vector<unsigned> roi;
+            while (std::getline(values, value, ',')) {
+                try {
+                    auto v = std::stoi(value);
+                    if (v < 0) { return false; }
+                    roi.push_back(static_cast<unsigned>(v));
+                }
+                catch (std::logic_error) {
+                    return false;
+                }
+            }
+            if (roi.size() != std::tuple_size<ROI>::value) {
+                return false;
+            }
+            regions.push_back({roi[X_ind], roi[Y_ind], roi[W_ind], roi[H_ind]});
+        }
+        return true;
+    }
+
+    std::string regions_to_string(const std::vector<ROI> &regions) {
+        std::stringstream ss;
+        for (std::size_t i = 0; i < regions.size(); ++i) {
+            const auto &r = regions[i];
+            if (0 < i) {
+                ss << "; ";
+            }
+            ss << r[X_ind] << ", " << r[Y_ind] << ", " << r[W_ind] << ", " << r[H_ind];
+        }
+        return ss.str();
     }
 }
\ No newline at end of file
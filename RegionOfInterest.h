@@ -30,20 +30,36 @@ namespace Prokyon {
         unsigned int y_end() const;
 
         ROI get() const;
-        void set(const ROI roi); // throws RegionOfInterestException
+        // checked against the cached maximum, throws RegionOfInterestException
+        void set(const ROI roi);
+        bool allows(const ROI &roi) const; // within the cached maximum, nothing is written
         void clear(); // sets to max size, throws RegionOfInterestException
+        // sets the hardware roi to the bounding box of regions
+        // returns regions relative to the roi actually applied by the hardware
+        std::vector<ROI> set_union(const std::vector<ROI> &regions); // throws RegionOfInterestException
+        // rereads maximum and roi from the hardware, after changes that resize the sensor area (image mode)
+        void refresh(); // throws RegionOfInterestException
+        void refresh(unsigned int width, unsigned int height); // with the known maximum of the mode, throws RegionOfInterestException
 
         std::string to_string() const; // throws RegionOfInterestException
 
     private:
+        static ROI bounding_box(const std::vector<ROI> &regions);
         ROI get_reset_roi() const; // throws RegionOfInterestException
-        ROI get_max() const; // throws RegionOfInterestException
+        ROI get_max() const;
+        ROI query_max() const; // throws RegionOfInterestException
+        void read_back(); // throws RegionOfInterestException
 
         ROI m_roi;
+        ROI m_max;
         Camera *m_p_camera;
     };
 
     class RegionOfInterestException : public std::exception {};
+
+    // "x, y, w, h; x, y, w, h; ..." as the sub regions and presets hold them
+    bool parse_regions(const std::string &s, std::vector<ROI> &regions); // returns success
+    std::string regions_to_string(const std::vector<ROI> &regions);
 }
 
 #endif
\ No newline at end of file
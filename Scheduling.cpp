@@ -0,0 +1,158 @@
+#include "Scheduling.h"
+
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Prokyon {
+#ifdef _WIN32
+    bool Scheduling::apply(const ThreadPolicy &policy) {
+        auto thread = GetCurrentThread();
+        auto success = true;
+        if (!policy.cores.empty()) {
+            DWORD_PTR mask = 0;
+            for (auto core : policy.cores) {
+                if (8 * sizeof(DWORD_PTR) <= core) { return false; }
+                mask |= DWORD_PTR{1} << core;
+            }
+            success = SetThreadAffinityMask(thread, mask) != 0;
+        }
+        int priority = THREAD_PRIORITY_NORMAL;
+        switch (policy.priority) {
+            case ThreadPriority::normal: priority = THREAD_PRIORITY_NORMAL; break;
+            case ThreadPriority::raised: priority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+            case ThreadPriority::highest: priority = THREAD_PRIORITY_HIGHEST; break;
+        }
+        return SetThreadPriority(thread, priority) != 0 && success;
+    }
+
+    bool Scheduling::save(ThreadState &state) {
+        auto thread = GetCurrentThread();
+        // the affinity of a thread is only returned by setting it, to the process' mask, which any thread may have
+        DWORD_PTR process_mask = 0;
+        DWORD_PTR system_mask = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) == 0) { return false; }
+        auto mask = SetThreadAffinityMask(thread, process_mask);
+        if (mask == 0 || SetThreadAffinityMask(thread, mask) == 0) { return false; }
+        state.cores.clear();
+        for (unsigned core = 0; core < 8 * sizeof(DWORD_PTR); ++core) {
+            if ((mask & (DWORD_PTR{1} << core)) != 0) {
+                state.cores.push_back(core);
+            }
+        }
+        state.scheduler = 0;
+        state.priority = GetThreadPriority(thread);
+        return state.priority != THREAD_PRIORITY_ERROR_RETURN;
+    }
+
+    bool Scheduling::restore(const ThreadState &state) {
+        auto thread = GetCurrentThread();
+        DWORD_PTR mask = 0;
+        for (auto core : state.cores) {
+            mask |= DWORD_PTR{1} << core;
+        }
+        auto success = SetThreadAffinityMask(thread, mask) != 0;
+        return SetThreadPriority(thread, state.priority) != 0 && success;
+    }
+#else
+    bool Scheduling::apply(const ThreadPolicy &policy) {
+        auto thread = pthread_self();
+        auto success = true;
+        if (!policy.cores.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (auto core : policy.cores) {
+                if (CPU_SETSIZE <= core) { return false; }
+                CPU_SET(core, &set);
+            }
+            success = pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+        }
+        // the normal policy has no priority levels, raised threads run round robin above all normal ones
+        sched_param param{};
+        auto scheduler = SCHED_OTHER;
+        if (policy.priority != ThreadPriority::normal) {
+            scheduler = SCHED_RR;
+            auto lo = sched_get_priority_min(SCHED_RR);
+            auto hi = sched_get_priority_max(SCHED_RR);
+            param.sched_priority = (policy.priority == ThreadPriority::highest) ? lo + (hi - lo) / 2 : lo;
+        }
+        return pthread_setschedparam(thread, scheduler, &param) == 0 && success;
+    }
+
+    bool Scheduling::save(ThreadState &state) {
+        auto thread = pthread_self();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_param param{};
+        if (pthread_getaffinity_np(thread, sizeof(set), &set) != 0 || pthread_getschedparam(thread, &state.scheduler, &param) != 0) { return false; }
+        state.cores.clear();
+        for (unsigned core = 0; core < CPU_SETSIZE; ++core) {
+            if (CPU_ISSET(core, &set)) {
+                state.cores.push_back(core);
+            }
+        }
+        state.priority = param.sched_priority;
+        return true;
+    }
+
+    bool Scheduling::restore(const ThreadState &state) {
+        auto thread = pthread_self();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto core : state.cores) {
+            CPU_SET(core, &set);
+        }
+        auto success = pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+        sched_param param{};
+        param.sched_priority = state.priority;
+        return pthread_setschedparam(thread, state.scheduler, &param) == 0 && success;
+    }
+#endif
+
+    unsigned Scheduling::get_core_count() {
+        auto count = std::thread::hardware_concurrency();
+        return (count == 0) ? 1u : count;
+    }
+
+    bool Scheduling::parse_cores(const std::string &s, std::vector<unsigned> &cores) {
+        cores.clear();
+        std::stringstream words(s);
+        std::string word;
+        while (std::getline(words, word, ',')) {
+            if (word.find_first_not_of(" \t") == std::string::npos) {
+                continue;
+            }
+            std::stringstream ss(word);
+            long core = -1;
+            if (!(ss >> core) || !(ss >> std::ws).eof() || core < 0 || get_core_count() <= static_cast<unsigned long>(core)) {
+                cores.clear();
+                return false;
+            }
+            cores.push_back(static_cast<unsigned>(core));
+        }
+        return true;
+    }
+
+    std::string Scheduling::cores_to_string(const std::vector<unsigned> &cores) {
+        std::stringstream ss;
+        for (std::size_t i = 0; i < cores.size(); ++i) {
+            if (0 < i) {
+                ss << ", ";
+            }
+            ss << cores[i];
+        }
+        return ss.str();
+    }
+}
\ No newline at end of file
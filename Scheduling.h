@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef PROKYON_SCHEDULING_H_
+#define PROKYON_SCHEDULING_H_
+
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    enum class ThreadPriority : int {
+        normal = 0,
+        raised = 1, // above other application threads
+        highest = 2, // for the capture thread, below time critical system threads
+    };
+
+    // Where and how urgently one thread runs.
+    struct ThreadPolicy {
+        std::vector<unsigned> cores; // logical cores the thread may run on, empty for any
+        ThreadPriority priority;
+    };
+
+    // What apply changes of one thread, as the OS reports it.
+    struct ThreadState {
+        std::vector<unsigned> cores; // logical cores the thread may run on
+        int scheduler; // scheduling policy, unused on Windows
+        int priority; // of the OS, in the range of the scheduler
+    };
+
+    // Applies thread policies through the OS, both are best effort:
+    // raising priority usually needs elevated rights outside of Windows.
+    class Scheduling {
+    public:
+        static bool apply(const ThreadPolicy &policy); // to the calling thread, returns success
+        // of the calling thread, to put back a thread that runs under a policy for a while only
+        static bool save(ThreadState &state); // returns success
+        static bool restore(const ThreadState &state); // returns success
+        static unsigned get_core_count();
+
+        // "0, 2, 4" style lists, empty for none
+        static bool parse_cores(const std::string &s, std::vector<unsigned> &cores); // returns success
+        static std::string cores_to_string(const std::vector<unsigned> &cores);
+    };
+}
+
+#endif
\ No newline at end of file
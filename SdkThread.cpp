@@ -0,0 +1,168 @@
+#include "SdkThread.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Prokyon {
+    SdkThread::SdkThread() :
+        m_thread{},
+        m_owner{std::thread::id{}},
+        m_running{false},
+        m_stop_requested{false},
+        m_start_mutex{},
+        m_frame_queue{},
+        m_parameter_queue{},
+        m_pending{0},
+        m_sleeping{false},
+        m_wake_mutex{},
+        m_wake_cv{},
+        m_frame_commands{0},
+        m_parameter_commands{0},
+        m_batches{0},
+        m_max_batch{0}
+    {}
+
+    SdkThread::~SdkThread() {
+        // joining here would be at module unload, too late on Windows
+        assert(!m_thread.joinable());
+    }
+
+    void SdkThread::start() {
+        auto &self = instance();
+        std::lock_guard<std::mutex> lock(self.m_start_mutex);
+        if (self.m_running) { return; }
+        self.m_stop_requested = false;
+        self.m_thread = std::thread(&SdkThread::run, &self);
+        // before running, callers only queue once they see it, and is_owner may be asked by any thread
+        self.m_owner = self.m_thread.get_id();
+        self.m_running = true;
+    }
+
+    void SdkThread::stop() {
+        auto &self = instance();
+        std::lock_guard<std::mutex> lock(self.m_start_mutex);
+        if (!self.m_running) { return; }
+        {
+            std::lock_guard<std::mutex> wake_lock(self.m_wake_mutex);
+            self.m_stop_requested = true;
+        }
+        self.m_wake_cv.notify_one();
+        self.m_thread.join();
+        self.m_running = false;
+        self.m_owner = std::thread::id{};
+    }
+
+    bool SdkThread::is_running() {
+        return instance().m_running;
+    }
+
+    bool SdkThread::is_owner() {
+        return std::this_thread::get_id() == instance().m_owner;
+    }
+
+    SdkThread::Statistics SdkThread::get_statistics() {
+        auto &self = instance();
+        return {self.m_frame_commands, self.m_parameter_commands, self.m_batches, self.m_max_batch};
+    }
+
+    // private
+    SdkThread &SdkThread::instance() {
+        static SdkThread s_instance;
+        return s_instance;
+    }
+
+    void SdkThread::submit(Queue &queue, Command *p_command) {
+        queue.push(p_command);
+        ++m_pending;
+        // pairs with the thread announcing its sleep before its last look at the queues
+        if (m_sleeping) {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+        }
+        m_wake_cv.notify_one();
+    }
+
+    void SdkThread::run() {
+        while (true) {
+            // a frame command goes ahead of whatever parameter commands are queued
+            if (auto p_command = m_frame_queue.pop()) {
+                --m_pending;
+                ++m_frame_commands;
+                p_command->execute();
+                continue;
+            }
+
+            // the parameter commands queued by now run as one batch, later ones wait for the next frame
+            std::uint64_t batch = 0;
+            const auto limit = m_pending.load();
+            while (batch < limit) {
+                auto p_command = m_parameter_queue.pop();
+                if (p_command == nullptr) { break; }
+                --m_pending;
+                ++batch;
+                p_command->execute();
+            }
+            if (0 < batch) {
+                m_parameter_commands += batch;
+                ++m_batches;
+                if (m_max_batch < batch) {
+                    m_max_batch = batch;
+                }
+                continue;
+            }
+            if (0 < m_pending) {
+                // a push is half done
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            m_sleeping = true;
+            m_wake_cv.wait(lock, [this]() { return 0 < m_pending || m_stop_requested; });
+            m_sleeping = false;
+            if (m_pending == 0 && m_stop_requested) { return; }
+        }
+    }
+
+    void SdkThread::Waiter::wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_done; });
+        if (m_p_error) { std::rethrow_exception(m_p_error); }
+    }
+
+    SdkThread::Queue::Queue() :
+        m_p_head{&m_stub},
+        m_p_tail{&m_stub},
+        m_stub{}
+    {}
+
+    void SdkThread::Queue::push(Command *p_command) {
+        p_command->p_next.store(nullptr, std::memory_order_relaxed);
+        auto p_previous = m_p_head.exchange(p_command, std::memory_order_acq_rel);
+        // until this store the command is not reachable from the tail, pop then reports empty
+        p_previous->p_next.store(p_command, std::memory_order_release);
+    }
+
+    SdkThread::Command *SdkThread::Queue::pop() {
+        auto p_tail = m_p_tail;
+        auto p_next = p_tail->p_next.load(std::memory_order_acquire);
+        if (p_tail == &m_stub) {
+            if (p_next == nullptr) { return nullptr; }
+            m_p_tail = p_next;
+            p_tail = p_next;
+            p_next = p_next->p_next.load(std::memory_order_acquire);
+        }
+        if (p_next != nullptr) {
+            m_p_tail = p_next;
+            return p_tail;
+        }
+        if (p_tail != m_p_head.load(std::memory_order_acquire)) { return nullptr; }
+        // the tail is the last command, the stub goes behind it so the tail can move on
+        push(&m_stub);
+        p_next = p_tail->p_next.load(std::memory_order_acquire);
+        if (p_next != nullptr) {
+            m_p_tail = p_next;
+            return p_tail;
+        }
+        return nullptr;
+    }
+}
\ No newline at end of file
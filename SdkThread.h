@@ -0,0 +1,200 @@
+#pragma once
+
+#ifndef PROKYON_SDK_THREAD_H_
+#define PROKYON_SDK_THREAD_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Prokyon {
+    // The one thread calling into the DijSDK, the SDK is not safe for calls from the core's threads at the same time.
+    // Callers hand it commands through two lock free queues and wait for them or take a future,
+    // frame commands always go first, parameter commands queued meanwhile run back to back between two frames.
+    // The SDK is one library per process, so the thread is too, it runs from before DijSDK_Init to after DijSDK_Exit.
+    // Without a running thread, and on the thread itself, commands run directly on the calling thread.
+    class SdkThread {
+    public:
+        struct Statistics {
+            std::uint64_t frame_commands;
+            std::uint64_t parameter_commands;
+            std::uint64_t batches; // runs of parameter commands between two frame commands or idle times
+            std::uint64_t max_batch;
+        };
+
+        static void start(); // before the SDK is initialized, no effect if running
+        static void stop(); // after the SDK exited, runs the commands queued so far first
+        static bool is_running();
+        static bool is_owner(); // the calling thread is the SDK thread
+
+        // wait for the result, exceptions of f are rethrown to the caller, nothing is allocated
+        template<typename F>
+        static auto call(F &&f) -> decltype(f());
+        template<typename F>
+        static auto call_frame(F &&f) -> decltype(f()); // ahead of all parameter commands
+        // a parameter command the caller does not wait for
+        template<typename F>
+        static auto post(F f) -> std::future<decltype(f())>;
+
+        static Statistics get_statistics();
+
+    private:
+        class Command {
+        public:
+            virtual ~Command() {}
+            virtual void execute() = 0; // on the SDK thread, the command may be gone afterwards
+            std::atomic<Command *> p_next{nullptr};
+        };
+
+        // multiple producer, single consumer, after Vyukov, intrusive so commands can live on the caller's stack
+        class Queue {
+        public:
+            Queue();
+            void push(Command *p_command); // any thread
+            Command *pop(); // SDK thread, nullptr if empty or a push is half done
+
+        private:
+            std::atomic<Command *> m_p_head; // last pushed
+            Command *m_p_tail; // next to pop
+            struct Stub : Command {
+                void execute() {}
+            } m_stub;
+        };
+
+        // on the caller's stack, the caller waits until it ran
+        class Waiter : public Command {
+        protected:
+            template<typename G>
+            void complete(G run);
+            void wait(); // rethrows
+
+        private:
+            std::exception_ptr m_p_error;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_done{false};
+        };
+
+        template<typename F, typename R = decltype(std::declval<F &>()())>
+        class Call : public Waiter {
+        public:
+            explicit Call(F &f) : m_p_f{&f}, m_result{} {}
+            void execute() { complete([this]() { m_result = (*m_p_f)(); }); }
+            R get() { wait(); return std::move(m_result); }
+
+        private:
+            F *m_p_f;
+            R m_result;
+        };
+
+        // on the heap, deletes itself after it ran
+        template<typename R>
+        class Task : public Command {
+        public:
+            template<typename F>
+            explicit Task(F f) : m_task{std::move(f)} {}
+            void execute() { m_task(); delete this; }
+            std::future<R> get_future() { return m_task.get_future(); }
+
+        private:
+            std::packaged_task<R()> m_task;
+        };
+
+        SdkThread();
+        ~SdkThread();
+        static SdkThread &instance();
+
+        void submit(Queue &queue, Command *p_command);
+        void run();
+
+    private:
+        std::thread m_thread;
+        std::atomic<std::thread::id> m_owner; // read by every caller of is_owner, written in start and stop
+        std::atomic<bool> m_running;
+        std::atomic<bool> m_stop_requested;
+        std::mutex m_start_mutex; // start and stop
+        Queue m_frame_queue;
+        Queue m_parameter_queue;
+        std::atomic<unsigned> m_pending; // pushed, not yet popped, of both queues
+
+        // the thread only sleeps with both queues empty, producers wake it through these
+        std::atomic<bool> m_sleeping;
+        std::mutex m_wake_mutex;
+        std::condition_variable m_wake_cv;
+
+        std::atomic<std::uint64_t> m_frame_commands;
+        std::atomic<std::uint64_t> m_parameter_commands;
+        std::atomic<std::uint64_t> m_batches;
+        std::atomic<std::uint64_t> m_max_batch;
+    };
+}
+
+// template function definitions
+namespace Prokyon {
+    // no result to hold
+    template<typename F>
+    class SdkThread::Call<F, void> : public Waiter {
+    public:
+        explicit Call(F &f) : m_p_f{&f} {}
+        void execute() { complete([this]() { (*m_p_f)(); }); }
+        void get() { wait(); }
+
+    private:
+        F *m_p_f;
+    };
+
+    template<typename F>
+    auto SdkThread::call(F &&f) -> decltype(f()) {
+        auto &self = instance();
+        if (!self.m_running || is_owner()) { return f(); }
+        Call<typename std::remove_reference<F>::type> command{f};
+        self.submit(self.m_parameter_queue, &command);
+        return command.get();
+    }
+
+    template<typename F>
+    auto SdkThread::call_frame(F &&f) -> decltype(f()) {
+        auto &self = instance();
+        if (!self.m_running || is_owner()) { return f(); }
+        Call<typename std::remove_reference<F>::type> command{f};
+        self.submit(self.m_frame_queue, &command);
+        return command.get();
+    }
+
+    template<typename F>
+    auto SdkThread::post(F f) -> std::future<decltype(f())> {
+        auto &self = instance();
+        auto p_task = std::make_unique<Task<decltype(f())>>(std::move(f));
+        auto future = p_task->get_future();
+        if (!self.m_running || is_owner()) {
+            p_task.release()->execute();
+        }
+        else {
+            self.submit(self.m_parameter_queue, p_task.release());
+        }
+        return future;
+    }
+
+    template<typename G>
+    void SdkThread::Waiter::complete(G run) {
+        try {
+            run();
+        }
+        catch (...) {
+            m_p_error = std::current_exception();
+        }
+        // the caller returns as soon as it sees done, this is gone then
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+        m_cv.notify_one();
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "SensorCharacterization.h"
+
+#include "AcquisitionParameters.h"
+#include "Image.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace Prokyon {
+    namespace {
+        struct LinearFit {
+            double intercept;
+            double slope;
+            double r2;
+        };
+
+        LinearFit fit_line(const std::vector<double> &x, const std::vector<double> &y) {
+            assert(x.size() == y.size());
+            const auto n = static_cast<double>(x.size());
+            double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, syy = 0.0;
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                sx += x[i];
+                sy += y[i];
+                sxx += x[i] * x[i];
+                sxy += x[i] * y[i];
+                syy += y[i] * y[i];
+            }
+            const auto den = n * sxx - sx * sx;
+            if (n < 2 || den == 0.0) {
+                return {0.0, 0.0, 0.0};
+            }
+            const auto slope = (n * sxy - sx * sy) / den;
+            const auto intercept = (sy - slope * sx) / n;
+            const auto var_y = n * syy - sy * sy;
+            const auto r2 = (var_y == 0.0) ? 1.0 : ((n * sxy - sx * sy) * (n * sxy - sx * sy)) / (den * var_y);
+            return {intercept, slope, r2};
+        }
+    }
+
+    SensorCharacterization::SensorCharacterization(Image *p_image, AcquisitionParameters *p_acq_parameters) :
+        m_p_image{p_image},
+        m_p_acq_parameters{p_acq_parameters},
+        m_statistics{},
+        m_steps{},
+        m_results{},
+        m_max_value{0}
+    {
+        assert(p_image != nullptr);
+        assert(p_acq_parameters != nullptr);
+    }
+
+    void SensorCharacterization::run(const Settings &settings) {
+        if (settings.exposures_ms.empty() || settings.gains.empty() || settings.frames_per_step < 2) {
+            throw SensorCharacterizationException();
+        }
+
+        double exposure_ms = 0.0;
+        double gain = 0.0;
+        try {
+            exposure_ms = m_p_acq_parameters->get_exposure_ms();
+            gain = m_p_acq_parameters->get_gain();
+        }
+        catch (AcquisitionParametersException) {
+            throw SensorCharacterizationException();
+        }
+
+        m_steps.clear();
+        m_results.clear();
+        auto ok = true;
+        try {
+            sweep(settings);
+        }
+        catch (SensorCharacterizationException) {
+            ok = false;
+        }
+
+        try {
+            m_p_acq_parameters->set_exposure_ms(exposure_ms);
+            m_p_acq_parameters->set_gain(gain);
+        }
+        catch (AcquisitionParametersException) {
+            ok = false;
+        }
+        if (!ok) { throw SensorCharacterizationException(); }
+
+        write_report(settings.report_file);
+    }
+
+    const std::vector<SensorCharacterization::Step> &SensorCharacterization::get_steps() const {
+        return m_steps;
+    }
+
+    const std::vector<SensorCharacterization::GainResult> &SensorCharacterization::get_results() const {
+        return m_results;
+    }
+
+    std::string SensorCharacterization::summary_to_string() const {
+        std::stringstream ss;
+        auto is_first = true;
+        for (const auto &r : m_results) {
+            if (!is_first) { ss << "; "; }
+            is_first = false;
+            ss << "gain " << r.gain << ": " << r.conversion_gain_adu_per_e << " ADU/e-, read noise " << r.read_noise_e << " e-";
+        }
+        return ss.str();
+    }
+
+    SensorCharacterization::Settings SensorCharacterization::default_settings() {
+        return {{1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0}, {1.0}, 16u, "prokyon_characterization.csv"};
+    }
+
+    SensorCharacterization::GainResult SensorCharacterization::fit(const std::vector<Step> &steps, unsigned max_value) {
+        GainResult result{};
+        if (steps.empty()) { return result; }
+        // the applied gain, which may differ from the requested one after clipping
+        result.gain = steps.front().gain;
+
+        std::vector<const Step *> fitted;
+        for (const auto &s : steps) {
+            if (s.mean_adu < M_S_SATURATION_FRACTION * max_value) {
+                fitted.push_back(&s);
+            }
+        }
+        if (fitted.empty()) { return result; }
+
+        std::vector<double> means, variances, exposures;
+        for (const auto p : fitted) {
+            means.push_back(p->mean_adu);
+            variances.push_back(p->temporal_variance_adu2);
+            exposures.push_back(p->exposure_ms);
+        }
+
+        auto ptc = fit_line(means, variances);
+        auto linearity = fit_line(exposures, means);
+        result.conversion_gain_adu_per_e = ptc.slope;
+        result.read_noise_adu = std::sqrt(fitted.front()->temporal_variance_adu2);
+        result.read_noise_e = (0.0 < ptc.slope) ? result.read_noise_adu / ptc.slope : 0.0;
+        result.linearity_r2 = linearity.r2;
+        result.points_fitted = static_cast<unsigned>(fitted.size());
+        return result;
+    }
+
+    // private
+    void SensorCharacterization::sweep(const Settings &settings) {
+        auto exposures = settings.exposures_ms;
+        std::sort(exposures.begin(), exposures.end());
+        for (const auto gain : settings.gains) {
+            const auto first_step = m_steps.size();
+            for (const auto exposure_ms : exposures) {
+                m_steps.push_back(measure_step(gain, exposure_ms, settings.frames_per_step));
+            }
+            m_results.push_back(fit(std::vector<Step>(m_steps.begin() + first_step, m_steps.end()), m_max_value));
+        }
+    }
+
+    SensorCharacterization::Step SensorCharacterization::measure_step(double gain, double exposure_ms, unsigned frames) {
+        Step step{};
+        try {
+            m_p_acq_parameters->set_gain(gain);
+            m_p_acq_parameters->set_exposure_ms(exposure_ms);
+            // report what the hardware applied after clipping
+            step.gain = m_p_acq_parameters->get_gain();
+            step.exposure_ms = m_p_acq_parameters->get_exposure_ms();
+        }
+        catch (AcquisitionParametersException) {
+            throw SensorCharacterizationException();
+        }
+
+        // first frame after a parameter change may still use old settings
+        if (!m_p_image->acquire()) { throw SensorCharacterizationException(); }
+        if (m_p_image->get_number_of_components() != 1) {
+            // statistics need a single component, select a gray format or a luminance output mode
+            throw SensorCharacterizationException();
+        }
+        const auto bits = m_p_image->get_bit_depth();
+        m_max_value = (1u << bits) - 1u;
+        m_statistics.reset(static_cast<std::size_t>(m_p_image->get_image_width()) * m_p_image->get_image_height());
+
+        for (unsigned f = 0; f < frames; ++f) {
+            if (!m_p_image->acquire()) { throw SensorCharacterizationException(); }
+            try {
+                m_statistics.add(m_p_image->get_image_buffer(), bits);
+            }
+            catch (StatisticsException) {
+                throw SensorCharacterizationException();
+            }
+        }
+
+        step.frames = frames;
+        step.mean_adu = m_statistics.mean_of_means();
+        step.temporal_variance_adu2 = m_statistics.mean_of_variances();
+        step.fixed_pattern_variance_adu2 = m_statistics.variance_of_means();
+        return step;
+    }
+
+    void SensorCharacterization::write_report(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out) { throw SensorCharacterizationException(); }
+
+        out << "# Prokyon photon transfer report\n";
+        out << "# steps\n";
+        out << "gain,exposure_ms,frames,mean_adu,temporal_variance_adu2,fixed_pattern_variance_adu2\n";
+        for (const auto &s : m_steps) {
+            out << s.gain << "," << s.exposure_ms << "," << s.frames << "," << s.mean_adu << "," << s.temporal_variance_adu2 << "," << s.fixed_pattern_variance_adu2 << "\n";
+        }
+        out << "# results\n";
+        out << "gain,conversion_gain_adu_per_e,conversion_gain_e_per_adu,read_noise_adu,read_noise_e,linearity_r2,points_fitted\n";
+        for (const auto &r : m_results) {
+            auto e_per_adu = (0.0 < r.conversion_gain_adu_per_e) ? 1.0 / r.conversion_gain_adu_per_e : 0.0;
+            out << r.gain << "," << r.conversion_gain_adu_per_e << "," << e_per_adu << "," << r.read_noise_adu << "," << r.read_noise_e << "," << r.linearity_r2 << "," << r.points_fitted << "\n";
+        }
+        if (!out) { throw SensorCharacterizationException(); }
+    }
+
+    const double SensorCharacterization::M_S_SATURATION_FRACTION = 0.9;
+}
\ No newline at end of file
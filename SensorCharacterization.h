@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef PROKYON_SENSOR_CHARACTERIZATION_H_
+#define PROKYON_SENSOR_CHARACTERIZATION_H_
+
+#include "Statistics.h"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    class AcquisitionParameters;
+    class Image;
+
+    // Photon transfer measurement.
+    // Sweeps gain and exposure, keeping only running per pixel statistics at each step,
+    // then fits the shot noise limited part of variance vs. mean for each gain.
+    class SensorCharacterization {
+    public:
+        struct Settings {
+            std::vector<double> exposures_ms;
+            std::vector<double> gains;
+            unsigned frames_per_step;
+            std::string report_file;
+        };
+
+        struct Step {
+            double gain;
+            double exposure_ms;
+            unsigned frames;
+            double mean_adu; // spatial mean of temporal means
+            double temporal_variance_adu2; // spatial mean of temporal variances
+            double fixed_pattern_variance_adu2; // spatial variance of temporal means
+        };
+
+        struct GainResult {
+            double gain;
+            double conversion_gain_adu_per_e; // slope of the photon transfer curve
+            double read_noise_adu; // temporal noise at the shortest exposure
+            double read_noise_e;
+            double linearity_r2; // mean signal vs. exposure
+            unsigned points_fitted;
+        };
+
+        SensorCharacterization(Image *p_image, AcquisitionParameters *p_acq_parameters);
+
+        // blocks until the sweep is done, restores exposure and gain afterwards
+        void run(const Settings &settings); // throws SensorCharacterizationException
+
+        const std::vector<Step> &get_steps() const;
+        const std::vector<GainResult> &get_results() const;
+        std::string summary_to_string() const;
+
+        static Settings default_settings();
+        // photon transfer fit of the steps of one gain, steps of max_value * M_S_SATURATION_FRACTION and more are left out
+        static GainResult fit(const std::vector<Step> &steps, unsigned max_value);
+
+    private:
+        void sweep(const Settings &settings); // throws SensorCharacterizationException
+        Step measure_step(double gain, double exposure_ms, unsigned frames); // throws SensorCharacterizationException
+        void write_report(const std::string &path) const; // throws SensorCharacterizationException
+
+    private:
+        Image *m_p_image;
+        AcquisitionParameters *m_p_acq_parameters;
+        PixelStatistics m_statistics;
+        std::vector<Step> m_steps;
+        std::vector<GainResult> m_results;
+        unsigned m_max_value;
+
+        // steps closer to full scale than this are treated as saturating and not fitted
+        static const double M_S_SATURATION_FRACTION;
+    };
+
+    class SensorCharacterizationException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef PROKYON_SHARED_FRAME_LAYOUT_H_
+#define PROKYON_SHARED_FRAME_LAYOUT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Memory layout of the shared memory frame ring, shared by FramePublisher (adapter) and SharedFrameReader (consumers).
+// Do not include anything adapter specific here, consumers build this header on their own.
+//
+// [RingHeader][slot 0: SlotHeader | data][slot 1: SlotHeader | data]...
+// frame n (counting from 1) goes to slot n % slot_count
+// each slot is a sequence lock: its sequence is 2n + 1 while frame n is written and 2n once it is complete
+// readers copy the slot and accept it only if the sequence was 2n before and after the copy
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory ring needs lock free 64 bit atomics");
+
+namespace Prokyon {
+    struct alignas(64) SharedRingHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t slot_count;
+        std::uint32_t reserved;
+        std::uint64_t slot_stride; // bytes from one slot header to the next
+        std::uint64_t slot_capacity; // data bytes per slot
+        std::atomic<std::uint64_t> write_sequence; // last completed frame, 0 before the first
+    };
+
+    struct alignas(64) SharedSlotHeader {
+        std::atomic<std::uint64_t> sequence;
+        std::uint64_t timestamp_ns; // std::chrono::steady_clock, comparable across processes on one machine
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t components;
+        std::uint32_t bits_per_component;
+        std::uint32_t channel; // sub region index, see ProkyonCamera multi ROI, or M_S_PREVIEW_CHANNEL
+        std::uint32_t reserved;
+        std::uint64_t bytes;
+    };
+
+    struct SharedFrameLayout {
+        static const std::uint32_t M_S_MAGIC = 0x4e4b5250u; // "PRKN"
+        static const std::uint32_t M_S_VERSION = 1u;
+        static const std::size_t M_S_ALIGNMENT = 64u;
+        // decimated preview frames share the ring with the full frames, readers tell them apart by this channel
+        static const std::uint32_t M_S_PREVIEW_CHANNEL = 0xffffffffu;
+
+        static std::size_t align(std::size_t bytes) {
+            return (bytes + M_S_ALIGNMENT - 1u) / M_S_ALIGNMENT * M_S_ALIGNMENT;
+        }
+
+        static std::size_t slot_stride(std::size_t slot_capacity) {
+            return align(sizeof(SharedSlotHeader)) + align(slot_capacity);
+        }
+
+        static std::size_t total_bytes(std::size_t slot_count, std::size_t slot_capacity) {
+            return align(sizeof(SharedRingHeader)) + slot_count * slot_stride(slot_capacity);
+        }
+
+        static std::size_t slot_offset(std::size_t slot, std::size_t slot_stride) {
+            return align(sizeof(SharedRingHeader)) + slot * slot_stride;
+        }
+
+        static std::size_t data_offset() {
+            return align(sizeof(SharedSlotHeader));
+        }
+    };
+}
+
+#endif
\ No newline at end of file
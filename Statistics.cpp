@@ -0,0 +1,137 @@
+#include "Statistics.h"
+
+#include <cassert>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PROKYON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Prokyon {
+    PixelStatistics::PixelStatistics() :
+        m_mean{},
+        m_m2{},
+        m_count{0}
+    {}
+
+    void PixelStatistics::reset(std::size_t px) {
+        m_mean.assign(px, 0.0f);
+        m_m2.assign(px, 0.0f);
+        m_count = 0;
+    }
+
+    void PixelStatistics::add(const unsigned char *p_data, unsigned bits_per_component) {
+        assert(p_data != nullptr);
+        ++m_count;
+        auto inverse_count = 1.0f / static_cast<float>(m_count);
+        switch (bits_per_component) {
+            case 8:
+                add_8(p_data, inverse_count);
+                break;
+            case 16:
+                add_16(reinterpret_cast<const unsigned short *>(p_data), inverse_count);
+                break;
+            default:
+                --m_count;
+                throw StatisticsException();
+        }
+    }
+
+    std::size_t PixelStatistics::get_frame_count() const {
+        return m_count;
+    }
+
+    std::size_t PixelStatistics::get_px_count() const {
+        return m_mean.size();
+    }
+
+    double PixelStatistics::mean_of_means() const {
+        if (m_mean.empty()) { return 0.0; }
+        double sum = 0.0;
+        for (auto v : m_mean) {
+            sum += v;
+        }
+        return sum / m_mean.size();
+    }
+
+    double PixelStatistics::variance_of_means() const {
+        if (m_mean.size() < 2) { return 0.0; }
+        auto mean = mean_of_means();
+        double sum = 0.0;
+        for (auto v : m_mean) {
+            sum += (v - mean) * (v - mean);
+        }
+        return sum / (m_mean.size() - 1);
+    }
+
+    double PixelStatistics::mean_of_variances() const {
+        if (m_m2.empty() || m_count < 2) { return 0.0; }
+        double sum = 0.0;
+        for (auto v : m_m2) {
+            sum += v;
+        }
+        return sum / m_m2.size() / (m_count - 1);
+    }
+
+    // private
+    template<typename T>
+    void PixelStatistics::add_scalar(const T *p_data, std::size_t first, float inverse_count) {
+        auto p_mean = m_mean.data();
+        auto p_m2 = m_m2.data();
+        for (auto p = first; p < m_mean.size(); ++p) {
+            auto x = static_cast<float>(p_data[p]);
+            auto delta = x - p_mean[p];
+            p_mean[p] += delta * inverse_count;
+            p_m2[p] += delta * (x - p_mean[p]);
+        }
+    }
+
+    void PixelStatistics::add_8(const unsigned char *p_data, float inverse_count) {
+        std::size_t p = 0;
+#ifdef PROKYON_SSE2
+        const auto zero = _mm_setzero_si128();
+        const auto scale = _mm_set1_ps(inverse_count);
+        auto p_mean = m_mean.data();
+        auto p_m2 = m_m2.data();
+        for (; p + 16 <= m_mean.size(); p += 16) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data + p));
+            __m128i words[2] = {_mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero)};
+            for (unsigned q = 0; q < 4; ++q) {
+                auto dwords = (q % 2 == 0) ? _mm_unpacklo_epi16(words[q / 2], zero) : _mm_unpackhi_epi16(words[q / 2], zero);
+                auto x = _mm_cvtepi32_ps(dwords);
+                auto mean = _mm_loadu_ps(p_mean + p + 4 * q);
+                auto delta = _mm_sub_ps(x, mean);
+                mean = _mm_add_ps(mean, _mm_mul_ps(delta, scale));
+                _mm_storeu_ps(p_mean + p + 4 * q, mean);
+                auto m2 = _mm_loadu_ps(p_m2 + p + 4 * q);
+                _mm_storeu_ps(p_m2 + p + 4 * q, _mm_add_ps(m2, _mm_mul_ps(delta, _mm_sub_ps(x, mean))));
+            }
+        }
+#endif
+        add_scalar(p_data, p, inverse_count);
+    }
+
+    void PixelStatistics::add_16(const unsigned short *p_data, float inverse_count) {
+        std::size_t p = 0;
+#ifdef PROKYON_SSE2
+        const auto zero = _mm_setzero_si128();
+        const auto scale = _mm_set1_ps(inverse_count);
+        auto p_mean = m_mean.data();
+        auto p_m2 = m_m2.data();
+        for (; p + 8 <= m_mean.size(); p += 8) {
+            auto words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data + p));
+            for (unsigned q = 0; q < 2; ++q) {
+                auto dwords = (q == 0) ? _mm_unpacklo_epi16(words, zero) : _mm_unpackhi_epi16(words, zero);
+                auto x = _mm_cvtepi32_ps(dwords);
+                auto mean = _mm_loadu_ps(p_mean + p + 4 * q);
+                auto delta = _mm_sub_ps(x, mean);
+                mean = _mm_add_ps(mean, _mm_mul_ps(delta, scale));
+                _mm_storeu_ps(p_mean + p + 4 * q, mean);
+                auto m2 = _mm_loadu_ps(p_m2 + p + 4 * q);
+                _mm_storeu_ps(p_m2 + p + 4 * q, _mm_add_ps(m2, _mm_mul_ps(delta, _mm_sub_ps(x, mean))));
+            }
+        }
+#endif
+        add_scalar(p_data, p, inverse_count);
+    }
+}
\ No newline at end of file
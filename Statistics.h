@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef PROKYON_STATISTICS_H_
+#define PROKYON_STATISTICS_H_
+
+#include <cstddef>
+#include <exception>
+#include <vector>
+
+namespace Prokyon {
+    class StatisticsException;
+
+    // Running per pixel mean and variance over a stream of single component frames (Welford).
+    // Only two floats per pixel are kept, never the frames themselves.
+    class PixelStatistics {
+    public:
+        PixelStatistics();
+
+        void reset(std::size_t px);
+        void add(const unsigned char *p_data, unsigned bits_per_component); // throws StatisticsException
+
+        std::size_t get_frame_count() const;
+        std::size_t get_px_count() const;
+
+        // spatial summaries of the temporal statistics
+        double mean_of_means() const;
+        double variance_of_means() const; // fixed pattern
+        double mean_of_variances() const; // temporal noise, unbiased
+
+    private:
+        template<typename T>
+        void add_scalar(const T *p_data, std::size_t first, float inverse_count);
+        void add_8(const unsigned char *p_data, float inverse_count);
+        void add_16(const unsigned short *p_data, float inverse_count);
+
+    private:
+        std::vector<float> m_mean;
+        std::vector<float> m_m2;
+        std::size_t m_count;
+    };
+
+    class StatisticsException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
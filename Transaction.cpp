@@ -0,0 +1,163 @@
+#include "Transaction.h"
+
+#include "Parameters.h"
+#include "RegionOfInterest.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Prokyon {
+    Transaction::Transaction(const Keys &keys, const Hooks &hooks, const RegionOfInterest *p_roi, const NumericProperty *p_exposure) :
+        m_keys(keys),
+        m_hooks(hooks),
+        m_p_roi{p_roi},
+        m_p_exposure{p_exposure},
+        m_open{false},
+        m_staged{},
+        m_frame_mutex{},
+        m_number{0},
+        m_failed{0},
+        m_first_frame{false}
+    {
+        assert(p_roi != nullptr);
+        assert(p_exposure != nullptr);
+    }
+
+    std::size_t Transaction::begin() {
+        const auto discarded = m_staged.size();
+        m_staged.clear();
+        m_open = true;
+        return discarded;
+    }
+
+    Transaction::Check Transaction::stage(const std::string &key, const std::string &value) {
+        if (!m_open) { return Check::error; }
+        const auto result = check(key, value);
+        if (result == Check::ok) {
+            m_staged[key] = value;
+        }
+        return result;
+    }
+
+    Transaction::Check Transaction::check(const std::string &key, const std::string &value) const {
+        const auto follow = ranges_follow();
+
+        if (key == m_keys.roi) {
+            // the full frame, staged by ClearROI
+            if (value.empty()) { return Check::ok; }
+            std::vector<ROI> regions;
+            if (!parse_regions(value, regions) || regions.size() != 1) { return Check::invalid_value; }
+            return (follow || m_p_roi->allows(regions[0])) ? Check::ok : Check::invalid_value;
+        }
+        if (key == m_keys.exposure) {
+            double ms = 0.0;
+            try { ms = std::stod(value); }
+            catch (std::logic_error) { return Check::invalid_value; }
+            const auto us = std::round(ms * 1000.0);
+            if (!(0.0 <= us && us <= (std::numeric_limits<int>::max)())) { return Check::invalid_value; }
+            if (follow || !m_p_exposure->exists()) { return Check::ok; }
+            try { return m_p_exposure->allowed_int(static_cast<int>(us)) ? Check::ok : Check::invalid_value; }
+            catch (PropertyException) { return Check::error; }
+        }
+
+        const auto settable = m_hooks.check_settable(key);
+        if (settable != Check::ok) { return settable; }
+
+        // sdk numbers against the cached range, which the handler would clip to
+        const auto p_numeric = m_hooks.find_numeric(key);
+        if (p_numeric != nullptr) {
+            const auto &p = *p_numeric;
+            try {
+                if (p.type() == NumericProperty::Type::Int) {
+                    std::vector<int> v;
+                    if (!PropertyBase::parse_values(value, v) || v.size() != p.dimension()) { return Check::invalid_value; }
+                    const auto allowed = follow || std::all_of(v.cbegin(), v.cend(), [&p](int x) { return p.allowed_int(x); });
+                    return allowed ? Check::ok : Check::invalid_value;
+                }
+                if (p.type() == NumericProperty::Type::Double) {
+                    std::vector<double> v;
+                    if (!PropertyBase::parse_values(value, v) || v.size() != p.dimension()) { return Check::invalid_value; }
+                    const auto allowed = follow || std::all_of(v.cbegin(), v.cend(), [&p](double x) { return p.allowed_double(x); });
+                    return allowed ? Check::ok : Check::invalid_value;
+                }
+            }
+            catch (PropertyException) {
+                return Check::error;
+            }
+        }
+
+        return m_hooks.check_other(key, value);
+    }
+
+    Transaction::Values Transaction::get_ordered() const {
+        Values ordered(m_staged.cbegin(), m_staged.cend());
+        std::stable_sort(ordered.begin(), ordered.end(), [this](const std::pair<std::string, std::string> &a, const std::pair<std::string, std::string> &b) {
+            return m_hooks.rank(a.first) < m_hooks.rank(b.first);
+        });
+        // sub regions set the roi to their bounding box themselves
+        const auto regions = m_staged.find(m_keys.sub_regions);
+        if (regions != m_staged.cend() && !regions->second.empty()) {
+            ordered.erase(std::remove_if(ordered.begin(), ordered.end(), [this](const std::pair<std::string, std::string> &e) { return e.first == m_keys.roi; }), ordered.end());
+        }
+        return ordered;
+    }
+
+    unsigned Transaction::commit() {
+        assert(m_open);
+        // closed first, so the values are applied and not staged again
+        m_open = false;
+        const auto ordered = get_ordered();
+        m_staged.clear();
+
+        unsigned failed = 0;
+        for (const auto &entry : ordered) {
+            if (!m_hooks.apply(entry.first, entry.second)) {
+                ++failed;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_frame_mutex);
+        ++m_number;
+        m_failed = failed;
+        m_first_frame = (failed == 0);
+        return failed;
+    }
+
+    void Transaction::discard() {
+        m_staged.clear();
+        m_open = false;
+    }
+
+    bool Transaction::is_open() const {
+        return m_open;
+    }
+
+    std::size_t Transaction::get_staged_count() const {
+        return m_staged.size();
+    }
+
+    std::uint64_t Transaction::get_number() const {
+        std::lock_guard<std::mutex> lock(m_frame_mutex);
+        return m_number;
+    }
+
+    unsigned Transaction::get_failed_count() const {
+        std::lock_guard<std::mutex> lock(m_frame_mutex);
+        return m_failed;
+    }
+
+    bool Transaction::take_first_frame() {
+        std::lock_guard<std::mutex> lock(m_frame_mutex);
+        const auto first = m_first_frame;
+        m_first_frame = false;
+        return first;
+    }
+
+    // private
+    bool Transaction::ranges_follow() const {
+        return std::any_of(m_keys.range_changing.cbegin(), m_keys.range_changing.cend(), [this](const std::string &key) { return m_staged.count(key) != 0; });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef PROKYON_TRANSACTION_H_
+#define PROKYON_TRANSACTION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Prokyon {
+    class NumericProperty;
+    class RegionOfInterest;
+
+    // Values staged by preset key and applied together by one commit, keys are property names and the roi and exposure keys.
+    // A staged value is checked against the cached ranges only, nothing is written before the commit,
+    // which applies the values by rank, lowest first, so a value whose range follows from another comes after it.
+    // The device is reached only through the hooks, so the checks and the order do not depend on micromanager.
+    class Transaction {
+    public:
+        enum class Check : int {
+            ok = 0,
+            invalid_value = 1,
+            invalid_key = 2, // not a property, e.g. of another firmware
+            read_only = 3,
+            error = 4, // the range could not be read
+        };
+
+        struct Keys {
+            std::string roi; // "x, y, w, h", empty for the full frame, as ClearROI stages it
+            std::string exposure; // ms
+            std::string sub_regions; // set the roi to their bounding box themselves, a staged roi is then left out
+            std::vector<std::string> range_changing; // e.g. image mode and binning, ranges are unknown until they are set
+        };
+
+        struct Hooks {
+            std::function<Check(const std::string &key)> check_settable; // exists and is not read only
+            std::function<const NumericProperty *(const std::string &key)> find_numeric; // the sdk number of a key, nullptr if none
+            std::function<Check(const std::string &key, const std::string &value)> check_other; // allowed values or limits of the rest
+            std::function<int(const std::string &key)> rank; // lower ranks are applied first
+            std::function<bool(const std::string &key, const std::string &value)> apply; // returns success
+        };
+
+        using Values = std::vector<std::pair<std::string, std::string>>;
+
+        Transaction(const Keys &keys, const Hooks &hooks, const RegionOfInterest *p_roi, const NumericProperty *p_exposure);
+
+        std::size_t begin(); // returns the count of staged values discarded
+        Check stage(const std::string &key, const std::string &value); // the last value staged for a key wins
+        // nothing is written, ranges that follow from a staged image mode are left to the commit
+        Check check(const std::string &key, const std::string &value) const;
+        Values get_ordered() const; // staged values in the order commit applies them
+        // closes the transaction and applies what is staged, returns the count that failed
+        // the first frame after a commit is tagged only if none failed, no frame then has them all
+        unsigned commit();
+        void discard();
+        bool is_open() const;
+        std::size_t get_staged_count() const;
+
+        // of the frames, read and taken from the delivering thread
+        std::uint64_t get_number() const; // commits so far
+        unsigned get_failed_count() const; // of the last commit
+        bool take_first_frame(); // true for the first call after a commit none of whose values failed
+
+    private:
+        bool ranges_follow() const; // a range changing value is staged
+
+    private:
+        Keys m_keys;
+        Hooks m_hooks;
+        const RegionOfInterest *m_p_roi;
+        const NumericProperty *m_p_exposure;
+        bool m_open;
+        std::map<std::string, std::string> m_staged;
+
+        mutable std::mutex m_frame_mutex;
+        std::uint64_t m_number;
+        unsigned m_failed;
+        bool m_first_frame;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "UserDirectory.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <sys/stat.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace Prokyon {
+    std::string UserDirectory::get_path() {
+#ifdef _WIN32
+        const char *p_base = std::getenv("LOCALAPPDATA");
+        if (p_base == nullptr || *p_base == '\0') { return ""; }
+        return std::string{p_base} + "/ProkyonAdapter";
+#else
+        const char *p_base = std::getenv("XDG_CACHE_HOME");
+        if (p_base != nullptr && *p_base != '\0') {
+            return std::string{p_base} + "/prokyon-adapter";
+        }
+        p_base = std::getenv("HOME");
+        if (p_base == nullptr || *p_base == '\0') { return ""; }
+        return std::string{p_base} + "/.cache/prokyon-adapter";
+#endif
+    }
+
+    bool UserDirectory::make(const std::string &path) {
+        if (path.empty()) { return false; }
+        // existing levels just fail
+        for (auto end = path.find_first_of("/\\", 1); ; end = path.find_first_of("/\\", end + 1)) {
+            const auto level = path.substr(0, end);
+#ifdef _WIN32
+            _mkdir(level.c_str());
+#else
+            mkdir(level.c_str(), 0755);
+#endif
+            if (end == std::string::npos) { break; }
+        }
+#ifdef _WIN32
+        struct _stat info;
+        return _stat(path.c_str(), &info) == 0 && (info.st_mode & _S_IFDIR) != 0;
+#else
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+    }
+
+    std::string UserDirectory::sanitize(const std::string &s) {
+        std::string out;
+        for (auto c : s) {
+            const auto keep = ('0' <= c && c <= '9') || ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '-' || c == '_';
+            out.push_back(keep ? c : '_');
+        }
+        return out.empty() ? "unknown" : out;
+    }
+}
\ No newline at end of file
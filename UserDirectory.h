@@ -0,0 +1,18 @@
+#pragma once
+
+#ifndef PROKYON_USER_DIRECTORY_H_
+#define PROKYON_USER_DIRECTORY_H_
+
+#include <string>
+
+namespace Prokyon {
+    // Per user directory of the adapter, for files kept across sessions.
+    class UserDirectory {
+    public:
+        static std::string get_path(); // empty if unknown
+        static bool make(const std::string &path); // with every missing level, returns if it exists afterwards
+        static std::string sanitize(const std::string &s); // usable in a file name
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Throughput and latency of the shared memory ring, FramePublisher writing in one process, SharedFrameReader reading in another.
+// Linux only, the reader is a forked child. Build from this directory:
+//     g++ -std=c++14 -O2 -pthread -I.. SharedFrameBenchmark.cpp SharedFrameReader.cpp ../FramePublisher.cpp -o shared_frame_benchmark -lrt
+// Usage: shared_frame_benchmark [frames] [width] [height] [slots] [rate_hz, 0 for as fast as possible]
+// Exits with 1 if a frame was read with the wrong content or out of order.
+
+#include "SharedFrameReader.h"
+#include "../FramePublisher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    struct Options {
+        unsigned frames;
+        unsigned width;
+        unsigned height;
+        unsigned slots;
+        double rate_hz;
+    };
+
+    std::uint64_t now_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // every page of a frame carries the low byte of its sequence, so torn or stale copies show
+    void fill(std::vector<unsigned char> &frame, std::uint64_t sequence) {
+        for (std::size_t i = 0; i < frame.size(); i += 4096) {
+            frame[i] = static_cast<unsigned char>(sequence);
+        }
+    }
+
+    bool check(const std::vector<unsigned char> &frame, std::uint64_t sequence) {
+        for (std::size_t i = 0; i < frame.size(); i += 4096) {
+            if (frame[i] != static_cast<unsigned char>(sequence)) { return false; }
+        }
+        return true;
+    }
+
+    int read_frames(const std::string &name) {
+        Prokyon::SharedFrameReader reader(name);
+        Prokyon::SharedFrameInfo info{};
+        std::vector<unsigned char> data;
+        std::vector<double> latencies_us;
+        std::uint64_t last = 0;
+        unsigned long bad = 0;
+        while (true) {
+            auto status = reader.read_next(info, data);
+            if (status == Prokyon::SharedFrameReader::Status::closed) { break; }
+            if (status == Prokyon::SharedFrameReader::Status::no_frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            latencies_us.push_back((now_ns() - info.timestamp_ns) / 1e3);
+            if (info.sequence <= last || !check(data, info.sequence)) {
+                ++bad;
+            }
+            last = info.sequence;
+        }
+
+        std::printf("read %lu frames, lost %lu, bad %lu\n", static_cast<unsigned long>(latencies_us.size()), static_cast<unsigned long>(reader.get_lost_count()), bad);
+        if (!latencies_us.empty()) {
+            std::sort(latencies_us.begin(), latencies_us.end());
+            double sum = 0.0;
+            for (auto l : latencies_us) {
+                sum += l;
+            }
+            auto at = [&](double q) { return latencies_us[static_cast<std::size_t>(q * (latencies_us.size() - 1))]; };
+            std::printf("latency us: mean %.1f, median %.1f, p99 %.1f, max %.1f\n", sum / latencies_us.size(), at(0.5), at(0.99), latencies_us.back());
+        }
+        return (bad == 0) ? 0 : 1;
+    }
+
+    void write_frames(Prokyon::FramePublisher &publisher, const Options &options) {
+        std::vector<unsigned char> frame(static_cast<std::size_t>(options.width) * options.height);
+        const auto interval = (0.0 < options.rate_hz) ? std::chrono::nanoseconds(static_cast<long long>(1e9 / options.rate_hz)) : std::chrono::nanoseconds(0);
+        const auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 1; i <= options.frames; ++i) {
+            if (0 < interval.count()) {
+                std::this_thread::sleep_until(t0 + i * interval);
+            }
+            fill(frame, i);
+            publisher.publish(frame.data(), frame.size(), options.width, options.height, 1, 8, 0);
+        }
+        const auto s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("published %u frames of %u x %u in %.3f s, %.1f fps, %.1f MB/s\n", options.frames, options.width, options.height, s, options.frames / s, options.frames * frame.size() / s / 1e6);
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options{10000, 2048, 2048, 8, 0.0};
+    if (1 < argc) { options.frames = static_cast<unsigned>(std::atoi(argv[1])); }
+    if (2 < argc) { options.width = static_cast<unsigned>(std::atoi(argv[2])); }
+    if (3 < argc) { options.height = static_cast<unsigned>(std::atoi(argv[3])); }
+    if (4 < argc) { options.slots = static_cast<unsigned>(std::atoi(argv[4])); }
+    if (5 < argc) { options.rate_hz = std::atof(argv[5]); }
+
+    const std::string name = "prokyon_benchmark_" + std::to_string(getpid());
+    Prokyon::FramePublisher publisher;
+    if (!publisher.open(name, options.slots, static_cast<std::size_t>(options.width) * options.height)) {
+        std::fprintf(stderr, "could not open the ring %s\n", name.c_str());
+        return 1;
+    }
+
+    auto pid = fork();
+    if (pid < 0) {
+        std::fprintf(stderr, "could not start the reader\n");
+        return 1;
+    }
+    if (pid == 0) {
+        // leaves without destructors, the publisher copy of the child must not close the ring
+        auto ret = 1;
+        try { ret = read_frames(name); }
+        catch (Prokyon::SharedFrameReaderException) {
+            std::fprintf(stderr, "could not open the ring %s for reading\n", name.c_str());
+        }
+        std::fflush(stdout);
+        _exit(ret);
+    }
+
+    // the reader maps the ring before the first frame, so it sees all of them unless it falls behind
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    write_frames(publisher, options);
+    // time for the reader to take the last frames before it sees the ring closed
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    publisher.close();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : 1;
+}
\ No newline at end of file
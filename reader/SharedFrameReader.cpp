@@ -0,0 +1,173 @@
+#include "SharedFrameReader.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Prokyon {
+    SharedFrameReader::SharedFrameReader(const std::string &name) :
+        m_p_base{nullptr},
+        m_bytes{0},
+        m_p_header{nullptr},
+        m_next{1},
+        m_lost{0}
+#ifdef _WIN32
+        , m_mapping{nullptr}
+#endif
+    {
+#ifdef _WIN32
+        auto object_name = "Local\\" + name;
+        m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, object_name.c_str());
+        if (m_mapping == nullptr) { throw SharedFrameReaderException(); }
+        m_p_base = static_cast<const unsigned char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        MEMORY_BASIC_INFORMATION info{};
+        if (m_p_base == nullptr || VirtualQuery(m_p_base, &info, sizeof(info)) == 0) {
+            unmap();
+            throw SharedFrameReaderException();
+        }
+        m_bytes = info.RegionSize;
+#else
+        auto shm_name = "/" + name;
+        auto fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) { throw SharedFrameReaderException(); }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            throw SharedFrameReaderException();
+        }
+        auto p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { throw SharedFrameReaderException(); }
+        m_p_base = static_cast<const unsigned char *>(p);
+        m_bytes = static_cast<std::size_t>(st.st_size);
+#endif
+
+        // refuse anything that is not a complete ring of a known version
+        m_p_header = reinterpret_cast<const SharedRingHeader *>(m_p_base);
+        auto valid = sizeof(SharedRingHeader) <= m_bytes
+            && m_p_header->magic == SharedFrameLayout::M_S_MAGIC
+            && m_p_header->version == SharedFrameLayout::M_S_VERSION
+            && SharedFrameLayout::total_bytes(m_p_header->slot_count, static_cast<std::size_t>(m_p_header->slot_capacity)) <= m_bytes;
+        if (!valid) {
+            unmap();
+            throw SharedFrameReaderException();
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // follow the writer from now on
+        m_next = m_p_header->write_sequence.load(std::memory_order_acquire) + 1;
+    }
+
+    SharedFrameReader::~SharedFrameReader() {
+        unmap();
+    }
+
+    SharedFrameReader::Status SharedFrameReader::read_next(SharedFrameInfo &info, std::vector<unsigned char> &data) {
+        if (m_p_header->magic != SharedFrameLayout::M_S_MAGIC) { return Status::closed; }
+
+        while (true) {
+            const auto head = m_p_header->write_sequence.load(std::memory_order_acquire);
+            if (head < m_next) { return Status::no_frame; }
+
+            const std::uint64_t slot_count = m_p_header->slot_count;
+            const auto oldest = (slot_count <= head) ? head - slot_count + 1 : 1;
+            if (m_next < oldest) {
+                m_lost += oldest - m_next;
+                m_next = oldest;
+            }
+            if (try_copy(m_next, info, data)) {
+                ++m_next;
+                return Status::ok;
+            }
+            // overwritten while copying
+            ++m_lost;
+            ++m_next;
+        }
+    }
+
+    SharedFrameReader::Status SharedFrameReader::read_latest(SharedFrameInfo &info, std::vector<unsigned char> &data) {
+        if (m_p_header->magic != SharedFrameLayout::M_S_MAGIC) { return Status::closed; }
+
+        while (true) {
+            const auto head = m_p_header->write_sequence.load(std::memory_order_acquire);
+            if (head < m_next) { return Status::no_frame; }
+            if (try_copy(head, info, data)) {
+                m_next = head + 1;
+                return Status::ok;
+            }
+            // the writer lapped the whole ring during the copy, try its newest frame
+        }
+    }
+
+    std::uint64_t SharedFrameReader::get_lost_count() const {
+        return m_lost;
+    }
+
+    unsigned SharedFrameReader::get_slot_count() const {
+        return m_p_header->slot_count;
+    }
+
+    std::size_t SharedFrameReader::get_slot_capacity() const {
+        return static_cast<std::size_t>(m_p_header->slot_capacity);
+    }
+
+    // private
+    bool SharedFrameReader::try_copy(std::uint64_t sequence, SharedFrameInfo &info, std::vector<unsigned char> &data) const {
+        const auto stride = static_cast<std::size_t>(m_p_header->slot_stride);
+        auto p_slot = m_p_base + SharedFrameLayout::slot_offset(static_cast<std::size_t>(sequence % m_p_header->slot_count), stride);
+        auto p_slot_header = reinterpret_cast<const SharedSlotHeader *>(p_slot);
+
+        const auto before = p_slot_header->sequence.load(std::memory_order_acquire);
+        if (before != 2 * sequence) { return false; }
+
+        info.sequence = sequence;
+        info.timestamp_ns = p_slot_header->timestamp_ns;
+        info.width = p_slot_header->width;
+        info.height = p_slot_header->height;
+        info.components = p_slot_header->components;
+        info.bits_per_component = p_slot_header->bits_per_component;
+        info.channel = p_slot_header->channel;
+        // a torn size is caught by the sequence check below, only keep the copy in bounds
+        auto bytes = static_cast<std::size_t>(p_slot_header->bytes);
+        if (m_p_header->slot_capacity < bytes) {
+            bytes = static_cast<std::size_t>(m_p_header->slot_capacity);
+        }
+        info.bytes = bytes;
+        data.resize(bytes);
+        std::memcpy(data.data(), p_slot + SharedFrameLayout::data_offset(), bytes);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return p_slot_header->sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    void SharedFrameReader::unmap() {
+#ifdef _WIN32
+        if (m_p_base != nullptr) {
+            UnmapViewOfFile(m_p_base);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+#else
+        if (m_p_base != nullptr) {
+            munmap(const_cast<unsigned char *>(m_p_base), m_bytes);
+        }
+#endif
+        m_p_base = nullptr;
+        m_p_header = nullptr;
+        m_bytes = 0;
+    }
+}
\ No newline at end of file
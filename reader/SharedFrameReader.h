@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef PROKYON_SHARED_FRAME_READER_H_
+#define PROKYON_SHARED_FRAME_READER_H_
+
+#include "../SharedFrameLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace Prokyon {
+    struct SharedFrameInfo {
+        std::uint64_t sequence; // frame number, counting from 1
+        std::uint64_t timestamp_ns; // std::chrono::steady_clock at publication
+        unsigned width;
+        unsigned height;
+        unsigned components;
+        unsigned bits_per_component;
+        unsigned channel; // sub region index, SharedFrameLayout::M_S_PREVIEW_CHANNEL for the decimated preview
+        std::size_t bytes;
+    };
+
+    // Consumer side of the shared memory ring written by the adapter's FramePublisher.
+    // Maps the ring read only and follows the writer without locks, the writer never waits for readers.
+    // Build this file and SharedFrameLayout.h into the analysis process, it has no other dependencies.
+    class SharedFrameReader {
+    public:
+        enum class Status {
+            ok,
+            no_frame, // nothing newer than the last frame read
+            closed // the writer closed the ring, reopen to continue
+        };
+
+        SharedFrameReader(const std::string &name); // throws SharedFrameReaderException
+        ~SharedFrameReader();
+        SharedFrameReader(const SharedFrameReader &) = delete;
+        SharedFrameReader &operator=(const SharedFrameReader &) = delete;
+
+        // next frame after the last one read, skipping ahead if the writer lapped this reader
+        Status read_next(SharedFrameInfo &info, std::vector<unsigned char> &data);
+        // newest complete frame, dropping everything in between
+        Status read_latest(SharedFrameInfo &info, std::vector<unsigned char> &data);
+
+        std::uint64_t get_lost_count() const; // frames overwritten before they could be read
+        unsigned get_slot_count() const;
+        std::size_t get_slot_capacity() const;
+
+    private:
+        bool try_copy(std::uint64_t sequence, SharedFrameInfo &info, std::vector<unsigned char> &data) const; // returns success
+        void unmap();
+
+    private:
+        const unsigned char *m_p_base;
+        std::size_t m_bytes;
+        const SharedRingHeader *m_p_header;
+        std::uint64_t m_next;
+        std::uint64_t m_lost;
+#ifdef _WIN32
+        void *m_mapping;
+#endif
+    };
+
+    class SharedFrameReaderException : public std::exception {};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+// Heap allocations on the per frame and per property paths, counted by replacing operator new.
+// Parameter reads and writes into caller storage, and frames through a running Pipeline, allocate nothing once warm.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/AllocationTest.cpp Parameters.cpp ParameterRegistry.cpp SdkThread.cpp Pipeline.cpp BufferPool.cpp FrameMemory.cpp Scheduling.cpp tests/FakeSdk.cpp -o allocation_test
+// Exits with 1 if a path allocated.
+
+#include "BufferPool.h"
+#include "FakeSdk.h"
+#include "ParameterRegistry.h"
+#include "Parameters.h"
+#include "Pipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::atomic<long> allocations{0};
+}
+
+void *operator new(std::size_t bytes) {
+    ++allocations;
+    if (auto p = std::malloc(bytes == 0 ? 1 : bytes)) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    using namespace Prokyon;
+
+    unsigned failures = 0;
+
+    // allocations since the last check
+    void expect_none(const char *what, long &since) {
+        const auto count = allocations - since;
+        std::printf("%-40s %ld allocations\n", what, count);
+        if (count != 0) {
+            ++failures;
+        }
+        since = allocations;
+    }
+
+    class AddOne : public Stage {
+    public:
+        AddOne(bool ordered) : m_ordered{ordered} {}
+        std::string get_name() const { return "add one"; }
+        FrameLayout get_output_layout(const FrameLayout &input) const { return input; }
+        bool is_in_place() const { return true; }
+        bool is_ordered() const { return m_ordered; }
+        void process(const Frame &input, Frame &output) {
+            for (std::size_t i = 0; i < input.layout.bytes(); ++i) {
+                output.p_data[i] = static_cast<unsigned char>(input.p_data[i] + 1);
+            }
+        }
+
+    private:
+        bool m_ordered;
+    };
+
+    void parameter_rounds(DijSDK_Handle handle, unsigned rounds) {
+        for (unsigned i = 0; i < rounds; ++i) {
+            ParameterArray<ParameterIdImageCaptureGain> gain;
+            read_parameter<ParameterIdImageCaptureGain>(handle, gain);
+            write_parameter<ParameterIdImageCaptureGain>(handle, gain);
+            ParameterArray<ParameterIdImageCaptureExposureTimeUsec> exposure;
+            read_parameter<ParameterIdImageCaptureExposureTimeUsec>(handle, exposure, DijSDK_EParamQueryMax);
+            auto histogram = read_numeric_values<int>(handle, ParameterIdImageProcessingHistogramGrey, 256);
+            (void)histogram;
+            int roi[4];
+            read_numeric_parameter<int>(handle, ParameterIdImageCaptureRoi, roi, 4);
+            write_numeric_parameter<int>(handle, ParameterIdImageCaptureRoi, roi, 4);
+            char name[64];
+            read_string_parameter(handle, ParameterIdGlobalSettingsCameraName, name, sizeof(name));
+        }
+    }
+
+    // submits until count frames went in, the delivery checks order and content
+    void pipeline_frames(Pipeline &pipeline, const FrameLayout &layout, unsigned count) {
+        unsigned submitted = 0;
+        while (submitted < count) {
+            auto p_data = pipeline.begin_frame();
+            if (p_data == nullptr) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memset(p_data, 0, layout.bytes());
+            pipeline.submit_frame(FrameStamp{-1, 0});
+            ++submitted;
+        }
+    }
+}
+
+int main() {
+    DijSDK_Handle handle = nullptr;
+    DijSDK_OpenCamera("fake", &handle);
+
+    // warm, the range cache and the sdk's own state
+    parameter_rounds(handle, 1);
+    long since = allocations;
+    parameter_rounds(handle, 1000);
+    expect_none("parameter reads and writes, 1000 rounds", since);
+
+    BufferPool pool(FrameBuffer::default_options(), 1 << 26);
+    Pipeline pipeline(&pool);
+    pipeline.set_stages({std::make_shared<AddOne>(false), std::make_shared<AddOne>(true)});
+    const FrameLayout layout{64, 64, 1, 8, 1, 0};
+    std::uint64_t expected = 1;
+    unsigned bad = 0;
+    pipeline.start(layout, 4, 6, [&](const Frame &frame) {
+        if (frame.sequence != expected || frame.p_data[0] != 2) {
+            ++bad;
+        }
+        expected = frame.sequence + 1;
+    });
+    pipeline_frames(pipeline, layout, 100);
+    since = allocations;
+    pipeline_frames(pipeline, layout, 5000);
+    expect_none("pipeline, 5000 frames", since);
+    pipeline.stop();
+    if (bad != 0 || pipeline.get_delivered_count() != 5100) {
+        std::printf("pipeline delivered %lu, %u out of order or wrong\n", static_cast<unsigned long>(pipeline.get_delivered_count()), bad);
+        ++failures;
+    }
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
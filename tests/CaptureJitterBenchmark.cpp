@@ -0,0 +1,118 @@
+// Frame interval jitter of a Capture under CPU load, without and with a capture policy (Scheduling::apply), against the fake SDK.
+// The fake sensor delivers at a fixed period, busy threads at normal priority keep every core loaded, so how late the
+// sdk thread gets the frame shows in the spread of the intervals Capture measures.
+// The policy is the highest priority where the OS permits it, pinned to the last core where there is more than one.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones, with optimization:
+//     g++ -std=c++14 -O2 -pthread -Itests/sdk -Itests -I. tests/CaptureJitterBenchmark.cpp SdkThread.cpp Camera.cpp Capture.cpp Pipeline.cpp BufferPool.cpp FrameMemory.cpp Scheduling.cpp tests/FakeSdk.cpp -o capture_jitter_benchmark
+// Reports mean, sd and max of the intervals, exits with 1 only if a capture fails, the numbers depend on the machine.
+
+#include "BufferPool.h"
+#include "Camera.h"
+#include "Capture.h"
+#include "FakeSdk.h"
+#include "Pipeline.h"
+#include "Scheduling.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+
+    const unsigned M_S_INTERVAL_US = 2000;
+    const long M_S_FRAMES = 1000;
+
+    class Copy : public Stage {
+    public:
+        std::string get_name() const { return "copy"; }
+        FrameLayout get_output_layout(const FrameLayout &input) const { return input; }
+        void process(const Frame &input, Frame &output) { std::memcpy(output.p_data, input.p_data, input.layout.bytes()); }
+    };
+
+    // spins on every core, twice over, until stopped
+    class Load {
+    public:
+        Load() : m_done{false}, m_threads{} {
+            for (unsigned t = 0; t < 2 * Scheduling::get_core_count(); ++t) {
+                m_threads.emplace_back([this]() {
+                    volatile unsigned long sink = 0;
+                    while (!m_done) {
+                        for (unsigned i = 0; i < 100000; ++i) { sink = sink + i; }
+                    }
+                });
+            }
+        }
+
+        ~Load() {
+            m_done = true;
+            for (auto &t : m_threads) {
+                t.join();
+            }
+        }
+
+    private:
+        std::atomic<bool> m_done;
+        std::vector<std::thread> m_threads;
+    };
+
+    bool capture(Camera &camera, const ThreadPolicy &policy, const char *what) {
+        const FrameLayout layout{64, 64, 1, 8, 1, 0};
+        BufferPool pool(FrameBuffer::default_options(), 1 << 24);
+        Pipeline pipeline(&pool);
+        pipeline.set_stages({std::make_shared<Copy>()});
+        pipeline.start(layout, 1, 4, [](const Frame &) {});
+
+        Capture capture(&camera, &pipeline);
+        capture.set_policy(policy);
+        auto failed = false;
+        {
+            Load load;
+            if (!capture.start(layout.bytes(), M_S_FRAMES, [&](bool f) { failed = f; })) { return false; }
+            while (capture.is_running()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            capture.stop();
+        }
+        pipeline.stop();
+
+        const auto s = capture.get_interval_statistics();
+        std::printf("%-44s %5lu intervals, mean %7.3f ms, sd %7.3f ms, max %7.3f ms\n", what, static_cast<unsigned long>(s.count), s.mean_ms, s.sd_ms, s.max_ms);
+        return !failed && s.count != 0;
+    }
+}
+
+int main() {
+    Camera camera;
+    const DijSDK_CameraKey key{};
+    if (camera.initialize(&key, "fake", "fake") != Camera::Status::state_changed) {
+        std::printf("camera not initialized\nFAILED\n");
+        return 1;
+    }
+    FakeSdk::set_frame_size(64, 64);
+    FakeSdk::set_frame_interval_us(M_S_INTERVAL_US);
+    std::printf("%u us frame period, %u cores, %u busy threads\n", M_S_INTERVAL_US, Scheduling::get_core_count(), 2 * Scheduling::get_core_count());
+
+    ThreadPolicy policy{{}, ThreadPriority::highest};
+    if (1 < Scheduling::get_core_count()) {
+        policy.cores = {Scheduling::get_core_count() - 1};
+    }
+    auto permitted = false;
+    std::thread probe([&]() { permitted = Scheduling::apply(policy); });
+    probe.join();
+    if (!permitted) {
+        std::printf("the policy is not permitted here, both runs are under the default policy\n");
+    }
+
+    auto ok = capture(camera, ThreadPolicy{{}, ThreadPriority::normal}, "default policy, normal priority, any core");
+    ok = capture(camera, policy, "capture policy") && ok;
+    FakeSdk::set_frame_interval_us(0);
+    camera.shutdown();
+
+    std::printf("%s\n", ok ? "done" : "FAILED");
+    return ok ? 0 : 1;
+}
\ No newline at end of file
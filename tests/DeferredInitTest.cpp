@@ -0,0 +1,142 @@
+// Time from initialize to the first snap against the fake SDK with a latency per call, see FakeSdk.h.
+// ProkyonCamera needs the MMDevice runtime, so its start-up is replayed with the classes it uses: the essential properties,
+// the image and one snap, with the other registry parameters queried either before them (synchronous start)
+// or on a thread meanwhile (deferred start, as ProkyonCamera::initialize_deferred), their specifications going into
+// the ModeCatalogue the snap path selects modes from.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/DeferredInitTest.cpp Image.cpp Conversion.cpp RegionOfInterest.cpp Preview.cpp FocusMetric.cpp FramePublisher.cpp Camera.cpp Parameters.cpp ParameterRegistry.cpp ModeCatalogue.cpp UserDirectory.cpp SdkThread.cpp BufferPool.cpp FrameMemory.cpp tests/FakeSdk.cpp -lrt -o deferred_init_test
+// Exits with 1 if the deferred start does not snap sooner or queries a different set of parameters.
+
+#include "BufferPool.h"
+#include "Camera.h"
+#include "FakeSdk.h"
+#include "Image.h"
+#include "ModeCatalogue.h"
+#include "ParameterRegistry.h"
+#include "Parameters.h"
+#include "RegionOfInterest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+    using namespace Prokyon;
+    using Clock = std::chrono::steady_clock;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const char *what) {
+        std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    double ms_since(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // every readable numeric registry parameter, as ProkyonCamera::query_property, returns how many exist
+    // strings are left out, the fake sdk has all but the camera name as doubles
+    unsigned query_deferred(Camera &camera, ModeCatalogue &catalogue) {
+        unsigned existing = 0;
+        for (std::size_t i = 0; i < ParameterRegistry::size(); ++i) {
+            const auto &entry = ParameterRegistry::at(i);
+            if (!entry.readable || entry.type == PropertyBase::Type::String) { continue; }
+            try {
+                auto p_property = std::make_unique<NumericProperty>(camera, entry.id);
+                if (p_property->exists()) {
+                    const auto type = p_property->type();
+                    if (type == PropertyBase::Type::Int || type == PropertyBase::Type::Double) {
+                        p_property->get_as_string();
+                    }
+                    else {
+                        p_property->get_int();
+                    }
+                }
+                ModeCatalogue::Spec spec;
+                if (!catalogue.find_spec(entry.id_name, spec)) {
+                    spec.exists = p_property->exists();
+                    spec.description = spec.exists ? p_property->short_specification_to_string() : "";
+                    catalogue.set_spec(entry.id_name, spec);
+                }
+                existing += spec.exists ? 1 : 0;
+            }
+            catch (PropertyException) {}
+        }
+        return existing;
+    }
+
+    // the properties a snap needs, then the snap, returns its success
+    bool snap_essential(Camera &camera, ModeCatalogue &catalogue, BufferPool &pool) {
+        NumericProperty exposure(camera, ParameterIdImageCaptureExposureTimeUsec);
+        NumericProperty gain(camera, ParameterIdImageCaptureGain);
+        std::string mode_name;
+        catalogue.select_mode(1, mode_name);
+        RegionOfInterest roi(&camera);
+        roi.set({0, 0, 64, 48});
+        Image image(&camera, &pool);
+        image.set_region_of_interest(&roi);
+        return exposure.exists() && gain.exists() && image.update() && image.acquire();
+    }
+
+    struct StartUp {
+        double snap_ms; // from the start to the first image
+        double all_ms; // until every parameter is queried as well
+        unsigned existing;
+        bool snapped;
+    };
+
+    StartUp start(Camera &camera, BufferPool &pool, bool deferred) {
+        ModeCatalogue catalogue("fake", "fake");
+        ModeCatalogue::Mode mode{0, {{64, 48}}, {{1, 1}}, {{1, 1}}, {{1, 1}}, {{8, 8}}, {{1.0, 1.0}}, 0};
+        catalogue.set_modes({{"fake", mode}});
+        StartUp out{0.0, 0.0, 0, false};
+        const auto t0 = Clock::now();
+        if (deferred) {
+            std::thread init([&]() { out.existing = query_deferred(camera, catalogue); });
+            out.snapped = snap_essential(camera, catalogue, pool);
+            out.snap_ms = ms_since(t0);
+            init.join();
+        }
+        else {
+            out.existing = query_deferred(camera, catalogue);
+            out.snapped = snap_essential(camera, catalogue, pool);
+            out.snap_ms = ms_since(t0);
+        }
+        out.all_ms = ms_since(t0);
+        std::printf("%-12s first snap %8.1f ms, all parameters %8.1f ms, %u existing\n", deferred ? "deferred" : "synchronous", out.snap_ms, out.all_ms, out.existing);
+        return out;
+    }
+}
+
+int main() {
+    Camera camera;
+    const DijSDK_CameraKey key{};
+    if (camera.initialize(&key, "fake", "fake") != Camera::Status::state_changed) {
+        std::printf("camera not initialized\nFAILED\n");
+        return 1;
+    }
+    {
+        FakeSdk::set_frame_size(64, 48);
+        BufferPool pool(FrameBuffer::default_options(), 1 << 24);
+        // a camera on a slow link, each call a few hundred microseconds
+        FakeSdk::set_call_duration_us(300);
+        const auto synchronous = start(camera, pool, false);
+        const auto deferred = start(camera, pool, true);
+        FakeSdk::set_call_duration_us(0);
+
+        expect(synchronous.snapped && deferred.snapped, "both starts snapped");
+        expect(synchronous.existing == deferred.existing && 0 < deferred.existing, "the same parameters found");
+        // the snap waits behind one background query per call at most, not behind all of them
+        expect(2.0 * deferred.snap_ms < synchronous.snap_ms, "deferred snaps in less than half the time");
+    }
+    camera.shutdown();
+    FakeSdk::set_frame_size(640, 480);
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
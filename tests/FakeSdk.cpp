@@ -0,0 +1,298 @@
+#include "FakeSdk.h"
+
+#include "SdkThread.h"
+
+#include "dijsdk.h"
+#include "dijsdkerror.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Prokyon {
+    namespace {
+        struct Spec {
+            DijSDK_EParamType type;
+            unsigned dimension;
+            double min;
+            double max;
+            std::vector<int> set; // discrete values, empty for a range
+        };
+
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> parameter_calls{0};
+        std::atomic<std::uint64_t> frames{0};
+        std::atomic<std::uint64_t> released{0};
+        std::atomic<std::uint64_t> starts{0};
+        std::atomic<std::uint64_t> aborts{0};
+        std::atomic<std::uint64_t> overlaps{0};
+        std::atomic<std::uint64_t> foreign_calls{0};
+        std::atomic<int> in_sdk{0};
+        std::atomic<unsigned> call_duration_us{0};
+        unsigned roi_alignment = 1;
+        int failing_parameter = -1;
+        std::atomic<unsigned> frame_interval_us{0};
+        std::chrono::steady_clock::time_point next_frame;
+
+        std::mutex state_mutex;
+        std::map<int, std::vector<double>> values;
+        std::vector<unsigned char> frame(640 * 480);
+        unsigned frame_width = 640;
+        unsigned frame_height = 480;
+        int sensor_counter = 0;
+        int camera = 1; // its address is the handle
+
+        Spec spec_of(DijSDK_EParamId id) {
+            switch (id) {
+                case ParameterIdImageCaptureExposureTimeUsec: return Spec{DijSDK_EParamTypeInteger, 1, 10.0, 10e6, {}};
+                case ParameterIdImageCaptureGain: return Spec{DijSDK_EParamTypeDouble, 1, 1.0, 16.0, {}};
+                case ParameterIdImageCaptureRoi: return Spec{DijSDK_EParamTypeInteger, 4, 0.0, 4096.0, {}};
+                case ParameterIdImageModeSize: return Spec{DijSDK_EParamTypeInteger, 2, 0.0, 4096.0, {}};
+                case ParameterIdSensorImageCounter: return Spec{DijSDK_EParamTypeInteger, 1, 0.0, 2147483647.0, {}};
+                case ParameterIdImageProcessingOutputFormat:
+                    return Spec{DijSDK_EParamTypeInteger, 1, 0.0, 0.0, {DijSDK_EImageFormatGrey8, DijSDK_EImageFormatGrey16, DijSDK_EImageFormatRGB888}};
+                case ParameterIdGlobalSettingsCameraName: return Spec{DijSDK_EParamTypeString, 1, 0.0, 0.0, {}};
+                default: return Spec{DijSDK_EParamTypeDouble, 1, 0.0, 100.0, {}};
+            }
+        }
+
+        // every entry point holds one of these for the whole call
+        class Call {
+        public:
+            Call(bool parameter) {
+                ++calls;
+                if (parameter) {
+                    ++parameter_calls;
+                }
+                if (in_sdk.fetch_add(1) != 0) {
+                    ++overlaps;
+                }
+                if (SdkThread::is_running() && !SdkThread::is_owner()) {
+                    ++foreign_calls;
+                }
+                if (0 < call_duration_us) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(call_duration_us));
+                }
+            }
+            ~Call() {
+                --in_sdk;
+            }
+        };
+
+        std::vector<double> &value_of(DijSDK_EParamId id) {
+            auto it = values.find(id);
+            if (it == values.end()) {
+                const auto spec = spec_of(id);
+                const auto initial = spec.set.empty() ? spec.min : spec.set[0];
+                it = values.emplace(id, std::vector<double>(spec.dimension, initial)).first;
+            }
+            return it->second;
+        }
+
+        template<typename T>
+        error_t get(DijSDK_EParamId id, T *p_value, unsigned count, DijSDK_EParamQuery query) {
+            Call call(true);
+            std::lock_guard<std::mutex> lock(state_mutex);
+            const auto spec = spec_of(id);
+            if (count < spec.dimension) { return 1; }
+            for (unsigned i = 0; i < spec.dimension; ++i) {
+                double v = 0.0;
+                switch (query) {
+                    case DijSDK_EParamQueryMin: v = spec.min; break;
+                    case DijSDK_EParamQueryMax: v = spec.max; break;
+                    case DijSDK_EParamQueryDefault: v = spec.min; break;
+                    default: v = (id == ParameterIdSensorImageCounter) ? sensor_counter : value_of(id)[i]; break;
+                }
+                p_value[i] = static_cast<T>(v);
+            }
+            return E_OK;
+        }
+
+        template<typename T>
+        error_t set(DijSDK_EParamId id, const T *p_value, unsigned count) {
+            Call call(true);
+            std::lock_guard<std::mutex> lock(state_mutex);
+            auto &v = value_of(id);
+            if (count != v.size() || id == failing_parameter) { return 1; }
+            std::copy(p_value, p_value + count, v.begin());
+            if (id == ParameterIdImageCaptureRoi && 1 < roi_alignment) {
+                v[2] = (std::max)(1.0, std::floor(v[2] / roi_alignment)) * roi_alignment;
+                v[3] = (std::max)(1.0, std::floor(v[3] / roi_alignment)) * roi_alignment;
+            }
+            return E_OK;
+        }
+    }
+
+    namespace FakeSdk {
+        Counters get_counters() {
+            return Counters{calls, parameter_calls, frames, released, starts, aborts, overlaps, foreign_calls};
+        }
+
+        void reset_counters() {
+            calls = 0;
+            parameter_calls = 0;
+            frames = 0;
+            released = 0;
+            starts = 0;
+            aborts = 0;
+            overlaps = 0;
+            foreign_calls = 0;
+        }
+
+        void set_frame_size(unsigned width, unsigned height) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            frame_width = width;
+            frame_height = height;
+            frame.assign(static_cast<std::size_t>(width) * height, 0);
+        }
+
+        void set_call_duration_us(unsigned us) {
+            call_duration_us = us;
+        }
+
+        void set_frame_interval_us(unsigned us) {
+            frame_interval_us = us;
+        }
+
+        void set_failing_parameter(int id) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            failing_parameter = id;
+        }
+
+        void set_roi_alignment(unsigned px) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            roi_alignment = (std::max)(px, 1u);
+        }
+    }
+}
+
+using namespace Prokyon;
+
+error_t DijSDK_Init(const DijSDK_CameraKey *, unsigned) {
+    Call call(false);
+    return E_OK;
+}
+
+error_t DijSDK_Exit() {
+    Call call(false);
+    return E_OK;
+}
+
+error_t DijSDK_FindCameras(DijSDK_CamGuid *guids, unsigned *count) {
+    Call call(false);
+    // the adapter opens the second entry, the first is the SDK's synthetic camera
+    for (unsigned i = 0; guids != nullptr && i < *count; ++i) {
+        std::strcpy(guids[i], (i == 0) ? "synthetic" : "fake");
+    }
+    *count = 2;
+    return E_OK;
+}
+
+error_t DijSDK_OpenCamera(const DijSDK_CamGuid, DijSDK_Handle *h) {
+    Call call(false);
+    *h = &camera;
+    return E_OK;
+}
+
+error_t DijSDK_CloseCamera(DijSDK_Handle) {
+    Call call(false);
+    return E_OK;
+}
+
+error_t DijSDK_GetVersion(char *v, unsigned len) {
+    Call call(false);
+    std::strncpy(v, "fake", len);
+    return E_OK;
+}
+
+error_t DijSDK_StartAcquisition(DijSDK_Handle) {
+    Call call(false);
+    ++starts;
+    return E_OK;
+}
+
+error_t DijSDK_AbortAcquisition(DijSDK_Handle) {
+    Call call(false);
+    ++aborts;
+    return E_OK;
+}
+
+error_t DijSDK_GetImage(DijSDK_Handle, DijSDK_Handle *img, void **data) {
+    Call call(false);
+    const auto interval = std::chrono::microseconds(frame_interval_us);
+    if (interval.count() != 0) {
+        // the sensor keeps its period, a frame missed while the caller was late is not waited for again
+        const auto now = std::chrono::steady_clock::now();
+        next_frame = (next_frame + interval < now) ? now : next_frame + interval;
+        std::this_thread::sleep_until(next_frame);
+    }
+    std::lock_guard<std::mutex> lock(state_mutex);
+    ++frames;
+    ++sensor_counter;
+    *img = &camera;
+    *data = frame.data();
+    return E_OK;
+}
+
+error_t DijSDK_ReleaseImage(DijSDK_Handle) {
+    Call call(false);
+    ++released;
+    return E_OK;
+}
+
+error_t DijSDK_HasParameter(DijSDK_Handle, DijSDK_EParamId) {
+    Call call(true);
+    return E_OK;
+}
+
+error_t DijSDK_GetParameterSpec(DijSDK_Handle, DijSDK_EParamId id, DijSDK_EParamType *t, DijSDK_EParamAccess *a, unsigned *dim, DijSDK_EParamValueType *vt, int *set_values, unsigned *count) {
+    Call call(true);
+    const auto spec = spec_of(id);
+    if (t != nullptr) { *t = spec.type; }
+    if (a != nullptr) { *a = DijSDK_EParamAccessReadWrite; }
+    if (dim != nullptr) { *dim = spec.dimension; }
+    if (vt != nullptr) { *vt = spec.set.empty() ? DijSDK_EParamValueTypeRange : DijSDK_EParamValueTypeDiscreteSet; }
+    if (count != nullptr) {
+        if (set_values != nullptr) {
+            std::copy(spec.set.cbegin(), spec.set.cbegin() + (std::min)(static_cast<std::size_t>(*count), spec.set.size()), set_values);
+        }
+        *count = static_cast<unsigned>(spec.set.size());
+    }
+    return E_OK;
+}
+
+error_t DijSDK_GetIntParameter(DijSDK_Handle, DijSDK_EParamId id, int *v, unsigned n, DijSDK_EParamQuery q) {
+    return get(id, v, n, q);
+}
+
+error_t DijSDK_GetDoubleParameter(DijSDK_Handle, DijSDK_EParamId id, double *v, unsigned n, DijSDK_EParamQuery q) {
+    return get(id, v, n, q);
+}
+
+error_t DijSDK_GetStringParameter(DijSDK_Handle, DijSDK_EParamId, char *v, unsigned n) {
+    Call call(true);
+    std::strncpy(v, "fake camera", n);
+    if (0 < n) {
+        v[n - 1] = '\0';
+    }
+    return E_OK;
+}
+
+error_t DijSDK_SetIntParameterArray(DijSDK_Handle, DijSDK_EParamId id, int *v, unsigned n) {
+    return set(id, v, n);
+}
+
+error_t DijSDK_SetDoubleParameterArray(DijSDK_Handle, DijSDK_EParamId id, double *v, unsigned n) {
+    return set(id, v, n);
+}
+
+error_t DijSDK_SetStringParameter(DijSDK_Handle, DijSDK_EParamId, const char *) {
+    Call call(true);
+    return E_OK;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef PROKYON_FAKE_SDK_H_
+#define PROKYON_FAKE_SDK_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Prokyon {
+    // Control and counters of the fake DijSDK the tests link instead of the real one, see FakeSdk.cpp.
+    // Every parameter exists, most as a double in [0, 100], exposure, gain, roi, format, counter and name as on the camera.
+    // Frames are zero filled and the sensor counter advances by one per DijSDK_GetImage.
+    namespace FakeSdk {
+        struct Counters {
+            std::uint64_t calls; // of every DijSDK function
+            std::uint64_t parameter_calls; // spec, get and set of parameters
+            std::uint64_t frames; // images handed out
+            std::uint64_t released; // images given back
+            std::uint64_t starts; // of the acquisition
+            std::uint64_t aborts; // of the acquisition
+            std::uint64_t overlaps; // calls entered while another one was in the sdk
+            std::uint64_t foreign_calls; // calls made off the SdkThread while it was running
+        };
+
+        Counters get_counters();
+        void reset_counters();
+
+        void set_frame_size(unsigned width, unsigned height); // of every frame, one byte per px
+        void set_call_duration_us(unsigned us); // each call stays in the sdk this long, widens overlaps
+        void set_frame_interval_us(unsigned us); // DijSDK_GetImage waits for the next frame of a sensor at this period, 0 hands out at once
+        void set_failing_parameter(int id); // writes of this DijSDK_EParamId fail, -1 for none
+        void set_roi_alignment(unsigned px); // roi writes have width and height rounded down to multiples, as cameras align
+    }
+}
+
+#endif
\ No newline at end of file
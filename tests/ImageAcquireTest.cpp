@@ -0,0 +1,83 @@
+// Snaps through Image against the fake SDK, see FakeSdk.h.
+// Once update() has built the conversion plan, frames take no parameter call. A frame that cannot be converted
+// still gives its image back and stops the acquisition, the camera is not left holding it.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/ImageAcquireTest.cpp Image.cpp Conversion.cpp RegionOfInterest.cpp Preview.cpp FocusMetric.cpp FramePublisher.cpp Camera.cpp Parameters.cpp SdkThread.cpp BufferPool.cpp FrameMemory.cpp tests/FakeSdk.cpp -lrt -o image_acquire_test
+// Exits with 1 on a parameter call per frame or an image left with the camera.
+
+#include "BufferPool.h"
+#include "Camera.h"
+#include "FakeSdk.h"
+#include "Image.h"
+#include "RegionOfInterest.h"
+
+#include <cstdio>
+
+namespace {
+    using namespace Prokyon;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const char *what) {
+        std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    // every image given back, every start of the acquisition aborted
+    void expect_clean(const char *what, std::uint64_t frames) {
+        const auto counters = FakeSdk::get_counters();
+        std::printf("%-32s %4lu frames, %4lu released, %4lu starts, %4lu aborts, %lu parameter calls\n", what, static_cast<unsigned long>(counters.frames),
+            static_cast<unsigned long>(counters.released), static_cast<unsigned long>(counters.starts), static_cast<unsigned long>(counters.aborts),
+            static_cast<unsigned long>(counters.parameter_calls));
+        expect(counters.frames == frames, "every frame taken");
+        expect(counters.released == counters.frames, "every image released");
+        expect(counters.aborts == counters.starts, "every acquisition aborted");
+    }
+}
+
+int main() {
+    Camera camera;
+    const DijSDK_CameraKey key{};
+    if (camera.initialize(&key, "fake", "fake") != Camera::Status::state_changed) {
+        std::printf("camera not initialized\nFAILED\n");
+        return 1;
+    }
+    {
+        const unsigned frames = 100;
+        FakeSdk::set_frame_size(64, 48);
+        BufferPool pool(FrameBuffer::default_options(), 1 << 24);
+        RegionOfInterest roi(&camera);
+        roi.set({0, 0, 64, 48});
+        Image image(&camera, &pool);
+        image.set_region_of_interest(&roi);
+        expect(image.update(), "update");
+
+        FakeSdk::reset_counters();
+        auto ok = true;
+        for (unsigned f = 0; f < frames; ++f) {
+            ok = image.acquire() && ok;
+        }
+        expect(ok, "every snap succeeded");
+        expect(FakeSdk::get_counters().parameter_calls == 0, "no parameter call after update()");
+        expect_clean("snaps", frames);
+
+        // a crop outside the frame, the plan is rebuilt at the next frame and fails
+        image.set_crops({{100, 100, 10, 10}});
+        FakeSdk::reset_counters();
+        expect(!image.acquire(), "snap fails without a plan");
+        expect_clean("failed snap", 1);
+
+        image.set_crops({});
+        expect(image.update(), "update after the crop is gone");
+        FakeSdk::reset_counters();
+        expect(image.acquire(), "snap after the failure");
+        expect_clean("snap after the failure", 1);
+    }
+    camera.shutdown();
+    FakeSdk::set_frame_size(640, 480);
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+// SDK calls of the property classes, against the fake SDK, see FakeSdk.h.
+// The specification is read once at construction, the range once after each invalidate_range, a set is then one call.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/ParameterCallCountTest.cpp Parameters.cpp SdkThread.cpp tests/FakeSdk.cpp -o parameter_call_count_test
+// Exits with 1 if a count differs.
+
+#include "FakeSdk.h"
+#include "Parameters.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    unsigned failures = 0;
+
+    // sdk calls since the last check
+    void expect_calls(const char *what, std::uint64_t expected) {
+        const auto calls = Prokyon::FakeSdk::get_counters().calls;
+        Prokyon::FakeSdk::reset_counters();
+        std::printf("%-40s %2lu calls, expected %2lu\n", what, static_cast<unsigned long>(calls), static_cast<unsigned long>(expected));
+        if (calls != expected) {
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    using namespace Prokyon;
+    DijSDK_Handle handle = nullptr;
+    DijSDK_OpenCamera("fake", &handle);
+    FakeSdk::reset_counters();
+
+    NumericProperty gain(handle, ParameterIdImageCaptureGain);
+    expect_calls("construct", 2); // HasParameter, GetParameterSpec
+    std::vector<double> v{20.0};
+    gain.clip_double(v);
+    gain.set(v);
+    expect_calls("first clip and set", 3); // min, max, set
+    if (v[0] != 16.0) {
+        std::printf("clipped to %g, expected 16\n", v[0]);
+        ++failures;
+    }
+    for (auto i = 0; i < 3; ++i) {
+        v = {20.0};
+        gain.clip_double(v);
+        gain.set(v);
+        expect_calls("clip and set", 1);
+    }
+    gain.invalidate_range();
+    v = {0.0};
+    gain.clip_double(v);
+    expect_calls("clip after invalidate_range", 2);
+
+    NumericProperty roi(handle, ParameterIdImageCaptureRoi);
+    expect_calls("construct vector", 2);
+    std::vector<int> r{0, 0, 8000, 8000};
+    roi.clip_int(r);
+    roi.clip_int(r);
+    expect_calls("clip vector twice", 2); // the range once for all elements and both clips
+
+    DiscreteSetProperty format(handle, ParameterIdImageProcessingOutputFormat, {{"Grey8", DijSDK_EImageFormatGrey8}, {"Grey16", DijSDK_EImageFormatGrey16}});
+    format.range();
+    FakeSdk::reset_counters();
+    format.set("Grey16");
+    expect_calls("discrete set", 1); // no read of the current value
+    if (format.get() != "Grey16") {
+        std::printf("discrete value %s, expected Grey16\n", format.get().c_str());
+        ++failures;
+    }
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
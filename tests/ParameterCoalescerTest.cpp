@@ -0,0 +1,148 @@
+// Coalesced parameter writes against the fake SDK, see FakeSdk.h.
+// A burst of staged values is written once with the last of them, flush() returns only after the write in flight is done,
+// the maximum rate spaces the writes and a write the camera refuses is reported to on_applied as failed.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones, best with -fsanitize=thread:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/ParameterCoalescerTest.cpp ParameterCoalescer.cpp Camera.cpp Parameters.cpp SdkThread.cpp tests/FakeSdk.cpp -o parameter_coalescer_test
+// Exits with 1 on a write too many, a flush that returns early, writes closer than the rate or a failure not reported.
+
+#include "Camera.h"
+#include "FakeSdk.h"
+#include "ParameterCoalescer.h"
+#include "SdkThread.h"
+
+#include "dijsdk.h"
+#include "dijsdkerror.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+    using Clock = std::chrono::steady_clock;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const char *what) {
+        std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    double elapsed_ms(Clock::time_point t0, Clock::time_point t1) {
+        return std::chrono::duration<double, std::milli>(t1 - t0).count();
+    }
+
+    // what on_applied was told, in order
+    struct Applied {
+        std::mutex mutex;
+        std::vector<bool> results;
+        std::vector<Clock::time_point> times;
+
+        void add(bool success) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(success);
+            times.push_back(Clock::now());
+        }
+
+        std::size_t size() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return results.size();
+        }
+    };
+
+    double gain_of(Camera &camera) {
+        double gain = 0.0;
+        SdkThread::call([&]() { return DijSDK_GetDoubleParameter(camera, ParameterIdImageCaptureGain, &gain, 1, DijSDK_EParamQueryCurrent); });
+        return gain;
+    }
+
+    void wait_written(ParameterCoalescer &coalescer) {
+        while (coalescer.is_pending(ParameterIdImageCaptureGain)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+int main() {
+    Camera camera;
+    const DijSDK_CameraKey key{};
+    if (camera.initialize(&key, "fake", "fake") != Camera::Status::state_changed) {
+        std::printf("camera not initialized\nFAILED\n");
+        return 1;
+    }
+    {
+        Applied applied;
+        ParameterCoalescer coalescer(&camera, [&](DijSDK_EParamId, bool success) { applied.add(success); });
+
+        // the burst falls into the wait for the rate, the flush writes it at once
+        coalescer.stage(ParameterIdImageCaptureGain, {1.0});
+        coalescer.flush();
+        coalescer.set_max_rate_hz(2.0);
+        FakeSdk::reset_counters();
+        const unsigned burst = 200;
+        for (unsigned i = 0; i < burst; ++i) {
+            coalescer.stage(ParameterIdImageCaptureGain, {1.0 + (i % 15)});
+        }
+        const double last = 1.0 + ((burst - 1) % 15);
+        coalescer.flush();
+        const auto burst_calls = FakeSdk::get_counters().parameter_calls;
+        std::printf("burst of %u: %lu parameter calls, gain %g\n", burst, static_cast<unsigned long>(burst_calls), gain_of(camera));
+        expect(burst_calls == 1, "one write for the burst");
+        expect(gain_of(camera) == last, "the last value written");
+        expect(coalescer.get_written_count() == 2, "written count");
+
+        // the write is in the sdk when flush is called
+        coalescer.set_max_rate_hz(0.0);
+        FakeSdk::set_call_duration_us(100000);
+        const auto before = applied.size();
+        coalescer.stage(ParameterIdImageCaptureGain, {3.0});
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const auto t0 = Clock::now();
+        coalescer.flush();
+        const auto flush_ms = elapsed_ms(t0, Clock::now());
+        FakeSdk::set_call_duration_us(0);
+        std::printf("flush during a write of 100 ms: %.1f ms\n", flush_ms);
+        expect(50.0 < flush_ms, "flush waited for the write in flight");
+        expect(applied.size() == before + 1 && !coalescer.is_pending(ParameterIdImageCaptureGain), "the write done and reported by then");
+        expect(gain_of(camera) == 3.0, "its value written");
+
+        // each value staged once the one before is written, the rate spaces them
+        const double hz = 20.0;
+        coalescer.set_max_rate_hz(hz);
+        const auto first = applied.size();
+        for (unsigned i = 0; i < 6; ++i) {
+            coalescer.stage(ParameterIdImageCaptureGain, {2.0 + i});
+            wait_written(coalescer);
+        }
+        auto closest_ms = 1e9;
+        {
+            std::lock_guard<std::mutex> lock(applied.mutex);
+            for (auto i = first + 1; i < applied.times.size(); ++i) {
+                closest_ms = (std::min)(closest_ms, elapsed_ms(applied.times[i - 1], applied.times[i]));
+            }
+        }
+        std::printf("at %g Hz: writes at least %.1f ms apart\n", hz, closest_ms);
+        expect(0.9 * 1000.0 / hz < closest_ms, "writes spaced by the maximum rate");
+
+        // the camera refuses the write
+        coalescer.set_max_rate_hz(0.0);
+        FakeSdk::set_failing_parameter(ParameterIdImageCaptureGain);
+        coalescer.stage(ParameterIdImageCaptureGain, {4.0});
+        coalescer.flush();
+        FakeSdk::set_failing_parameter(-1);
+        {
+            std::lock_guard<std::mutex> lock(applied.mutex);
+            expect(!applied.results.empty() && !applied.results.back(), "on_applied told of the failed write");
+        }
+        expect(gain_of(camera) != 4.0, "the refused value not taken");
+    }
+    camera.shutdown();
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+// Order and failure handling of a running Pipeline with several workers.
+// Frames take uneven time in a parallel stage, so workers finish them out of order, a second stage throws on chosen frames.
+// The ordered stage after them must see the frames that did not fail one at a time in sequence order,
+// the delivery must get them in sequence order with their own data, and the counts must add up. Best with -fsanitize=thread:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/PipelineTest.cpp Pipeline.cpp BufferPool.cpp FrameMemory.cpp Scheduling.cpp -o pipeline_test
+// Exits with 1 on a frame out of order, a frame with foreign data or a count that differs.
+
+#include "BufferPool.h"
+#include "Pipeline.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const char *what) {
+        std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    bool fails(std::uint64_t sequence) {
+        return sequence % 7 == 3;
+    }
+
+    std::uint64_t read_sequence(const unsigned char *p_data) {
+        std::uint64_t sequence = 0;
+        std::memcpy(&sequence, p_data, sizeof(sequence));
+        return sequence;
+    }
+
+    // writes the sequence into the frame, then takes 0 to 400 us depending on it
+    class Uneven : public Stage {
+    public:
+        std::string get_name() const { return "uneven"; }
+        FrameLayout get_output_layout(const FrameLayout &input) const { return input; }
+        bool is_in_place() const { return true; }
+        void process(const Frame &input, Frame &output) {
+            std::memcpy(output.p_data, &input.sequence, sizeof(input.sequence));
+            std::this_thread::sleep_for(std::chrono::microseconds((input.sequence * 7919u) % 5u * 100u));
+        }
+    };
+
+    class Failing : public Stage {
+    public:
+        std::string get_name() const { return "failing"; }
+        FrameLayout get_output_layout(const FrameLayout &input) const { return input; }
+        bool is_in_place() const { return true; }
+        void process(const Frame &input, Frame &) {
+            if (fails(input.sequence)) { throw PipelineException(); }
+        }
+    };
+
+    // keeps the sequences it sees, no lock, the pipeline lets one frame in at a time
+    class Recording : public Stage {
+    public:
+        std::string get_name() const { return "recording"; }
+        FrameLayout get_output_layout(const FrameLayout &input) const { return input; }
+        bool is_in_place() const { return true; }
+        bool is_ordered() const { return true; }
+        void process(const Frame &input, Frame &) {
+            if (read_sequence(input.p_data) != input.sequence) { ++foreign; }
+            sequences.push_back(input.sequence);
+        }
+
+        std::vector<std::uint64_t> sequences;
+        unsigned foreign = 0;
+    };
+
+    void run(Pipeline &pipeline, Recording &recording, std::uint64_t count) {
+        const FrameLayout layout{32, 32, 1, 8, 1, 0};
+        recording.sequences.clear();
+        recording.foreign = 0;
+        std::vector<std::uint64_t> delivered;
+        unsigned foreign = 0;
+        pipeline.start(layout, 4, 8, [&](const Frame &frame) {
+            if (read_sequence(frame.p_data) != frame.sequence) { ++foreign; }
+            delivered.push_back(frame.sequence);
+        });
+        // a busy begin_frame counts as dropped and is tried again, the sequence only advances on submit
+        for (std::uint64_t submitted = 0; submitted < count;) {
+            if (pipeline.begin_frame() == nullptr) {
+                std::this_thread::yield();
+                continue;
+            }
+            pipeline.submit_frame(FrameStamp{-1, 0});
+            ++submitted;
+        }
+        pipeline.stop();
+
+        std::vector<std::uint64_t> expected;
+        for (std::uint64_t sequence = 1; sequence <= count; ++sequence) {
+            if (!fails(sequence)) { expected.push_back(sequence); }
+        }
+        const auto failed = count - expected.size();
+        std::printf("%lu frames: %lu delivered, %lu failed\n", static_cast<unsigned long>(count), static_cast<unsigned long>(pipeline.get_delivered_count()),
+            static_cast<unsigned long>(pipeline.get_failed_count()));
+        expect(recording.sequences == expected, "ordered stage saw the frames that did not fail, in order");
+        expect(recording.foreign == 0, "ordered stage saw each frame with its own data");
+        expect(delivered == expected, "delivered the frames that did not fail, in order");
+        expect(foreign == 0, "delivered each frame with its own data");
+        expect(pipeline.get_delivered_count() == expected.size(), "delivered count");
+        expect(pipeline.get_failed_count() == failed, "failed count");
+    }
+}
+
+int main() {
+    BufferPool pool(FrameBuffer::default_options(), 1 << 24);
+    Pipeline pipeline(&pool);
+    auto recording = std::make_shared<Recording>();
+    pipeline.set_stages({std::make_shared<Uneven>(), std::make_shared<Failing>(), recording});
+
+    run(pipeline, *recording, 1000);
+    // counts and sequences start over
+    run(pipeline, *recording, 300);
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
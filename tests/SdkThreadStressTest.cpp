@@ -0,0 +1,229 @@
+// Concurrency of the SdkThread, alone and under a running Capture, against the fake SDK, see FakeSdk.h.
+// Many threads call, post and nest commands while frames are taken, no two calls may be in the sdk at once
+// and none may come from another thread than the SdkThread. A capture policy must not stay on the SdkThread.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones, best with -fsanitize=thread:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/SdkThreadStressTest.cpp SdkThread.cpp Camera.cpp Capture.cpp Pipeline.cpp BufferPool.cpp FrameMemory.cpp Scheduling.cpp tests/FakeSdk.cpp -o sdk_thread_stress_test
+// Exits with 1 on an overlap, a foreign call, a lost result or a policy left behind.
+
+#include "BufferPool.h"
+#include "Camera.h"
+#include "Capture.h"
+#include "FakeSdk.h"
+#include "Pipeline.h"
+#include "Scheduling.h"
+#include "SdkThread.h"
+
+#include "dijsdk.h"
+#include "dijsdkerror.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("failed: %s\n", what);
+            ++failures;
+        }
+    }
+
+    void expect_exclusive(const char *what) {
+        const auto counters = FakeSdk::get_counters();
+        std::printf("%-12s %8lu calls, %6lu frames, %lu overlaps, %lu foreign\n", what, static_cast<unsigned long>(counters.calls), static_cast<unsigned long>(counters.frames),
+            static_cast<unsigned long>(counters.overlaps), static_cast<unsigned long>(counters.foreign_calls));
+        expect(counters.overlaps == 0, "no call entered while another one was in the sdk");
+        expect(counters.foreign_calls == 0, "every call on the sdk thread");
+        FakeSdk::reset_counters();
+    }
+
+    // a parameter round trip, the result depends on i so a lost or swapped result shows
+    int round_trip(DijSDK_Handle handle, int i) {
+        int value = 0;
+        DijSDK_GetIntParameter(handle, ParameterIdImageCaptureExposureTimeUsec, &value, 1, DijSDK_EParamQueryCurrent);
+        return i + 1;
+    }
+
+    void commands(DijSDK_Handle handle, unsigned rounds) {
+        FakeSdk::reset_counters();
+        for (unsigned round = 0; round < rounds; ++round) {
+            SdkThread::start();
+            std::atomic<long> sum{0};
+            std::atomic<long> errors{0};
+            std::atomic<bool> done{false};
+            std::vector<std::thread> threads;
+            for (auto t = 0; t < 6; ++t) {
+                threads.emplace_back([&]() {
+                    for (auto i = 0; i < 2000; ++i) {
+                        if (i % 100 == 7) {
+                            try {
+                                SdkThread::call([&]() -> int { round_trip(handle, i); throw std::runtime_error("from the sdk thread"); });
+                            }
+                            catch (std::runtime_error) {
+                                ++errors;
+                            }
+                        }
+                        else if (i % 50 == 3) {
+                            sum += SdkThread::post([&, i]() { return round_trip(handle, i); }).get();
+                        }
+                        else {
+                            // a command calling again runs directly
+                            sum += SdkThread::call([&]() { return SdkThread::call([&]() { return round_trip(handle, i); }); });
+                        }
+                    }
+                });
+            }
+            threads.emplace_back([&]() {
+                for (auto i = 0; i < 3000; ++i) {
+                    sum += SdkThread::call_frame([&]() {
+                        DijSDK_Handle image = nullptr;
+                        void *p_data = nullptr;
+                        DijSDK_GetImage(handle, &image, &p_data);
+                        DijSDK_ReleaseImage(image);
+                        return i + 1;
+                    });
+                }
+            });
+            // only asks, while the thread starts and stops
+            threads.emplace_back([&]() {
+                while (!done) {
+                    if (SdkThread::is_owner()) {
+                        ++errors;
+                    }
+                }
+            });
+            for (std::size_t t = 0; t + 1 < threads.size(); ++t) {
+                threads[t].join();
+            }
+            std::vector<std::future<int>> queued;
+            for (auto i = 0; i < 100; ++i) {
+                queued.push_back(SdkThread::post([&, i]() { return round_trip(handle, i); }));
+            }
+            SdkThread::stop();
+            done = true;
+            threads.back().join();
+
+            for (auto &f : queued) {
+                expect(f.wait_for(std::chrono::seconds(0)) == std::future_status::ready, "posted commands run before stop returns");
+            }
+            long expected = 0;
+            for (auto t = 0; t < 6; ++t) {
+                for (auto i = 0; i < 2000; ++i) {
+                    if (i % 100 != 7) {
+                        expected += i + 1;
+                    }
+                }
+            }
+            for (auto i = 0; i < 3000; ++i) {
+                expected += i + 1;
+            }
+            expect(sum == expected, "every result reaches its caller");
+            expect(errors == 6 * 20, "every exception reaches its caller");
+        }
+        expect_exclusive("commands");
+    }
+
+    class Copy : public Stage {
+    public:
+        std::string get_name() const { return "copy"; }
+        FrameLayout get_output_layout(const FrameLayout &input) const { return input; }
+        void process(const Frame &input, Frame &output) { std::memcpy(output.p_data, input.p_data, input.layout.bytes()); }
+    };
+
+    // one the sdk thread is not under already, so a policy left behind shows
+    ThreadPolicy make_policy() {
+        ThreadPolicy raised{{}, ThreadPriority::raised};
+        auto permitted = false;
+        std::thread probe([&]() { permitted = Scheduling::apply(raised); });
+        probe.join();
+        if (permitted) { return raised; }
+        ThreadPolicy pinned{{Scheduling::get_core_count() - 1}, ThreadPriority::normal};
+        return (1 < Scheduling::get_core_count()) ? pinned : ThreadPolicy{{}, ThreadPriority::normal};
+    }
+
+    void capture(Camera &camera, const ThreadPolicy &policy) {
+        FakeSdk::set_frame_size(64, 64);
+        FakeSdk::set_call_duration_us(100);
+        FakeSdk::reset_counters();
+        const FrameLayout layout{64, 64, 1, 8, 1, 0};
+
+        ThreadState before{};
+        expect(SdkThread::call([&]() { return Scheduling::save(before); }), "the sdk thread's state is known");
+
+        BufferPool pool(FrameBuffer::default_options(), 1 << 26);
+        Pipeline pipeline(&pool);
+        pipeline.set_stages({std::make_shared<Copy>()});
+        std::atomic<std::uint64_t> delivered{0};
+        auto start_pipeline = [&]() {
+            pipeline.start(layout, 2, 4, [&](const Frame &) { ++delivered; });
+        };
+        start_pipeline();
+
+        // parameter traffic from the core's side while frames are taken
+        std::atomic<bool> done{false};
+        std::vector<std::thread> pokers;
+        for (auto t = 0; t < 3; ++t) {
+            pokers.emplace_back([&]() {
+                for (auto i = 0; !done; ++i) {
+                    double gain = 1.0 + i % 8;
+                    SdkThread::call([&]() { return DijSDK_SetDoubleParameterArray(camera, ParameterIdImageCaptureGain, &gain, 1); });
+                    SdkThread::call([&]() { return DijSDK_GetDoubleParameter(camera, ParameterIdImageCaptureGain, &gain, 1, DijSDK_EParamQueryCurrent); });
+                }
+            });
+        }
+
+        Capture capture(&camera, &pipeline);
+        capture.set_policy(policy);
+        capture.start(layout.bytes(), 0, [&](bool) { pipeline.stop(); });
+        for (auto i = 0; i < 20; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            expect(capture.pause(), "pause of a running capture");
+            pipeline.stop();
+            start_pipeline();
+            capture.resume(layout.bytes());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        capture.stop();
+        done = true;
+        for (auto &t : pokers) {
+            t.join();
+        }
+        FakeSdk::set_call_duration_us(0);
+
+        expect(capture.is_policy_applied(), "the capture policy applied");
+        if (policy.priority == ThreadPriority::normal && policy.cores.empty()) {
+            std::printf("neither rights for a raised priority nor more than one core, the restore is not observable\n");
+        }
+        expect(0 < delivered, "frames delivered");
+        ThreadState after{};
+        expect(SdkThread::call([&]() { return Scheduling::save(after); }), "the sdk thread's state is known");
+        expect(after.cores == before.cores && after.scheduler == before.scheduler && after.priority == before.priority, "the sdk thread's policy restored after the capture");
+        expect_exclusive("capture");
+    }
+}
+
+int main() {
+    DijSDK_Handle handle = nullptr;
+    DijSDK_OpenCamera("fake", &handle);
+    commands(handle, 10);
+
+    Camera camera;
+    const DijSDK_CameraKey key{};
+    expect(camera.initialize(&key, "fake", "fake") == Camera::Status::state_changed, "camera initialized");
+    capture(camera, make_policy());
+    camera.shutdown();
+    expect(!SdkThread::is_running(), "the sdk thread stopped with the camera");
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
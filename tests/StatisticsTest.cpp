@@ -0,0 +1,111 @@
+// Per pixel statistics (Welford) and the photon transfer fit on synthetic frames with known mean and variance.
+// Each pixel alternates between mean + d and mean - d over an even number of frames, its unbiased variance is d^2 * n / (n - 1).
+// The frame size leaves a tail past the SSE2 blocks, so both paths of PixelStatistics are checked.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/StatisticsTest.cpp Statistics.cpp SensorCharacterization.cpp AcquisitionParameters.cpp ParameterRegistry.cpp Image.cpp Conversion.cpp RegionOfInterest.cpp Preview.cpp FocusMetric.cpp FramePublisher.cpp Camera.cpp Parameters.cpp SdkThread.cpp BufferPool.cpp FrameMemory.cpp tests/FakeSdk.cpp -lrt -o statistics_test
+// Exits with 1 if a statistic or a fitted value is off.
+
+#include "SensorCharacterization.h"
+#include "Statistics.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+
+    unsigned failures = 0;
+
+    void expect_near(const char *what, double value, double expected, double tolerance) {
+        const auto ok = std::fabs(value - expected) <= tolerance;
+        std::printf("%-40s %12.6f, expected %12.6f %s\n", what, value, expected, ok ? "ok" : "FAILED");
+        if (!ok) {
+            ++failures;
+        }
+    }
+
+    const std::size_t M_S_PX = 16 * 16 + 5;
+    const unsigned M_S_FRAMES = 16;
+
+    // fixed pattern of 0..3 across pixels, frame f adds +d or -d
+    template<typename T>
+    void add_frames(PixelStatistics &statistics, unsigned mean, unsigned d) {
+        std::vector<T> frame(M_S_PX);
+        for (unsigned f = 0; f < M_S_FRAMES; ++f) {
+            for (std::size_t p = 0; p < frame.size(); ++p) {
+                frame[p] = static_cast<T>(mean + p % 4 + ((f % 2 == 0) ? d : -static_cast<int>(d)));
+            }
+            statistics.add(reinterpret_cast<const unsigned char *>(frame.data()), 8 * sizeof(T));
+        }
+    }
+
+    // spatial variance of the fixed pattern 0..3, unbiased
+    double fixed_pattern_variance() {
+        double sum = 0.0, sum_sq = 0.0;
+        for (std::size_t p = 0; p < M_S_PX; ++p) {
+            sum += p % 4;
+        }
+        const auto mean = sum / M_S_PX;
+        for (std::size_t p = 0; p < M_S_PX; ++p) {
+            sum_sq += (p % 4 - mean) * (p % 4 - mean);
+        }
+        return sum_sq / (M_S_PX - 1);
+    }
+
+    double pattern_mean() {
+        double sum = 0.0;
+        for (std::size_t p = 0; p < M_S_PX; ++p) {
+            sum += p % 4;
+        }
+        return sum / M_S_PX;
+    }
+}
+
+int main() {
+    const auto bias = static_cast<double>(M_S_FRAMES) / (M_S_FRAMES - 1);
+
+    PixelStatistics statistics;
+    statistics.reset(M_S_PX);
+    add_frames<unsigned char>(statistics, 100, 0);
+    expect_near("8 bit constant, mean", statistics.mean_of_means(), 100.0 + pattern_mean(), 1e-4);
+    expect_near("8 bit constant, temporal variance", statistics.mean_of_variances(), 0.0, 1e-6);
+    expect_near("8 bit constant, fixed pattern", statistics.variance_of_means(), fixed_pattern_variance(), 1e-4);
+
+    statistics.reset(M_S_PX);
+    add_frames<unsigned char>(statistics, 100, 3);
+    expect_near("8 bit d = 3, mean", statistics.mean_of_means(), 100.0 + pattern_mean(), 1e-4);
+    expect_near("8 bit d = 3, temporal variance", statistics.mean_of_variances(), 9.0 * bias, 1e-4);
+    expect_near("8 bit d = 3, fixed pattern", statistics.variance_of_means(), fixed_pattern_variance(), 1e-4);
+
+    statistics.reset(M_S_PX);
+    add_frames<unsigned short>(statistics, 30000, 40);
+    expect_near("16 bit d = 40, mean", statistics.mean_of_means(), 30000.0 + pattern_mean(), 1e-2);
+    expect_near("16 bit d = 40, temporal variance", statistics.mean_of_variances(), 1600.0 * bias, 1e-1);
+    expect_near("frames counted", static_cast<double>(statistics.get_frame_count()), M_S_FRAMES, 0.0);
+
+    // photon transfer: variance = read_noise^2 + gain * signal, signal = 10 (d^2 - 4) makes the gain bias / 10
+    // and the read noise 2 * sqrt(bias), the last step saturates and is not fitted
+    const unsigned offset = 1000;
+    const unsigned ds[] = {2, 4, 6, 8, 10, 12};
+    std::vector<SensorCharacterization::Step> steps;
+    for (auto d : ds) {
+        const auto signal = 10 * (d * d - 4);
+        statistics.reset(M_S_PX);
+        add_frames<unsigned short>(statistics, offset + signal, d);
+        steps.push_back({1.0, 1.0 + signal, M_S_FRAMES, statistics.mean_of_means(), statistics.mean_of_variances(), statistics.variance_of_means()});
+    }
+    statistics.reset(M_S_PX);
+    add_frames<unsigned short>(statistics, 62000, 100);
+    steps.push_back({1.0, 62000.0, M_S_FRAMES, statistics.mean_of_means(), statistics.mean_of_variances(), statistics.variance_of_means()});
+
+    const auto result = SensorCharacterization::fit(steps, 65535);
+    expect_near("conversion gain ADU/e-", result.conversion_gain_adu_per_e, bias / 10.0, 1e-4);
+    expect_near("read noise ADU", result.read_noise_adu, 2.0 * std::sqrt(bias), 1e-3);
+    expect_near("read noise e-", result.read_noise_e, 20.0 / std::sqrt(bias), 1e-1);
+    expect_near("linearity r2", result.linearity_r2, 1.0, 1e-6);
+    expect_near("points fitted", result.points_fitted, 6.0, 0.0);
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+// Sub regions against the fake SDK, see FakeSdk.h: both the hardware roi and the crops of the Image change, or neither.
+// Regions of different sizes are turned down before the roi is written. If the camera aligns the roi past a region,
+// the previous roi is written back and update() sizes frames by the roi the camera has.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/SubRegionsTest.cpp Image.cpp Conversion.cpp RegionOfInterest.cpp Preview.cpp FocusMetric.cpp FramePublisher.cpp Camera.cpp Parameters.cpp SdkThread.cpp BufferPool.cpp FrameMemory.cpp tests/FakeSdk.cpp -lrt -o sub_regions_test
+// Exits with 1 if a roi or crop is left half changed.
+
+#include "BufferPool.h"
+#include "Camera.h"
+#include "FakeSdk.h"
+#include "Image.h"
+#include "RegionOfInterest.h"
+#include "SdkThread.h"
+
+#include "dijsdk.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const char *what) {
+        std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    // the roi the camera holds, read past the cache of RegionOfInterest
+    ROI camera_roi(Camera &camera) {
+        int value[4] = {0, 0, 0, 0};
+        SdkThread::call([&]() { DijSDK_GetIntParameter(camera, ParameterIdImageCaptureRoi, value, 4, DijSDK_EParamQueryCurrent); });
+        return ROI{static_cast<unsigned>(value[0]), static_cast<unsigned>(value[1]), static_cast<unsigned>(value[2]), static_cast<unsigned>(value[3])};
+    }
+}
+
+int main() {
+    SdkThread::start();
+    DijSDK_CameraKey key = "fake";
+    Camera camera;
+    if (camera.initialize(&key, "fake", "fake") != Camera::Status::state_changed) {
+        std::printf("camera not initialized\nFAILED\n");
+        return 1;
+    }
+    // as cameras do, widths and heights come in steps
+    FakeSdk::set_roi_alignment(10);
+    {
+        BufferPool pool(FrameBuffer::default_options(), 1 << 26);
+        RegionOfInterest roi(&camera);
+        Image image(&camera, &pool);
+        image.set_region_of_interest(&roi);
+        expect(image.update(), "update with the full roi");
+        const auto full = roi.get();
+
+        // mismatched sizes, nothing reaches the camera
+        const std::vector<ROI> mismatched{{10, 10, 20, 20}, {100, 100, 30, 20}};
+        expect(!Image::check_crops(mismatched), "check_crops turns down different sizes");
+        expect(!Image::check_crops({{10, 10, 0, 20}}), "check_crops turns down an empty region");
+        FakeSdk::reset_counters();
+        auto thrown = false;
+        try { image.set_sub_regions(roi, mismatched); }
+        catch (ImageException) { thrown = true; }
+        expect(thrown, "set_sub_regions throws ImageException on different sizes");
+        expect(FakeSdk::get_counters().calls == 0, "no sdk call for different sizes");
+        expect(roi.get() == full && camera_roi(camera) == full, "roi unchanged after different sizes");
+        expect(image.get_crops().empty(), "crops unchanged after different sizes");
+
+        // same sizes, roi to the bounding box, crops relative to it
+        const std::vector<ROI> regions{{10, 10, 20, 20}, {50, 60, 20, 20}};
+        image.set_sub_regions(roi, regions);
+        expect(roi.get() == (ROI{10, 10, 60, 70}), "roi is the bounding box");
+        expect(image.get_crops() == (std::vector<ROI>{{0, 0, 20, 20}, {40, 50, 20, 20}}), "crops relative to the roi");
+        expect(image.update() && image.get_number_of_channels() == 2 && image.get_image_width() == 20, "update sizes channels by the crops");
+        const auto bounding = roi.get();
+        const auto crops = image.get_crops();
+
+        // the camera aligns the roi so a region falls out, the roi is written back
+        thrown = false;
+        try { image.set_sub_regions(roi, {{100, 100, 25, 25}, {150, 100, 25, 25}}); }
+        catch (RegionOfInterestException) { thrown = true; }
+        expect(thrown, "set_sub_regions throws when alignment drops a region");
+        expect(roi.get() == bounding && camera_roi(camera) == bounding, "previous roi written back");
+        expect(image.get_crops() == crops, "crops unchanged after the failed roi");
+        expect(image.update() && image.get_conversion_plan().raw.width == bounding[W_ind], "raw size follows the roi of the camera");
+
+        // mismatched crops alone
+        thrown = false;
+        try { image.set_crops(mismatched); }
+        catch (ImageException) { thrown = true; }
+        expect(thrown && image.get_crops() == crops, "set_crops keeps the crops on different sizes");
+    }
+    FakeSdk::set_roi_alignment(1);
+    camera.shutdown();
+    SdkThread::stop();
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
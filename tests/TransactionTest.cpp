@@ -0,0 +1,168 @@
+// Staging, checking and ordering of a Transaction against the fake SDK, see FakeSdk.h, with the device hooks of a small fake.
+// Values out of the cached ranges are turned down when staged, a staged image mode leaves the ranges to the commit,
+// the commit applies by rank and tags the first frame after it only if nothing failed, ClearROI stages an empty roi.
+// Build from the repository root, with the headers of the fake SDK ahead of the real ones:
+//     g++ -std=c++14 -pthread -Itests/sdk -Itests -I. tests/TransactionTest.cpp Transaction.cpp RegionOfInterest.cpp Camera.cpp Parameters.cpp SdkThread.cpp tests/FakeSdk.cpp -o transaction_test
+// Exits with 1 on a value staged that is out of range, one turned down that is not, a wrong order or wrong frame tags.
+
+#include "Camera.h"
+#include "FakeSdk.h"
+#include "Parameters.h"
+#include "RegionOfInterest.h"
+#include "Transaction.h"
+
+#include "dijsdk.h"
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    using namespace Prokyon;
+    using Check = Transaction::Check;
+
+    unsigned failures = 0;
+
+    void expect(bool condition, const std::string &what) {
+        std::printf("%-60s %s\n", what.c_str(), condition ? "ok" : "FAILED");
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    void expect_stage(Transaction &transaction, const std::string &key, const std::string &value, Check expected) {
+        expect(transaction.stage(key, value) == expected, "stage " + key + " \"" + value + "\"");
+    }
+
+    const std::string M_S_ROI{"ROI"};
+    const std::string M_S_EXPOSURE{"Exposure"};
+    const std::string M_S_MODE{"Image Mode"};
+    const std::string M_S_BINNING{"Binning"};
+    const std::string M_S_FORMAT{"Output Format"};
+    const std::string M_S_REGIONS{"Sub Regions"};
+    const std::string M_S_GAIN{"Gain"};
+    const std::string M_S_TEMPERATURE{"Temperature"}; // read only
+
+    int rank(const std::string &key) {
+        if (key == M_S_MODE || key == M_S_BINNING) { return 0; }
+        if (key == M_S_FORMAT) { return 1; }
+        if (key == M_S_REGIONS) { return 2; }
+        if (key == M_S_ROI) { return 3; }
+        if (key == M_S_EXPOSURE) { return 4; }
+        return 5;
+    }
+}
+
+int main() {
+    Camera camera;
+    const DijSDK_CameraKey key{};
+    if (camera.initialize(&key, "fake", "fake") != Camera::Status::state_changed) {
+        std::printf("camera not initialized\nFAILED\n");
+        return 1;
+    }
+    {
+        RegionOfInterest roi(&camera); // 4096 x 4096
+        NumericProperty exposure(camera, ParameterIdImageCaptureExposureTimeUsec); // 10 us to 10 s
+        NumericProperty gain(camera, ParameterIdImageCaptureGain); // 1 to 16
+
+        Transaction::Values applied;
+        std::string failing;
+        Transaction::Hooks hooks;
+        hooks.check_settable = [](const std::string &key) {
+            if (key == M_S_TEMPERATURE) { return Check::read_only; }
+            const std::set<std::string> known{M_S_MODE, M_S_BINNING, M_S_FORMAT, M_S_REGIONS, M_S_GAIN};
+            return (known.count(key) != 0) ? Check::ok : Check::invalid_key;
+        };
+        hooks.find_numeric = [&gain](const std::string &key) -> const NumericProperty * { return (key == M_S_GAIN) ? &gain : nullptr; };
+        hooks.check_other = [](const std::string &key, const std::string &value) {
+            if (key != M_S_FORMAT) { return Check::ok; }
+            return (value == "Grey8" || value == "Grey16") ? Check::ok : Check::invalid_value;
+        };
+        hooks.rank = rank;
+        hooks.apply = [&](const std::string &key, const std::string &value) {
+            applied.emplace_back(key, value);
+            return key != failing;
+        };
+        Transaction transaction(Transaction::Keys{M_S_ROI, M_S_EXPOSURE, M_S_REGIONS, {M_S_MODE, M_S_BINNING}}, hooks, &roi, &exposure);
+
+        // staging
+        expect(transaction.stage(M_S_GAIN, "2") == Check::error && !transaction.is_open(), "nothing staged while closed");
+        transaction.begin();
+        expect(transaction.is_open(), "open after begin");
+        expect_stage(transaction, M_S_GAIN, "2", Check::ok);
+        expect_stage(transaction, M_S_GAIN, "3", Check::ok);
+        expect(transaction.get_staged_count() == 1, "the last value staged for a key wins");
+
+        // range rejection, from the ranges read once and cached
+        exposure.allowed_int(10);
+        FakeSdk::reset_counters();
+        expect_stage(transaction, M_S_GAIN, "20", Check::invalid_value);
+        expect_stage(transaction, M_S_GAIN, "two", Check::invalid_value);
+        expect_stage(transaction, M_S_GAIN, "2 | 3", Check::invalid_value);
+        expect_stage(transaction, M_S_EXPOSURE, "0.001", Check::invalid_value);
+        expect_stage(transaction, M_S_EXPOSURE, "-1", Check::invalid_value);
+        expect_stage(transaction, M_S_ROI, "0, 0, 5000, 10", Check::invalid_value);
+        expect_stage(transaction, M_S_ROI, "0, 0, 10, 10; 20, 20, 10, 10", Check::invalid_value);
+        expect_stage(transaction, M_S_FORMAT, "RGB888", Check::invalid_value);
+        expect_stage(transaction, M_S_TEMPERATURE, "20", Check::read_only);
+        expect_stage(transaction, "Firmware Option", "1", Check::invalid_key);
+        expect(FakeSdk::get_counters().parameter_calls == 0, "checks served from the cached ranges");
+        expect(transaction.get_staged_count() == 1, "nothing out of range staged");
+
+        // rank ordering, with the ranges left to the commit once the image mode is staged
+        expect_stage(transaction, M_S_EXPOSURE, "5", Check::ok);
+        expect_stage(transaction, M_S_FORMAT, "Grey16", Check::ok);
+        expect_stage(transaction, M_S_MODE, "Binning 2", Check::ok);
+        expect_stage(transaction, M_S_ROI, "0, 0, 5000, 10", Check::ok);
+        const Transaction::Values order{{M_S_MODE, "Binning 2"}, {M_S_FORMAT, "Grey16"}, {M_S_ROI, "0, 0, 5000, 10"}, {M_S_EXPOSURE, "5"}, {M_S_GAIN, "3"}};
+        expect(transaction.get_ordered() == order, "ordered by rank");
+
+        // commit, the first frame after it is tagged once
+        expect(transaction.commit() == 0 && !transaction.is_open(), "commit closes, none failed");
+        expect(applied == order, "applied by rank");
+        expect(transaction.get_number() == 1 && transaction.get_failed_count() == 0, "commit counted, failed count 0");
+        expect(transaction.take_first_frame(), "first frame after the commit tagged");
+        expect(!transaction.take_first_frame(), "the next frame not tagged");
+
+        // a failed value, no frame has all values, none is tagged first
+        applied.clear();
+        failing = M_S_GAIN;
+        transaction.begin();
+        expect_stage(transaction, M_S_GAIN, "4", Check::ok);
+        expect_stage(transaction, M_S_EXPOSURE, "10", Check::ok);
+        expect(transaction.commit() == 1, "commit reports the failed value");
+        failing.clear();
+        expect(applied.size() == 2, "the other values still applied");
+        expect(transaction.get_number() == 2 && transaction.get_failed_count() == 1, "failed count of the last commit");
+        expect(!transaction.take_first_frame(), "no frame tagged first after a failure");
+
+        // ClearROI stages an empty roi, the full frame of the mode the commit leaves
+        applied.clear();
+        transaction.begin();
+        expect_stage(transaction, M_S_ROI, "", Check::ok);
+        expect(transaction.get_ordered() == (Transaction::Values{{M_S_ROI, ""}}), "an empty roi staged");
+        // sub regions set the roi themselves, an empty list leaves it
+        expect_stage(transaction, M_S_REGIONS, "", Check::ok);
+        expect(transaction.get_ordered().size() == 2, "the roi kept with empty sub regions");
+        expect_stage(transaction, M_S_REGIONS, "10, 10, 20, 20; 50, 50, 20, 20", Check::ok);
+        expect(transaction.get_ordered() == (Transaction::Values{{M_S_REGIONS, "10, 10, 20, 20; 50, 50, 20, 20"}}), "the roi left out with sub regions");
+        transaction.commit();
+        expect(applied == (Transaction::Values{{M_S_REGIONS, "10, 10, 20, 20; 50, 50, 20, 20"}}), "only the sub regions applied");
+        expect(transaction.take_first_frame(), "first frame after the commit tagged");
+
+        // discard
+        applied.clear();
+        transaction.begin();
+        expect_stage(transaction, M_S_GAIN, "5", Check::ok);
+        transaction.discard();
+        expect(!transaction.is_open() && transaction.get_staged_count() == 0 && applied.empty(), "discard applies nothing");
+        expect(transaction.get_number() == 3, "discard is not counted");
+        expect(transaction.begin() == 0, "nothing left over to discard");
+    }
+    camera.shutdown();
+
+    std::printf("%s\n", (failures == 0) ? "passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
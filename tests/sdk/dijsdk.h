@@ -0,0 +1,32 @@
+// Stand-in for the DijSDK header, declares only what the adapter calls, so the tests build without the SDK.
+// Implemented by FakeSdk.cpp.
+#pragma once
+#include "parameterif.h"
+#include "dijsdkerror.h"
+typedef void *DijSDK_Handle;
+typedef char DijSDK_CamGuid[64];
+typedef char DijSDK_CameraKey[33];
+typedef int error_t;
+typedef enum { DijSDK_EParamQueryCurrent, DijSDK_EParamQueryMin, DijSDK_EParamQueryMax, DijSDK_EParamQueryDefault } DijSDK_EParamQuery;
+typedef enum { DijSDK_EParamTypeNotSpecified, DijSDK_EParamTypeBool, DijSDK_EParamTypeInteger, DijSDK_EParamTypeDouble, DijSDK_EParamTypeString } DijSDK_EParamType;
+typedef enum { DijSDK_EParamAccessNotSpecified, DijSDK_EParamAccessReadOnly, DijSDK_EParamAccessWriteOnly, DijSDK_EParamAccessReadWrite } DijSDK_EParamAccess;
+typedef enum { DijSDK_EParamValueTypeNotSpecified, DijSDK_EParamValueTypeRange, DijSDK_EParamValueTypeDiscreteSet } DijSDK_EParamValueType;
+typedef enum { DijSDK_EImageFormatNotSpecified, DijSDK_EImageFormatGrey8, DijSDK_EImageFormatGrey16, DijSDK_EImageFormatGreyRaw16, DijSDK_EImageFormatBayerRaw16, DijSDK_EImageFormatRGB888, DijSDK_EImageFormatRGB161616, DijSDK_EImageFormatBGR888, DijSDK_EImageFormatBGR888A } DijSDK_EImageFormat;
+error_t DijSDK_Init(const DijSDK_CameraKey *key, unsigned count);
+error_t DijSDK_Exit();
+error_t DijSDK_FindCameras(DijSDK_CamGuid *guids, unsigned *count);
+error_t DijSDK_OpenCamera(const DijSDK_CamGuid guid, DijSDK_Handle *h);
+error_t DijSDK_CloseCamera(DijSDK_Handle h);
+error_t DijSDK_GetVersion(char *v, unsigned len);
+error_t DijSDK_StartAcquisition(DijSDK_Handle h);
+error_t DijSDK_AbortAcquisition(DijSDK_Handle h);
+error_t DijSDK_GetImage(DijSDK_Handle h, DijSDK_Handle *img, void **data);
+error_t DijSDK_ReleaseImage(DijSDK_Handle img);
+error_t DijSDK_HasParameter(DijSDK_Handle h, DijSDK_EParamId id);
+error_t DijSDK_GetParameterSpec(DijSDK_Handle h, DijSDK_EParamId id, DijSDK_EParamType *t = nullptr, DijSDK_EParamAccess *a = nullptr, unsigned *dim = nullptr, DijSDK_EParamValueType *vt = nullptr, int *values = nullptr, unsigned *count = nullptr);
+error_t DijSDK_GetIntParameter(DijSDK_Handle h, DijSDK_EParamId id, int *v, unsigned n, DijSDK_EParamQuery q = DijSDK_EParamQueryCurrent);
+error_t DijSDK_GetDoubleParameter(DijSDK_Handle h, DijSDK_EParamId id, double *v, unsigned n, DijSDK_EParamQuery q = DijSDK_EParamQueryCurrent);
+error_t DijSDK_GetStringParameter(DijSDK_Handle h, DijSDK_EParamId id, char *v, unsigned n);
+error_t DijSDK_SetIntParameterArray(DijSDK_Handle h, DijSDK_EParamId id, int *v, unsigned n);
+error_t DijSDK_SetDoubleParameterArray(DijSDK_Handle h, DijSDK_EParamId id, double *v, unsigned n);
+error_t DijSDK_SetStringParameter(DijSDK_Handle h, DijSDK_EParamId id, const char *v);
\ No newline at end of file
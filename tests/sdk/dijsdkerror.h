@@ -0,0 +1,4 @@
+// Stand-in for the DijSDK header, see dijsdk.h.
+#pragma once
+#define E_OK 0
+#define IS_OK(x) ((x) == E_OK)
\ No newline at end of file
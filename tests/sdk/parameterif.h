@@ -0,0 +1,116 @@
+// Stand-in for the DijSDK header, the parameter ids listed in parameterif.csv.
+#pragma once
+typedef enum {
+  ParameterIdImageCaptureExposureTimeUsec = 0x20000000,
+  ParameterIdImageCaptureGain = 0x30000001,
+  ParameterIdImageCaptureRoi = 0x20000002,
+  ParameterIdImageCaptureFrameRate = 0x30000007,
+  ParameterIdSensorNumberOfBits = 0x20000084,
+  ParameterIdImageProcessingXyzWhite = 0x3000020D,
+  ParameterIdImageProcessingRawBlackOffset16 = 0x20000219,
+  ParameterIdImageProcessingHistogramRed = 0x20000223,
+  ParameterIdImageProcessingHistogramGreen = 0x20000224,
+  ParameterIdImageProcessingHistogramGreen2 = 0x20000225,
+  ParameterIdImageProcessingHistogramBlue = 0x20000226,
+  ParameterIdImageProcessingHistogramGrey = 0x20000227,
+  ParameterIdImageCaptureTriggerInputMode = 0x20000003,
+  ParameterIdImageCaptureTriggerOutputModeT1 = 0x20000004,
+  ParameterIdImageCaptureTriggerOutputModeT2 = 0x20000005,
+  ParameterIdImageCaptureTriggerOutputModeT3 = 0x20000006,
+  ParameterIdSensorSize = 0x20000080,
+  ParameterIdSensorColorChannels = 0x20000081,
+  ParameterIdSensorRedOffset = 0x20000082,
+  ParameterIdSensorPixelSizeUm = 0x30000083,
+  ParameterIdSensorFrequenciesMHz = 0x20000085,
+  ParameterIdSensorImageCounter = 0x20000087,
+  ParameterIdImageModeIndex = 0x20000100,
+  ParameterIdImageModeVirtualIndex = 0x20000101,
+  ParameterIdImageModeShadingIndex = 0x20000102,
+  ParameterIdImageModeSize = 0x20000103,
+  ParameterIdImageModeSubsampling = 0x20000104,
+  ParameterIdImageModeAveraging = 0x20000105,
+  ParameterIdImageModeSumming = 0x20000106,
+  ParameterIdImageModeBits = 0x20000107,
+  ParameterIdImageModePreferredAcqMode = 0x20000108,
+  ParameterIdImageModeScan = 0x20000109,
+  ParameterIdImageModeName = 0x4000010A,
+  ParameterIdImageModePixelSizeMicroMeter = 0x3000010B,
+  ParameterIdImageProcessingOutputFormat = 0x20000200,
+  ParameterIdImageProcessingWhiteBalance = 0x30000201,
+  ParameterIdImageProcessingWhiteBalanceMode = 0x20000202,
+  ParameterIdImageProcessingWhiteBalanceUpdateMode = 0x20000203,
+  ParameterIdImageProcessingWhiteBalanceRoi = 0x30000204,
+  ParameterIdImageProcessingGammaCorrection = 0x30000205,
+  ParameterIdImageProcessingContrast = 0x30000206,
+  ParameterIdImageProcessingSharpness = 0x30000207,
+  ParameterIdImageProcessingHighDynamicRange = 0x10000208,
+  ParameterIdImageProcessingHdrWeight = 0x30000209,
+  ParameterIdImageProcessingHdrColorGamma = 0x3000020A,
+  ParameterIdImageProcessingHdrSmoothFieldSize = 0x2000020B,
+  ParameterIdImageProcessingOrientation = 0x2000020C,
+  ParameterIdImageProcessingColorMatrixMode = 0x2000020E,
+  ParameterIdImageProcessingColorMatrix = 0x3000020F,
+  ParameterIdImageProcessingIllumination = 0x20000210,
+  ParameterIdImageProcessingColorBalance = 0x30000211,
+  ParameterIdImageProcessingColorBalKeepBrightness = 0x10000212,
+  ParameterIdImageProcessingSaturation = 0x30000213,
+  ParameterIdImageProcessingBlackBalance = 0x30000214,
+  ParameterIdImageProcessingBlackBalanceRoi = 0x30000215,
+  ParameterIdImageProcessingContNoiseFilterLevel = 0x20000216,
+  ParameterIdImageProcessingContNoiseFilterQuality = 0x20000217,
+  ParameterIdImageProcessingContNoiseFilterCtrlMode = 0x20000218,
+  ParameterIdImageProcessingColorSpace = 0x2000021A,
+  ParameterIdImageProcessingColorSkew = 0x3000021B,
+  ParameterIdImageProcessingWhiteShadingAvailable = 0x2000021E,
+  ParameterIdImageProcessingBlackShadingAvailable = 0x2000021F,
+  ParameterIdImageProcessingWhiteShadingEnable = 0x10000220,
+  ParameterIdImageProcessingBlackShadingEnable = 0x10000221,
+  ParameterIdImageProcessingImageType = 0x20000222,
+  ParameterIdImageProcessingHistogramRoi = 0x30000228,
+  ParameterIdImageProcessingCutHistogramBorder = 0x10000229,
+  ParameterIdImageProcessingSecondaryError = 0x20000237,
+  ParameterIdImageProcessingProcessorCores = 0x20000238,
+  ParameterIdImageProcessingAttachRawImages = 0x10000267,
+  ParameterIdImageProcessingOutputFifoSize = 0x20000268,
+  ParameterIdCameraFeaturesCooling = 0x20000280,
+  ParameterIdCameraFeaturesVentilation = 0x10000281,
+  ParameterIdCameraFeaturesTriggerOutputPin = 0x10000282,
+  ParameterIdCameraFeaturesTriggerInputPin = 0x10000283,
+  ParameterIdCameraFeaturesIlluminationIntensity = 0x20000290,
+  ParameterIdCameraFeaturesZPosition = 0x200002A0,
+  ParameterIdExposureControlMode = 0x20000300,
+  ParameterIdExposureControlAlgorithm = 0x20000302,
+  ParameterIdExposureControlRoi = 0x30000303,
+  ParameterIdExposureControlBrightnessPercentage = 0x20000304,
+  ParameterIdExposureControlExposureLimits = 0x20000305,
+  ParameterIdExposureControlGainLimits = 0x30000306,
+  ParameterIdExposureControlMaxOePercentage = 0x2000030A,
+  ParameterIdExposureControlStatus = 0x2000030F,
+  ParameterIdGlobalSettingsCameraName = 0x40000380,
+  ParameterIdGlobalSettingsCameraSerialNumber = 0x40000381,
+  ParameterIdGlobalSettingsOpenCameraWarning = 0x20000382,
+  ParameterIdGlobalSettingsCameraBoardNumber = 0x40000386,
+  ParameterIdGlobalSettingsApiLoggerFileName = 0x4000038A,
+  ParameterIdGlobalSettingsErrorLoggerFileName = 0x4000038B,
+  ParameterIdFactorySettingsDefaultFirmwareUpdateFile = 0x40000400,
+  ParameterIdCustomerSettingsCustomerName = 0x40000500,
+  ParameterIdCustomerSettingsUserValue1 = 0x40000501,
+  ParameterIdCustomerSettingsUserValue2 = 0x40000502,
+  ParameterIdCustomerSettingsUserValue3 = 0x40000503,
+  ParameterIdCustomerSettingsUserValue4 = 0x40000504,
+  ParameterIdCustomerSettingsUserValue5 = 0x40000505,
+  ParameterIdCustomerSettingsUserValue6 = 0x40000506,
+  ParameterIdCustomerSettingsUserValue7 = 0x40000507,
+  ParameterIdCustomerSettingsUserValue8 = 0x40000508,
+  ParameterIdCustomerSettingsUserValue9 = 0x40000509,
+  ParameterIdCustomerSettingsUserValue10 = 0x4000050A,
+  ParameterIdCustomerSettingsUserValue11 = 0x4000050B,
+  ParameterIdCustomerSettingsUserValue12 = 0x4000050C,
+  ParameterIdCustomerSettingsUserValue13 = 0x4000050D,
+  ParameterIdCustomerSettingsUserValue14 = 0x4000050E,
+  ParameterIdCustomerSettingsUserValue15 = 0x4000050F,
+  ParameterIdCustomerSettingsUserValue16 = 0x40000510,
+  ParameterIdCustomerSettingsSdkEnabledFeatures = 0x40000511,
+  ParameterIdCustomerSettingsAppEnabledFeatures = 0x40000512,
+  ParameterIdEndMarker = 0x7FFFFFFF,
+} DijSDK_EParamId;
\ No newline at end of file
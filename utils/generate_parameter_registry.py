@@ -0,0 +1,87 @@
+"""Writes ParameterRegistry.inc, the table of ParameterRegistry, from parameterif.csv.
+
+Run from the repository root after editing the csv:
+    python utils/generate_parameter_registry.py
+"""
+
+import csv
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "parameterif.csv")
+TARGET = os.path.join(ROOT, "ParameterRegistry.inc")
+
+TYPES = {
+    "bool": "PropertyBase::Type::Bool",
+    "int": "PropertyBase::Type::Int",
+    "double": "PropertyBase::Type::Double",
+    "char": "PropertyBase::Type::String",
+}
+
+
+def split_words(s):
+    return " ".join(re.findall(r"[A-Z][a-z]*|[0-9]+|[a-z]+", s))
+
+
+def display_name(id_name, group):
+    # group, then the rest of the id, e.g. "Image Processing-Gamma Correction"
+    rest = id_name[len("ParameterId"):]
+    if rest.startswith(group):
+        rest = rest[len(group):]
+    return split_words(group) + "-" + split_words(rest)
+
+
+def dimension(s):
+    # blank or 0 in the csv mean a scalar
+    try:
+        return max(int(s), 1)
+    except ValueError:
+        return 1
+
+
+def read_rows(path):
+    rows = []
+    with open(path, newline="") as f:
+        for row in csv.DictReader(f):
+            name = row["name"].strip()
+            # aliases have no value of their own, the end marker no type
+            if not row["val"].strip() or row["type"].strip() not in TYPES:
+                continue
+            rows.append({
+                "name": name,
+                "value": row["val"].strip(),
+                "display_name": display_name(name, row["group"].strip()),
+                "type": TYPES[row["type"].strip()],
+                "dimension": dimension(row["dim"].strip()),
+                "readable": row["cread"].strip() == "x",
+                "writeable": row["cwrite"].strip() == "x",
+            })
+    return rows
+
+
+def write(rows, path):
+    def b(v):
+        return "true" if v else "false"
+
+    lines = [
+        "// generated from parameterif.csv by utils/generate_parameter_registry.py, do not edit",
+        "// {id, id name, display name, type, dimension, readable, writeable}",
+    ]
+    for r in rows:
+        lines.append('{{{}, "{}", "{}", {}, {}u, {}, {}}},'.format(
+            r["name"], r["name"], r["display_name"], r["type"], r["dimension"], b(r["readable"]), b(r["writeable"])))
+    with open(path, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    rows = read_rows(SOURCE)
+    write(rows, TARGET)
+    print("{} parameters written to {}".format(len(rows), TARGET))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
\ No newline at end of file